@@ -0,0 +1,146 @@
+// bench.h - bare-metal micro-benchmark harness on the AArch64 generic timer
+//
+// Header-only, freestanding, usable from C (matrix-mul) and C++ (metal).
+// A case runs `warmup` untimed calls, then `iters` calls each timed with
+// CNTPCT_EL0, and prints one line through the caller's puts():
+//
+//   BENCH name=<id> iters=<n> min_ns=<u64> med_ns=<u64> p99_ns=<u64> rate=<u64> unit=<unit>
+//
+// rate is `work` units per second at the median time (e.g. cells/s, flop/s).
+// All fields are integers so the line can be parsed with a plain split on ' '
+// and '='. Anything else a driver prints about its run (grid size, core count,
+// solver stats) goes on lines starting with "BENCHCFG ", so "BENCH " lines are
+// only ever results.
+//
+// Hosted builds (the core/ Linux driver) time with CLOCK_MONOTONIC instead,
+// since EL0 cannot read CNTPCT_EL0 under Linux; the output is the same.
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+#ifndef BENCH_MAX_ITERS
+#define BENCH_MAX_ITERS 1024
+#endif
+
+typedef void (*bench_fn)(void* ctx);
+typedef void (*bench_puts_fn)(const char* s);
+
+typedef struct {
+    const char* name;
+    bench_fn    fn;
+    void*       ctx;
+    uint32_t    warmup;
+    uint32_t    iters;   // clamped to 1..BENCH_MAX_ITERS
+    uint64_t    work;    // units of work done by one call of fn
+    const char* unit;    // what `work` counts, per second
+} bench_case;
+
+typedef struct {
+    uint64_t min_ns, med_ns, p99_ns;
+    uint64_t rate;
+} bench_result;
+
+#if __STDC_HOSTED__
+#include <time.h>
+
+static inline uint64_t bench_cntfrq(void) {
+    return 1000000000ull;
+}
+
+static inline uint64_t bench_cntpct(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+#else
+static inline uint64_t bench_cntfrq(void) {
+    uint64_t v;
+    __asm__ volatile("mrs %0, cntfrq_el0" : "=r"(v));
+    return v;
+}
+
+// isb keeps the counter read from being hoisted above/below the timed work
+static inline uint64_t bench_cntpct(void) {
+    uint64_t v;
+    __asm__ volatile("isb\n\tmrs %0, cntpct_el0" : "=r"(v) :: "memory");
+    return v;
+}
+#endif
+
+static inline uint64_t bench_ticks_to_ns(uint64_t ticks, uint64_t freq) {
+    return (ticks / freq) * 1000000000ull + ((ticks % freq) * 1000000000ull) / freq;
+}
+
+// work units per second over `ticks`, split the same way: work * freq alone
+// overflows once work passes 1.8e10 with the hosted 1 GHz clock (a dgemm's
+// 2*N^3 flops at N ~ 2100), the remainder term only for medians over 18 s.
+static inline uint64_t bench_rate(uint64_t work, uint64_t ticks, uint64_t freq) {
+    if (!ticks) return 0;
+    return (work / ticks) * freq + ((work % ticks) * freq) / ticks;
+}
+
+static inline void bench_put_u64(bench_puts_fn out, uint64_t v) {
+    char buf[21];
+    int i = 20;
+    buf[i] = '\0';
+    do {
+        buf[--i] = (char)('0' + (v % 10));
+        v /= 10;
+    } while (v);
+    out(&buf[i]);
+}
+
+static inline void bench_report(bench_puts_fn out, const char* name, uint32_t iters,
+                                const bench_result* r, const char* unit) {
+    out("BENCH name=");  out(name);
+    out(" iters=");      bench_put_u64(out, iters);
+    out(" min_ns=");     bench_put_u64(out, r->min_ns);
+    out(" med_ns=");     bench_put_u64(out, r->med_ns);
+    out(" p99_ns=");     bench_put_u64(out, r->p99_ns);
+    out(" rate=");       bench_put_u64(out, r->rate);
+    out(" unit=");       out(unit);
+    out("\n");
+}
+
+static inline bench_result bench_run(const bench_case* c, bench_puts_fn out) {
+    static uint64_t samples[BENCH_MAX_ITERS];
+
+    uint32_t n = c->iters;
+    if (n < 1) n = 1;
+    if (n > BENCH_MAX_ITERS) n = BENCH_MAX_ITERS;
+
+    for (uint32_t i = 0; i < c->warmup; i++) c->fn(c->ctx);
+
+    for (uint32_t i = 0; i < n; i++) {
+        uint64_t t0 = bench_cntpct();
+        c->fn(c->ctx);
+        samples[i] = bench_cntpct() - t0;
+    }
+
+    // insertion sort: n is small and this runs outside the timed region
+    for (uint32_t i = 1; i < n; i++) {
+        uint64_t v = samples[i];
+        uint32_t j = i;
+        while (j > 0 && samples[j - 1] > v) {
+            samples[j] = samples[j - 1];
+            j--;
+        }
+        samples[j] = v;
+    }
+
+    uint64_t freq = bench_cntfrq();
+    uint32_t p99 = (n * 99u + 99u) / 100u - 1u;
+
+    bench_result r;
+    r.min_ns = bench_ticks_to_ns(samples[0], freq);
+    r.med_ns = bench_ticks_to_ns(samples[n / 2], freq);
+    r.p99_ns = bench_ticks_to_ns(samples[p99], freq);
+    r.rate   = bench_rate(c->work, samples[n / 2], freq);
+
+    if (out) bench_report(out, c->name, n, &r, c->unit);
+    return r;
+}
+
+#endif // BENCH_H
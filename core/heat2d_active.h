@@ -0,0 +1,211 @@
+// heat2d_active.h - active-tile tracking (skip regions at thermal equilibrium)
+//
+// The grid is cut into tile x tile blocks (the last block of a row/column absorbs
+// the remainder, so no block is narrower than tile). After each step the solver
+// reports every stepped tile's max |dT|; a tile whose 3x3 neighbourhood stayed
+// below tol for quiet_steps steps goes to sleep and is neither stepped nor
+// rendered until a busy neighbour or a stamp wakes it. Sleeping tiles hold the
+// same values in both halves of the A/B pair, so skipping them is a no-op for
+// the ping-pong. Cost follows the awake area; the price is that a sleeping tile
+// is frozen at the value it had when its neighbourhood went quiet.
+//
+// The solver kernels (h2d_plate_active_rows, h2d_conduct_active_rows) fill
+// delta[] and changed[]; h2d_active_update runs once per step on one core.
+// With temporal blocking (h2d_plate_active_advance_q, h2d_conduct_active_advance_q)
+// a round is k blocked steps over every tile row with an awake tile, the
+// sleeping tiles of those rows included; delta is then the round's max |dT|
+// per step, and quiet_steps counts rounds.
+
+#ifndef HEAT2D_ACTIVE_H
+#define HEAT2D_ACTIVE_H
+
+#include "heat2d_core.h"
+
+#define H2D_ACTIVE_QUIET_MAX 255u
+#define H2D_ACTIVE_SKIPPED   (-__builtin_inff())   // delta of a tile not stepped this round
+
+typedef struct {
+    uint32_t nx, ny;        // grid size in cells
+    uint32_t tile;          // cells per tile side
+    uint32_t tw, th;        // tiles across / down
+    float    tol;           // max |dT| per step that still counts as quiet
+    uint32_t quiet_steps;   // quiet steps before a tile sleeps (1..H2D_ACTIVE_QUIET_MAX)
+    float*   delta;         // [tw*th] max |dT| per step of the last round, H2D_ACTIVE_SKIPPED if not stepped
+    uint8_t* quiet;         // [tw*th] steps the neighbourhood has been quiet, saturating
+    uint8_t* changed;       // [tw*th] cells changed since h2d_active_changed_rows
+} h2d_active;
+
+// Tiles along a side of n cells (storage for delta/quiet/changed is the product).
+static inline uint32_t h2d_active_tiles(uint32_t n, uint32_t tile) {
+    return (n / tile > 0) ? n / tile : 1;
+}
+
+static inline void h2d_active_wake_all(h2d_active* a) {
+    for (uint32_t t = 0; t < a->tw * a->th; t++) {
+        a->delta[t] = H2D_ACTIVE_SKIPPED;
+        a->quiet[t] = 0;
+        a->changed[t] = 1;
+    }
+}
+
+static inline void h2d_active_init(h2d_active* a, uint32_t nx, uint32_t ny, uint32_t tile,
+                                   float tol, uint32_t quiet_steps,
+                                   float* delta, uint8_t* quiet, uint8_t* changed) {
+    a->nx = nx;
+    a->ny = ny;
+    a->tile = tile;
+    a->tw = h2d_active_tiles(nx, tile);
+    a->th = h2d_active_tiles(ny, tile);
+    a->tol = tol;
+    a->quiet_steps = (quiet_steps < 1) ? 1
+                   : (quiet_steps > H2D_ACTIVE_QUIET_MAX) ? H2D_ACTIVE_QUIET_MAX : quiet_steps;
+    a->delta = delta;
+    a->quiet = quiet;
+    a->changed = changed;
+    h2d_active_wake_all(a);
+}
+
+// Cells [*lo, *hi) of tile t along a side of n cells split into count tiles.
+static inline void h2d_active_span(const h2d_active* a, uint32_t t, uint32_t n, uint32_t count,
+                                   uint32_t* lo, uint32_t* hi) {
+    *lo = t * a->tile;
+    *hi = (t + 1 == count) ? n : *lo + a->tile;
+}
+
+static inline int h2d_active_awake(const h2d_active* a, uint32_t tx, uint32_t ty) {
+    return a->quiet[ty * a->tw + tx] < a->quiet_steps;
+}
+
+// Any tile of tile row ty awake.
+static inline int h2d_active_row_awake(const h2d_active* a, uint32_t ty) {
+    for (uint32_t tx = 0; tx < a->tw; tx++) {
+        if (h2d_active_awake(a, tx, ty)) return 1;
+    }
+    return 0;
+}
+
+// Every tile of tile rows [ty0, ty1) was advanced k steps from src into dst:
+// record its max |dT| per step and flag it changed.
+static inline void h2d_active_measure_rows(h2d_active* a, const float* src, const float* dst,
+                                           uint32_t ty0, uint32_t ty1, uint32_t k) {
+    const float inv_k = 1.0f / (float)(k ? k : 1);
+    for (uint32_t ty = ty0; ty < ty1; ty++) {
+        uint32_t y0, y1;
+        h2d_active_span(a, ty, a->ny, a->th, &y0, &y1);
+        for (uint32_t tx = 0; tx < a->tw; tx++) {
+            uint32_t x0, x1;
+            h2d_active_span(a, tx, a->nx, a->tw, &x0, &x1);
+            float dmax = 0.f;
+            for (uint32_t y = y0; y < y1; y++) {
+                for (uint32_t x = x0; x < x1; x++) {
+                    dmax = __builtin_fmaxf(dmax, __builtin_fabsf(dst[y * a->nx + x] - src[y * a->nx + x]));
+                }
+            }
+            a->delta[ty * a->tw + tx] = dmax * inv_k;
+            a->changed[ty * a->tw + tx] = 1;
+        }
+    }
+}
+
+static inline uint32_t h2d_active_tile_of(const h2d_active* a, uint32_t c, uint32_t count) {
+    uint32_t t = c / a->tile;
+    return (t < count) ? t : count - 1;
+}
+
+// Something outside the solver wrote cells [x0, x1) x [y0, y1) (a brush, a
+// reset): wake the tiles they fall in plus one ring, since the next step
+// spreads the change across tile borders.
+static inline void h2d_active_wake_cells(h2d_active* a, int32_t x0, int32_t y0,
+                                         int32_t x1, int32_t y1) {
+    x0 = h2d_clampi(x0 - 1, 0, (int32_t)a->nx - 1);
+    y0 = h2d_clampi(y0 - 1, 0, (int32_t)a->ny - 1);
+    x1 = h2d_clampi(x1, 0, (int32_t)a->nx - 1);
+    y1 = h2d_clampi(y1, 0, (int32_t)a->ny - 1);
+    if (x1 < x0 || y1 < y0) return;
+
+    uint32_t tx0 = h2d_active_tile_of(a, (uint32_t)x0, a->tw);
+    uint32_t tx1 = h2d_active_tile_of(a, (uint32_t)x1, a->tw);
+    uint32_t ty0 = h2d_active_tile_of(a, (uint32_t)y0, a->th);
+    uint32_t ty1 = h2d_active_tile_of(a, (uint32_t)y1, a->th);
+    for (uint32_t ty = ty0; ty <= ty1; ty++) {
+        for (uint32_t tx = tx0; tx <= tx1; tx++) {
+            a->quiet[ty * a->tw + tx] = 0;
+            a->changed[ty * a->tw + tx] = 1;
+        }
+    }
+}
+
+// After a step from src into dst: age or reset each tile's quiet count from its
+// neighbourhood's delta, and copy the tiles that are asleep but were stepped
+// (they just fell asleep, or slept in a row a blocked round stepped) from dst
+// back into src so both buffers agree from then on. Returns the tiles awake for
+// the next step.
+static inline uint32_t h2d_active_update(h2d_active* a, const float* dst, float* src) {
+    const uint32_t tw = a->tw, th = a->th;
+    uint32_t awake = 0;
+
+    for (uint32_t ty = 0; ty < th; ty++) {
+        uint32_t ny0 = (ty > 0) ? ty - 1 : 0;
+        uint32_t ny1 = (ty + 1 < th) ? ty + 1 : th - 1;
+        for (uint32_t tx = 0; tx < tw; tx++) {
+            uint32_t nx0 = (tx > 0) ? tx - 1 : 0;
+            uint32_t nx1 = (tx + 1 < tw) ? tx + 1 : tw - 1;
+
+            int busy = 0;
+            for (uint32_t y = ny0; y <= ny1 && !busy; y++) {
+                for (uint32_t x = nx0; x <= nx1; x++) {
+                    if (a->delta[y * tw + x] > a->tol) { busy = 1; break; }
+                }
+            }
+
+            uint8_t* q = &a->quiet[ty * tw + tx];
+            uint32_t was = *q;
+            if (busy) {
+                *q = 0;
+            } else if (was < H2D_ACTIVE_QUIET_MAX) {
+                *q = (uint8_t)(was + 1);
+            }
+
+            int stepped = (a->delta[ty * tw + tx] >= 0.f);
+            if (*q >= a->quiet_steps && (was < a->quiet_steps || stepped)) {
+                uint32_t x0, x1, y0, y1;
+                h2d_active_span(a, tx, a->nx, tw, &x0, &x1);
+                h2d_active_span(a, ty, a->ny, th, &y0, &y1);
+                for (uint32_t y = y0; y < y1; y++) {
+                    for (uint32_t x = x0; x < x1; x++) {
+                        src[y * a->nx + x] = dst[y * a->nx + x];
+                    }
+                }
+            }
+            if (*q < a->quiet_steps) awake++;
+        }
+    }
+
+    // clear for the next round; tiles it skips keep H2D_ACTIVE_SKIPPED
+    for (uint32_t t = 0; t < tw * th; t++) a->delta[t] = H2D_ACTIVE_SKIPPED;
+    return awake;
+}
+
+// Cell rows [*y0, *y1) covering every tile changed since the last call (empty
+// when y0 == y1), and clear the changed flags. Front ends redraw just these rows.
+static inline void h2d_active_changed_rows(h2d_active* a, uint32_t* y0, uint32_t* y1) {
+    uint32_t lo = a->ny, hi = 0;
+    for (uint32_t ty = 0; ty < a->th; ty++) {
+        int any = 0;
+        for (uint32_t tx = 0; tx < a->tw; tx++) {
+            if (a->changed[ty * a->tw + tx]) {
+                a->changed[ty * a->tw + tx] = 0;
+                any = 1;
+            }
+        }
+        if (!any) continue;
+        uint32_t r0, r1;
+        h2d_active_span(a, ty, a->ny, a->th, &r0, &r1);
+        if (r0 < lo) lo = r0;
+        if (r1 > hi) hi = r1;
+    }
+    *y0 = (lo < hi) ? lo : 0;
+    *y1 = (lo < hi) ? hi : 0;
+}
+
+#endif // HEAT2D_ACTIVE_H
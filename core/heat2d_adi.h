@@ -0,0 +1,202 @@
+// heat2d_adi.h - implicit time stepping by alternating directions (Peaceman-Rachford)
+//
+// The explicit stencils are stable only for base_r * k <= 0.25, so long
+// transients cost thousands of small steps. An ADI step of m explicit steps'
+// worth of time splits the operator into its x and y parts (A, B) and solves
+//
+//     (I - m/2 A) T*      = (I + m/2 B) T        implicit along rows
+//     (I - m/2 B) T^(n+1) = (I + m/2 A) T*       implicit along columns
+//
+// Each half is a set of independent tridiagonal systems (Thomas algorithm).
+// Rows are solved one at a time. Columns are solved in batches: the forward
+// sweep walks down the rows across a chunk of columns, so both halves stream
+// memory in order. The step is stable for any m; large m damps the sharpest
+// features less than it should (the scheme is not L-stable), which reads as
+// faint ringing around a freshly stamped brush, not as growth.
+//
+// Faces come from the h2d_conduct setup (mat may be NULL for one uniform
+// material, kface[0]); edges follow its boundary mode. Cold edges hold 0 and
+// insulated ones carry no flux, so edge cells are never read; the column half
+// writes them at the end of each chunk, while the chunk is still in cache.
+// Cells flagged in fixed (the stamped sources) keep their value through the step.
+
+#ifndef HEAT2D_ADI_H
+#define HEAT2D_ADI_H
+
+#include "heat2d_conduct.h"
+
+typedef struct {
+    const h2d_conduct* c;   // faces, boundary mode, base_r per explicit step; c->src is not used
+    float          steps;   // explicit steps of simulated time per ADI step
+    float          sink;    // linear loss per explicit step (the plate's cooling), 0 for none
+    const uint8_t* fixed;   // nx*ny, nonzero: held at its value (stamped sources); may be NULL
+    int            clamp01; // clamp the result to [0, 1], as the plate does every step
+} h2d_adi;
+
+// Sources as fixed cells, for h2d_adi::fixed (cleared elsewhere).
+static inline void h2d_adi_mark_sources(const h2d_rect_sources* s, int32_t nx, int32_t ny,
+                                        uint8_t* fixed) {
+    for (int32_t i = 0; i < nx * ny; i++) fixed[i] = 0;
+    for (uint32_t n = 0; n < sizeof(s->x0)/sizeof(s->x0[0]); n++) {
+        int32_t x0 = h2d_clampi(s->x0[n], 0, nx-1);
+        int32_t x1 = h2d_clampi(s->x0[n] + s->w - 1, 0, nx-1);
+        int32_t y0 = h2d_clampi(s->y0, 0, ny-1);
+        int32_t y1 = h2d_clampi(s->y0 + s->h - 1, 0, ny-1);
+        for (int32_t j = y0; j <= y1; j++) {
+            for (int32_t i = x0; i <= x1; i++) fixed[j*nx + i] = 1;
+        }
+    }
+}
+
+// Conductivity of the face between cells a and b.
+static inline float h2d_adi_face(const h2d_conduct* c, int32_t a, int32_t b) {
+    if (!c->mat) return c->kface[0];
+    return c->kface[c->mat[a] * c->nmat + c->mat[b]];
+}
+
+// Face from interior cell idx to its neighbour nb; 0 when nb is an insulated
+// edge cell. A cold edge keeps its face, against a temperature of 0.
+static inline float h2d_adi_edge_face(const h2d_conduct* c, int32_t idx, int32_t nb,
+                                      int nb_is_edge, int edge_cold) {
+    return (nb_is_edge && !edge_cold) ? 0.0f : h2d_adi_face(c, idx, nb);
+}
+
+// Rows [y0, y1) of the first half: T* = (I - m/2 A)^-1 (I + m/2 B) src along
+// each interior row, then dst = (I + m/2 A) T*, the right-hand side of the
+// second half (row-local, so computing it here keeps the column half in place).
+// line holds 2*nx floats.
+static inline void h2d_adi_rows(const h2d_adi* d, const float* src, float* dst,
+                                int32_t y0, int32_t y1, float* line) {
+    const h2d_conduct* c = d->c;
+    const int32_t nx = c->nx, ny = c->ny;
+    const float R = 0.5f * d->steps * c->base_r;
+    const float S = 0.25f * d->steps * d->sink;   // half the sink per direction
+    const int side_cold = (c->bc != H2D_BC_NEUMANN_INSULATED);
+    const int edge_cold = (c->bc == H2D_BC_DIRICHLET_COLD);
+    float* cp = line;
+    float* ts = line + nx;
+    int32_t j0 = (y0 < 1) ? 1 : y0;
+    int32_t j1 = (y1 > ny-1) ? ny-1 : y1;
+
+    for (int32_t j = j0; j < j1; j++) {
+        const float* T = src + j*nx;
+        float* out = dst + j*nx;
+        const uint8_t* F = d->fixed ? d->fixed + j*nx : 0;
+
+        // forward sweep: explicit y part on the right, implicit x part on the left
+        float cprev = 0.0f, dprev = 0.0f;
+        for (int32_t i = 1; i < nx-1; i++) {
+            int32_t idx = j*nx + i;
+            float t = T[i];
+            if (F && F[i]) {
+                cp[i] = 0.0f;
+                ts[i] = t;
+                cprev = 0.0f;
+                dprev = t;
+                continue;
+            }
+            float ku = h2d_adi_edge_face(c, idx, idx - nx, j == 1, edge_cold);
+            float kd = h2d_adi_edge_face(c, idx, idx + nx, j == ny-2, edge_cold);
+            float tu = (j == 1)    ? 0.0f : T[i - nx];
+            float td = (j == ny-2) ? 0.0f : T[i + nx];
+            float rhs = t + R * (ku * (tu - t) + kd * (td - t)) - S * t;
+
+            float kl = h2d_adi_edge_face(c, idx, idx - 1, i == 1, side_cold);
+            float kr = h2d_adi_edge_face(c, idx, idx + 1, i == nx-2, side_cold);
+            float a  = (i == 1)    ? 0.0f : -R * kl;
+            float cc = (i == nx-2) ? 0.0f : -R * kr;
+            float b  = 1.0f + R * (kl + kr) + S;
+            float den = b - a * cprev;
+            cprev = cc / den;
+            dprev = (rhs - a * dprev) / den;
+            cp[i] = cprev;
+            ts[i] = dprev;
+        }
+        for (int32_t i = nx-3; i >= 1; i--) ts[i] -= cp[i] * ts[i + 1];
+
+        // right-hand side of the column half: explicit x part of T*
+        for (int32_t i = 1; i < nx-1; i++) {
+            int32_t idx = j*nx + i;
+            float t = ts[i];
+            if (F && F[i]) { out[i] = t; continue; }
+            float kl = h2d_adi_edge_face(c, idx, idx - 1, i == 1, side_cold);
+            float kr = h2d_adi_edge_face(c, idx, idx + 1, i == nx-2, side_cold);
+            float tl = (i == 1)    ? 0.0f : ts[i - 1];
+            float tr = (i == nx-2) ? 0.0f : ts[i + 1];
+            out[i] = t + R * (kl * (tl - t) + kr * (tr - t)) - S * t;
+        }
+    }
+}
+
+// Columns [x0, x1) of the second half, in place on the dst of h2d_adi_rows:
+// T^(n+1) = (I - m/2 B)^-1 dst, boundary included. Columns go chunk columns at
+// a time; scratch holds ny*chunk floats. Each chunk finishes with its cells of
+// the edge rows, and the chunk holding column 1 (nx-2) with edge column 0 (nx-1).
+static inline void h2d_adi_cols(const h2d_adi* d, float* t, int32_t x0, int32_t x1,
+                                float* scratch, int32_t chunk) {
+    const h2d_conduct* c = d->c;
+    const int32_t nx = c->nx, ny = c->ny;
+    const float R = 0.5f * d->steps * c->base_r;
+    const float S = 0.25f * d->steps * d->sink;
+    const int edge_cold = (c->bc == H2D_BC_DIRICHLET_COLD);
+    int32_t i0 = (x0 < 1) ? 1 : x0;
+    int32_t i1 = (x1 > nx-1) ? nx-1 : x1;
+    if (chunk < 1) chunk = 1;
+
+    for (int32_t c0 = i0; c0 < i1; c0 += chunk) {
+        int32_t c1 = (c0 + chunk < i1) ? c0 + chunk : i1;
+        int32_t w = c1 - c0;
+
+        for (int32_t j = 1; j < ny-1; j++) {
+            float* row = t + j*nx;
+            const float* prev = row - nx;
+            float* cp = scratch + j*w;                 // cp[i - c0] for i in [c0, c1)
+            const float* cpp = cp - w;
+            const uint8_t* F = d->fixed ? d->fixed + j*nx : 0;
+            for (int32_t i = c0; i < c1; i++) {
+                if (F && F[i]) { cp[i - c0] = 0.0f; continue; }   // row stays its value
+                int32_t idx = j*nx + i;
+                float ku = h2d_adi_edge_face(c, idx, idx - nx, j == 1, edge_cold);
+                float kd = h2d_adi_edge_face(c, idx, idx + nx, j == ny-2, edge_cold);
+                float a  = (j == 1)    ? 0.0f : -R * ku;
+                float cc = (j == ny-2) ? 0.0f : -R * kd;
+                float b  = 1.0f + R * (ku + kd) + S;
+                if (j == 1) {
+                    cp[i - c0] = cc / b;
+                    row[i] = row[i] / b;
+                } else {
+                    float den = b - a * cpp[i - c0];
+                    cp[i - c0] = cc / den;
+                    row[i] = (row[i] - a * prev[i]) / den;
+                }
+            }
+        }
+        for (int32_t j = ny-3; j >= 1; j--) {
+            float* row = t + j*nx;
+            const float* next = row + nx;
+            const float* cp = scratch + j*w;
+            for (int32_t i = c0; i < c1; i++) row[i] -= cp[i - c0] * next[i];
+        }
+        if (d->clamp01) {
+            for (int32_t j = 1; j < ny-1; j++) {
+                for (int32_t i = c0; i < c1; i++) t[j*nx + i] = h2d_clamp01(t[j*nx + i]);
+            }
+        }
+        h2d_apply_boundary_block(t, nx, ny, (c0 == 1) ? 0 : c0, (c1 == nx-1) ? nx : c1, 0, ny, c->bc);
+    }
+}
+
+// Scratch h2d_adi_step needs: the row line and one column chunk the width of the grid.
+static inline uint32_t h2d_adi_scratch_floats(int32_t nx, int32_t ny) {
+    return (uint32_t)(2 * nx + nx * ny);
+}
+
+// One ADI step of d->steps explicit steps' time from src (sources already
+// stamped) into dst, edges included.
+static inline void h2d_adi_step(const h2d_adi* d, const float* src, float* dst, float* scratch) {
+    const h2d_conduct* c = d->c;
+    h2d_adi_rows(d, src, dst, 0, c->ny, scratch);
+    h2d_adi_cols(d, dst, 0, c->nx, scratch + 2 * c->nx, c->nx);
+}
+
+#endif // HEAT2D_ADI_H
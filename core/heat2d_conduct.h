@@ -0,0 +1,612 @@
+// heat2d_conduct.h - variable-conductivity solver (the uefi heatsink demo)
+//
+// dT/dt = div(k grad T) with harmonic face conductivities looked up by material
+// id, three boundary modes and rectangular heat sources re-stamped before every
+// step.
+// Grids are nx*ny floats, row-major; helpers that take (Rows, Row0) work on a
+// window whose first row is grid row Row0, so they serve the full field and the
+// temporal-blocking scratch alike.
+
+#ifndef HEAT2D_CONDUCT_H
+#define HEAT2D_CONDUCT_H
+
+#include "heat2d_core.h"
+#include "heat2d_active.h"
+#include "heat2d_display.h"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+enum {
+    H2D_BC_DIRICHLET_COLD = 0,   // fixed cold edges (0)
+    H2D_BC_NEUMANN_INSULATED,    // zero-flux edges
+    H2D_BC_MIXED,                // left/right cold, top/bottom insulated
+    H2D_BC_COUNT
+};
+
+// Fixed heat sources: equal-size rectangles re-stamped before every step.
+typedef struct {
+    int32_t x0[3];
+    int32_t y0, w, h;
+    float   temp;
+} h2d_rect_sources;
+
+// Up to H2D_MAT_MAX materials; cells carry a uint8_t material id and faces
+// look up the harmonic mean of their two sides in an nmat x nmat table, so the
+// stencil streams 9 bytes per cell (A, B, mat) instead of 16 (A, B, kx, ky).
+#define H2D_MAT_MAX 16
+
+typedef struct {
+    int32_t        nx, ny;
+    const uint8_t* mat;       // nx*ny material ids, < nmat
+    const float*   kface;     // nmat*nmat: kface[a*nmat + b] = harmonic(k[a], k[b]), symmetric
+    uint32_t       nmat;
+    float          base_r;    // stable for base_r * max k <= 0.25
+    int            bc;        // H2D_BC_*
+    const h2d_rect_sources* src;  // re-stamped between blocked steps; may be NULL
+} h2d_conduct;
+
+// -------------------- Face conductivity --------------------
+static inline float h2d_kface_harmonic(float k0, float k1) {
+    const float eps = 1e-12f;
+    float denom = k0 + k1;
+    if (denom < eps) return 0.0f;
+    return (2.0f * k0 * k1) / denom;
+}
+
+// Face table from per-material conductivities (nmat <= H2D_MAT_MAX). The
+// harmonic mean is symmetric bit-for-bit (2*k0 is exact), so one row per
+// centre material serves all four faces.
+static inline void h2d_face_table(const float* kmat, uint32_t nmat, float* kface) {
+    for (uint32_t a = 0; a < nmat; a++) {
+        for (uint32_t b = 0; b < nmat; b++) {
+            kface[a*nmat + b] = h2d_kface_harmonic(kmat[a], kmat[b]);
+        }
+    }
+}
+
+// -------------------- Boundary --------------------
+// Columns [x0, x1) of edge row t (row 0 or ny-1) from its inner neighbour in
+// (row 1 or ny-2). A corner is written when the window also holds the column
+// next to it.
+static inline void h2d_boundary_edge_span(float* t, const float* in, int32_t nx,
+                                          int32_t x0, int32_t x1, int mode) {
+    int32_t i0 = (x0 < 1) ? 1 : x0;
+    int32_t i1 = (x1 > nx-1) ? nx-1 : x1;
+    for (int32_t i = i0; i < i1; i++) t[i] = (mode == H2D_BC_DIRICHLET_COLD) ? 0.0f : in[i];
+
+    // mixed: cold left/right wins at the corners
+    if (x0 <= 0 && x1 > 1)     t[0]    = (mode == H2D_BC_NEUMANN_INSULATED) ? in[1]    : 0.0f;
+    if (x1 >= nx && x0 < nx-1) t[nx-1] = (mode == H2D_BC_NEUMANN_INSULATED) ? in[nx-2] : 0.0f;
+}
+
+static inline void h2d_boundary_edge_row(float* t, const float* in, int32_t nx, int mode) {
+    h2d_boundary_edge_span(t, in, nx, 0, nx, mode);
+}
+
+// Boundary for grid rows [y0, y1). An edge row is only written when its inner
+// neighbour is inside the window.
+static inline void h2d_apply_boundary_rows(float* rows, int32_t row0, int32_t nx, int32_t ny,
+                                           int32_t y0, int32_t y1, int mode) {
+    int32_t j0 = (y0 < 1) ? 1 : y0;
+    int32_t j1 = (y1 > ny-1) ? ny-1 : y1;
+    for (int32_t j = j0; j < j1; j++) {
+        float* t = rows + (j - row0)*nx;
+        if (mode == H2D_BC_NEUMANN_INSULATED) {
+            t[0]    = t[1];
+            t[nx-1] = t[nx-2];
+        } else {
+            t[0]    = 0.0f;
+            t[nx-1] = 0.0f;
+        }
+    }
+
+    if (y0 <= 0 && y1 > 1) {
+        h2d_boundary_edge_row(rows + (0 - row0)*nx, rows + (1 - row0)*nx, nx, mode);
+    }
+    if (y0 <= ny-2 && y1 >= ny) {
+        h2d_boundary_edge_row(rows + (ny-1 - row0)*nx, rows + (ny-2 - row0)*nx, nx, mode);
+    }
+}
+
+static inline void h2d_apply_boundary(float* t, int32_t nx, int32_t ny, int mode) {
+    h2d_apply_boundary_rows(t, 0, nx, ny, 0, ny, mode);
+}
+
+// Boundary for the cells of the block [x0, x1) x [y0, y1) that lie on the grid
+// edge, matching h2d_apply_boundary_rows. Inner neighbours must be in the block.
+static inline void h2d_apply_boundary_block(float* t, int32_t nx, int32_t ny,
+                                            int32_t x0, int32_t x1, int32_t y0, int32_t y1,
+                                            int mode) {
+    int32_t j0 = (y0 < 1) ? 1 : y0;
+    int32_t j1 = (y1 > ny-1) ? ny-1 : y1;
+    for (int32_t j = j0; j < j1; j++) {
+        float* r = t + j*nx;
+        if (x0 <= 0 && x1 > 1)     r[0]    = (mode == H2D_BC_NEUMANN_INSULATED) ? r[1]    : 0.0f;
+        if (x1 >= nx && x0 < nx-1) r[nx-1] = (mode == H2D_BC_NEUMANN_INSULATED) ? r[nx-2] : 0.0f;
+    }
+
+    if (y0 <= 0 && y1 > 1) h2d_boundary_edge_span(t, t + nx, nx, x0, x1, mode);
+    if (y0 <= ny-2 && y1 >= ny) h2d_boundary_edge_span(t + (ny-1)*nx, t + (ny-2)*nx, nx, x0, x1, mode);
+}
+
+// -------------------- Stamps --------------------
+static inline void h2d_stamp_disk_max(float* t, int32_t nx, int32_t ny,
+                                      int32_t cx, int32_t cy, int32_t rad, float val) {
+    int32_t r2 = rad * rad;
+    int32_t y0 = h2d_clampi(cy - rad, 0, ny-1);
+    int32_t y1 = h2d_clampi(cy + rad, 0, ny-1);
+    int32_t x0 = h2d_clampi(cx - rad, 0, nx-1);
+    int32_t x1 = h2d_clampi(cx + rad, 0, nx-1);
+
+    for (int32_t j = y0; j <= y1; j++) {
+        int32_t dy = j - cy;
+        for (int32_t i = x0; i <= x1; i++) {
+            int32_t dx = i - cx;
+            if (dx*dx + dy*dy <= r2) {
+                float* p = &t[j*nx + i];
+                if (val > *p) *p = val;
+            }
+        }
+    }
+}
+
+// Max-stamp a rectangle, restricted to grid rows [row_lo, row_hi).
+static inline void h2d_stamp_rect_max_rows(float* rows, int32_t row0, int32_t nx, int32_t ny,
+                                           int32_t row_lo, int32_t row_hi,
+                                           int32_t x0, int32_t y0, int32_t w, int32_t h, float val) {
+    int32_t x1 = x0 + w - 1;
+    int32_t y1 = y0 + h - 1;
+
+    x0 = h2d_clampi(x0, 0, nx-1);
+    y0 = h2d_clampi(y0, 0, ny-1);
+    x1 = h2d_clampi(x1, 0, nx-1);
+    y1 = h2d_clampi(y1, 0, ny-1);
+    if (y0 < row_lo) y0 = row_lo;
+    if (y1 > row_hi - 1) y1 = row_hi - 1;
+
+    for (int32_t y = y0; y <= y1; y++) {
+        float* row = &rows[(y - row0)*nx];
+        for (int32_t x = x0; x <= x1; x++) {
+            if (val > row[x]) row[x] = val;
+        }
+    }
+}
+
+static inline void h2d_stamp_sources_rows(const h2d_rect_sources* s, float* rows, int32_t row0,
+                                          int32_t nx, int32_t ny, int32_t row_lo, int32_t row_hi) {
+    for (uint32_t n = 0; n < sizeof(s->x0)/sizeof(s->x0[0]); n++) {
+        h2d_stamp_rect_max_rows(rows, row0, nx, ny, row_lo, row_hi,
+                                s->x0[n], s->y0, s->w, s->h, s->temp);
+    }
+}
+
+// -------------------- Conduction step --------------------
+// Cell i of material row M from its centre and neighbour temperatures.
+static inline float h2d_conduct_cell_v(const h2d_conduct* c, const uint8_t* M, int32_t i, int32_t nx,
+                                       float tC, float tR, float tL, float tD, float tU) {
+    // Faces: the centre material's table row, indexed by each neighbour
+    const float* KC = c->kface + M[i] * c->nmat;
+    float flux_r = KC[M[i + 1]]  * (tR - tC);
+    float flux_l = KC[M[i - 1]]  * (tL - tC);
+    float flux_d = KC[M[i + nx]] * (tD - tC);
+    float flux_u = KC[M[i - nx]] * (tU - tC);
+
+    return tC + c->base_r * (flux_r + flux_l + flux_d + flux_u);
+}
+
+// One cell from the field row A and its material row M.
+static inline float h2d_conduct_cell(const h2d_conduct* c, const float* A, const uint8_t* M,
+                                     int32_t i, int32_t nx) {
+    return h2d_conduct_cell_v(c, M, i, nx, A[i], A[i + 1], A[i - 1], A[i + nx], A[i - nx]);
+}
+
+#if defined(__ARM_NEON)
+// Four material ids widened to u32 lanes (a 4-byte load; rows need no padding).
+static inline uint32x4_t h2d_mat4(const uint8_t* m) {
+    uint32_t w = (uint32_t)m[0] | ((uint32_t)m[1] << 8) | ((uint32_t)m[2] << 16) | ((uint32_t)m[3] << 24);
+    return vmovl_u16(vget_low_u16(vmovl_u8(vcreate_u8(w))));
+}
+
+// Face conductivities of four cells towards the neighbours at M + i + off.
+// Up to 4 materials the whole table (16 floats) sits in four registers and
+// one TBL per face looks up all four lanes: byte index 4*(a*nmat + b) + 0..3
+// per lane. Larger tables gather lane by lane.
+static inline float32x4_t h2d_conduct_face4(const h2d_conduct* c, const uint8x16x4_t* tbl,
+                                            uint32x4_t row, const uint8_t* M, int32_t i,
+                                            int32_t off) {
+    if (tbl) {
+        uint32x4_t idx = vaddq_u32(row, h2d_mat4(M + i + off));
+        uint32x4_t bytes = vmlaq_n_u32(vdupq_n_u32(0x03020100u), idx, 0x04040404u);
+        return vreinterpretq_f32_u8(vqtbl4q_u8(*tbl, vreinterpretq_u8_u32(bytes)));
+    }
+    float k[4];
+    for (int32_t l = 0; l < 4; l++) k[l] = c->kface[M[i + l] * c->nmat + M[i + l + off]];
+    return vld1q_f32(k);
+}
+
+// Cells [i, i+4) of material row M from their centre and neighbour
+// temperatures; same operations in the same order as h2d_conduct_cell_v, so
+// the scalar head and tail match the vector body.
+static inline float32x4_t h2d_conduct_vec4_v(const h2d_conduct* c, const uint8x16x4_t* tbl,
+                                             const uint8_t* M, int32_t i, int32_t nx,
+                                             float32x4_t tC, float32x4_t tR, float32x4_t tL,
+                                             float32x4_t tD, float32x4_t tU) {
+    uint32x4_t row = vmulq_n_u32(h2d_mat4(M + i), c->nmat);
+    float32x4_t flux_r = vmulq_f32(h2d_conduct_face4(c, tbl, row, M, i, 1),   vsubq_f32(tR, tC));
+    float32x4_t flux_l = vmulq_f32(h2d_conduct_face4(c, tbl, row, M, i, -1),  vsubq_f32(tL, tC));
+    float32x4_t flux_d = vmulq_f32(h2d_conduct_face4(c, tbl, row, M, i, nx),  vsubq_f32(tD, tC));
+    float32x4_t flux_u = vmulq_f32(h2d_conduct_face4(c, tbl, row, M, i, -nx), vsubq_f32(tU, tC));
+    float32x4_t sum = vaddq_f32(vaddq_f32(vaddq_f32(flux_r, flux_l), flux_d), flux_u);
+    return vaddq_f32(tC, vmulq_n_f32(sum, c->base_r));
+}
+
+static inline float32x4_t h2d_conduct_vec4(const h2d_conduct* c, const uint8x16x4_t* tbl,
+                                           const float* A, const uint8_t* M, int32_t i, int32_t nx) {
+    return h2d_conduct_vec4_v(c, tbl, M, i, nx, vld1q_f32(A + i), vld1q_f32(A + i + 1),
+                              vld1q_f32(A + i - 1), vld1q_f32(A + i + nx), vld1q_f32(A + i - nx));
+}
+
+// Face table in registers for h2d_conduct_face4; NULL when nmat > 4.
+static inline const uint8x16x4_t* h2d_conduct_tbl(const h2d_conduct* c, uint8x16x4_t* regs) {
+    if (c->nmat > 4) return 0;
+    float t[16] = { 0 };
+    for (uint32_t k = 0; k < c->nmat * c->nmat; k++) t[k] = c->kface[k];
+    regs->val[0] = vreinterpretq_u8_f32(vld1q_f32(t));
+    regs->val[1] = vreinterpretq_u8_f32(vld1q_f32(t + 4));
+    regs->val[2] = vreinterpretq_u8_f32(vld1q_f32(t + 8));
+    regs->val[3] = vreinterpretq_u8_f32(vld1q_f32(t + 12));
+    return regs;
+}
+#endif
+
+// Grid rows [y0, y1), columns [x0, x1) of dst from src (each pointing at grid
+// rows src_row0/dst_row0), boundary included. The boundary is folded into the
+// sweep: a row's edge cells are set right after its interior, and edge row 0
+// (ny-1) right after row 1 (ny-2), so a step is one unit-stride pass instead
+// of a stencil pass plus a column-striding h2d_apply_boundary pass. Edge cells
+// are only written when their inner neighbour is in the window, as in
+// h2d_apply_boundary_rows, whose values they match. With NEON each row is
+// scalar up to a 16-byte aligned dst cell, then 8 and 4 cells per iteration,
+// then a scalar tail; bit-identical to the scalar path. With a display plane
+// (dst then being the full field) each finished row, edge rows included, is
+// quantized into it right after it is stored.
+static inline void h2d_conduct_span_q(const h2d_conduct* c, const float* src, int32_t src_row0,
+                                      float* dst, int32_t dst_row0, int32_t y0, int32_t y1,
+                                      int32_t x0, int32_t x1, h2d_display* disp) {
+    const int32_t nx = c->nx;
+    int32_t j0 = (y0 < 1) ? 1 : y0;
+    int32_t j1 = (y1 > c->ny-1) ? c->ny-1 : y1;
+    int32_t i0 = (x0 < 1) ? 1 : x0;
+    int32_t i1 = (x1 > nx-1) ? nx-1 : x1;
+    const int insulated = (c->bc == H2D_BC_NEUMANN_INSULATED);
+    const int left  = (x0 <= 0 && x1 > 1);
+    const int right = (x1 >= nx && x0 < nx-1);
+
+#if defined(__ARM_NEON)
+    uint8x16x4_t tbl_regs;
+    const uint8x16x4_t* tbl = h2d_conduct_tbl(c, &tbl_regs);
+#endif
+
+    // dT/dt = div(k grad T) using precomputed face conductivities
+    for (int32_t j = j0; j < j1; j++) {
+        const float* A   = src + (j - src_row0)*nx;
+        float*       B   = dst + (j - dst_row0)*nx;
+        const uint8_t* M = c->mat + j*nx;
+        int32_t i = i0;
+#if defined(__ARM_NEON)
+        for (; i < i1 && ((uintptr_t)(B + i) & 15); i++) B[i] = h2d_conduct_cell(c, A, M, i, nx);
+        for (; i + 8 <= i1; i += 8) {
+            vst1q_f32(B + i,     h2d_conduct_vec4(c, tbl, A, M, i, nx));
+            vst1q_f32(B + i + 4, h2d_conduct_vec4(c, tbl, A, M, i + 4, nx));
+        }
+        for (; i + 4 <= i1; i += 4) vst1q_f32(B + i, h2d_conduct_vec4(c, tbl, A, M, i, nx));
+#endif
+        for (; i < i1; i++) B[i] = h2d_conduct_cell(c, A, M, i, nx);
+
+        if (left)  B[0]    = insulated ? B[1]    : 0.0f;
+        if (right) B[nx-1] = insulated ? B[nx-2] : 0.0f;
+        const int top    = (j == 1 && y0 <= 0);
+        const int bottom = (j == c->ny-2 && y1 >= c->ny);
+        if (top)    h2d_boundary_edge_span(B - nx, B, nx, x0, x1, c->bc);
+        if (bottom) h2d_boundary_edge_span(B + nx, B, nx, x0, x1, c->bc);
+        if (disp) {
+            if (top)    h2d_display_span(disp, B - nx, 0, (uint32_t)x0, (uint32_t)x1);
+            h2d_display_span(disp, B, (uint32_t)j, (uint32_t)x0, (uint32_t)x1);
+            if (bottom) h2d_display_span(disp, B + nx, (uint32_t)(c->ny-1), (uint32_t)x0, (uint32_t)x1);
+        }
+    }
+}
+
+static inline void h2d_conduct_span(const h2d_conduct* c, const float* src, int32_t src_row0,
+                                    float* dst, int32_t dst_row0, int32_t y0, int32_t y1,
+                                    int32_t x0, int32_t x1) {
+    h2d_conduct_span_q(c, src, src_row0, dst, dst_row0, y0, y1, x0, x1, 0);
+}
+
+static inline void h2d_conduct_rows(const h2d_conduct* c, const float* src, int32_t src_row0,
+                                    float* dst, int32_t dst_row0, int32_t y0, int32_t y1) {
+    h2d_conduct_span(c, src, src_row0, dst, dst_row0, y0, y1, 0, c->nx);
+}
+
+// Advance grid rows [b0, b1) of a (already stamped with the sources) by k steps
+// into b, boundary included. With k > 1 the band is walked in tiles of tile_rows
+// rows; a tile plus a (k-1)-row halo on either side is stepped in the scratch
+// pair, the valid rows shrinking by one per step, and only step k is written to
+// b. Every cell sees the same arithmetic, stamps and boundary as k single steps
+// (bit-identical), but a/b/mat stream through the cache once. Each scratch
+// buffer holds tile_rows + 2*(k-1) rows; without scratch this runs one step.
+// Bands only read a and only write their own rows of b, so they can run on
+// different cores; split with h2d_conduct_band so no edge row is cut off from
+// its inner neighbour. disp, if set, gets the LUT indices of b as the last
+// step stores them.
+static inline void h2d_conduct_advance_q(const h2d_conduct* c, const float* a, float* b,
+                                         float* scratch0, float* scratch1, int32_t tile_rows,
+                                         int32_t b0, int32_t b1, uint32_t k, h2d_display* disp) {
+    const int32_t nx = c->nx, ny = c->ny;
+    if (k <= 1 || scratch0 == 0 || scratch1 == 0) {
+        h2d_conduct_span_q(c, a, 0, b, 0, b0, b1, 0, nx, disp);
+        return;
+    }
+
+    float* scratch[2] = { scratch0, scratch1 };
+    int32_t halo = (int32_t)k - 1;
+
+    for (int32_t t0 = b0; t0 < b1; ) {
+        int32_t t1 = (t0 + tile_rows < b1) ? (t0 + tile_rows) : b1;
+        if (t1 > ny - 2) t1 = b1;            // edge row and its neighbour share a tile
+        int32_t lo = (t0 > halo) ? (t0 - halo) : 0;
+
+        const float* s_src = a;
+        int32_t src_row0 = 0;
+        for (uint32_t s = 1; s <= k; s++) {
+            int32_t h  = (int32_t)(k - s);
+            int32_t r0 = (t0 > h) ? (t0 - h) : 0;
+            int32_t r1 = (t1 + h < ny) ? (t1 + h) : ny;
+
+            float*  s_dst    = (s == k) ? b : scratch[s & 1];
+            int32_t dst_row0 = (s == k) ? 0 : lo;
+
+            h2d_conduct_span_q(c, s_src, src_row0, s_dst, dst_row0, r0, r1, 0, nx, (s == k) ? disp : 0);
+            if (s < k && c->src) h2d_stamp_sources_rows(c->src, s_dst, dst_row0, nx, ny, r0, r1);
+
+            s_src = s_dst;
+            src_row0 = dst_row0;
+        }
+        t0 = t1;
+    }
+}
+
+static inline void h2d_conduct_advance(const h2d_conduct* c, const float* a, float* b,
+                                       float* scratch0, float* scratch1, int32_t tile_rows,
+                                       int32_t b0, int32_t b1, uint32_t k) {
+    h2d_conduct_advance_q(c, a, b, scratch0, scratch1, tile_rows, b0, b1, k, 0);
+}
+
+static inline void h2d_step_conduction(const h2d_conduct* c, const float* a, float* b,
+                                       float* scratch0, float* scratch1,
+                                       int32_t tile_rows, uint32_t k) {
+    h2d_conduct_advance(c, a, b, scratch0, scratch1, tile_rows, 0, c->ny, k);
+}
+
+// Rows [*y0, *y1) of band i out of n (ny >= 4). Inner splits stay within
+// [2, ny-2] so rows 0/1 and ny-2/ny-1 always land in the same band.
+static inline void h2d_conduct_band(int32_t ny, uint32_t n, uint32_t i,
+                                    int32_t* y0, int32_t* y1) {
+    int32_t lo = (int32_t)(((int64_t)ny * i) / n);
+    int32_t hi = (int32_t)(((int64_t)ny * (i + 1)) / n);
+    *y0 = (i == 0)     ? 0  : h2d_clampi(lo, 2, ny - 2);
+    *y1 = (i + 1 >= n) ? ny : h2d_clampi(hi, 2, ny - 2);
+}
+
+// -------------------- Active tiles --------------------
+// One step of the block [x0, x1) x [y0, y1) of the full field, boundary included;
+// same arithmetic as h2d_step_conduction with k = 1. Returns the block's max |dT|.
+static inline float h2d_conduct_block(const h2d_conduct* c, const float* src, float* dst,
+                                      int32_t x0, int32_t x1, int32_t y0, int32_t y1) {
+    const int32_t nx = c->nx;
+    h2d_conduct_span(c, src, 0, dst, 0, y0, y1, x0, x1);
+
+    float dmax = 0.0f;
+    for (int32_t j = y0; j < y1; j++) {
+        for (int32_t i = x0; i < x1; i++) {
+            dmax = __builtin_fmaxf(dmax, __builtin_fabsf(dst[j*nx + i] - src[j*nx + i]));
+        }
+    }
+    return dmax;
+}
+
+// One step of the awake tiles in tile rows [ty0, ty1) of src (already stamped);
+// sleeping tiles are left alone. Tile rows are independent, so cores can split
+// them; h2d_active_update follows once all rows are done.
+static inline void h2d_conduct_active_rows(const h2d_conduct* c, h2d_active* a,
+                                           const float* src, float* dst,
+                                           uint32_t ty0, uint32_t ty1) {
+    for (uint32_t ty = ty0; ty < ty1; ty++) {
+        uint32_t y0, y1;
+        h2d_active_span(a, ty, (uint32_t)c->ny, a->th, &y0, &y1);
+        for (uint32_t tx = 0; tx < a->tw; tx++) {
+            if (!h2d_active_awake(a, tx, ty)) continue;
+            uint32_t x0, x1;
+            h2d_active_span(a, tx, (uint32_t)c->nx, a->tw, &x0, &x1);
+            a->delta[ty * a->tw + tx] = h2d_conduct_block(c, src, dst, (int32_t)x0, (int32_t)x1,
+                                                          (int32_t)y0, (int32_t)y1);
+            a->changed[ty * a->tw + tx] = 1;
+        }
+    }
+}
+
+// A round of k steps over the awake tiles of tile rows [ty0, ty1) of src
+// (already stamped), as h2d_plate_active_advance_q: k <= 1 (or no scratch) is
+// h2d_conduct_active_rows, otherwise each run of tile rows holding an awake
+// tile goes through h2d_conduct_advance_q, full width, and is then measured.
+// Tile runs keep each edge row with its inner neighbour, as bands must. disp,
+// if set, gets the LUT indices of the cells stored.
+static inline void h2d_conduct_active_advance_q(const h2d_conduct* c, h2d_active* a,
+                                                const float* src, float* dst,
+                                                float* scratch0, float* scratch1, int32_t tile_rows,
+                                                uint32_t ty0, uint32_t ty1, uint32_t k,
+                                                h2d_display* disp) {
+    const uint32_t nx = (uint32_t)c->nx, ny = (uint32_t)c->ny;
+    if (k <= 1 || scratch0 == 0 || scratch1 == 0) {
+        h2d_conduct_active_rows(c, a, src, dst, ty0, ty1);
+        if (!disp) return;
+        for (uint32_t ty = ty0; ty < ty1; ty++) {
+            uint32_t y0, y1;
+            h2d_active_span(a, ty, ny, a->th, &y0, &y1);
+            for (uint32_t tx = 0; tx < a->tw; tx++) {
+                if (!h2d_active_awake(a, tx, ty)) continue;
+                uint32_t x0, x1;
+                h2d_active_span(a, tx, nx, a->tw, &x0, &x1);
+                for (uint32_t y = y0; y < y1; y++) h2d_display_span(disp, dst + y * nx, y, x0, x1);
+            }
+        }
+        return;
+    }
+
+    for (uint32_t ty = ty0; ty < ty1; ) {
+        if (!h2d_active_row_awake(a, ty)) { ty++; continue; }
+        uint32_t te = ty + 1;
+        while (te < ty1 && h2d_active_row_awake(a, te)) te++;
+
+        uint32_t y0, y1, mid;
+        h2d_active_span(a, ty, ny, a->th, &y0, &mid);
+        h2d_active_span(a, te - 1, ny, a->th, &mid, &y1);
+        h2d_conduct_advance_q(c, src, dst, scratch0, scratch1, tile_rows, (int32_t)y0, (int32_t)y1,
+                              k, disp);
+        h2d_active_measure_rows(a, src, dst, ty, te, k);
+        ty = te;
+    }
+}
+
+// -------------------- Heatsink geometry (comb) --------------------
+typedef struct {
+    int32_t baseX0, baseX1;
+    int32_t baseY0, baseY1;
+} h2d_heatsink_geom;
+
+enum {
+    H2D_HEATSINK_AIR = 0,
+    H2D_HEATSINK_COPPER,
+    H2D_HEATSINK_MAT_COUNT
+};
+
+// Conductivity per heatsink material, for h2d_face_table.
+// V3: stronger contrast (1:100) feels more heatsink-like
+static const float h2d_heatsink_k[H2D_HEATSINK_MAT_COUNT] = {
+    0.01f,  // solid air, low conduction
+    1.00f,  // copper reference
+};
+
+// Air everywhere, then a copper base plate, a comb of fins above it and a die
+// block below it. mat gets H2D_HEATSINK_AIR / H2D_HEATSINK_COPPER.
+static inline void h2d_build_heatsink(uint8_t* mat, int32_t nx, int32_t ny,
+                                      h2d_heatsink_geom* g) {
+    const uint8_t cu = H2D_HEATSINK_COPPER;
+
+    // Fill air
+    for (int32_t j = 0; j < ny; j++) {
+        for (int32_t i = 0; i < nx; i++) {
+            mat[j*nx + i] = H2D_HEATSINK_AIR;
+        }
+    }
+
+    // Copper base plate near bottom
+    int32_t marginX = nx / 8;
+    int32_t baseW = nx - 2*marginX;
+    int32_t baseH = ny / 10;
+    int32_t baseX0 = marginX;
+    int32_t baseX1 = baseX0 + baseW - 1;
+
+    int32_t baseY1 = ny - 10;
+    int32_t baseY0 = baseY1 - baseH + 1;
+    if (baseY0 < 0) baseY0 = 0;
+
+    if (g) {
+        g->baseX0 = baseX0; g->baseX1 = baseX1;
+        g->baseY0 = baseY0; g->baseY1 = baseY1;
+    }
+
+    // Copper base
+    for (int32_t j = baseY0; j <= baseY1; j++) {
+        for (int32_t i = baseX0; i <= baseX1; i++) {
+            mat[j*nx + i] = cu;
+        }
+    }
+
+    // Copper fins (comb) above base
+    int32_t finH  = ny / 3;
+    int32_t finY0 = baseY0 - finH;
+    int32_t finY1 = baseY0;
+    if (finY0 < 2) finY0 = 2;
+
+    int32_t finCount = 14;
+    int32_t gap = baseW / finCount;
+    if (gap < 6) gap = 6;
+
+    int32_t finW = gap / 2;
+    if (finW < 3) finW = 3;
+
+    for (int32_t f = 0; f < finCount; f++) {
+        int32_t cx = baseX0 + f * gap + gap/2;
+        int32_t x0 = cx - finW/2;
+        int32_t x1 = x0 + finW - 1;
+
+        x0 = h2d_clampi(x0, baseX0, baseX1);
+        x1 = h2d_clampi(x1, baseX0, baseX1);
+
+        for (int32_t j = finY0; j <= finY1; j++) {
+            for (int32_t i = x0; i <= x1; i++) {
+                mat[j*nx + i] = cu;
+            }
+        }
+    }
+
+    // Copper "die block" under base (still copper)
+    int32_t dieW = baseW / 6;
+    int32_t dieH = baseH / 2;
+    int32_t dieX0 = (nx/2) - dieW/2;
+    int32_t dieX1 = dieX0 + dieW - 1;
+    int32_t dieY0 = baseY1 + 1;
+    int32_t dieY1 = dieY0 + dieH - 1;
+    if (dieY1 >= ny) dieY1 = ny - 1;
+
+    for (int32_t j = dieY0; j <= dieY1; j++) {
+        for (int32_t i = dieX0; i <= dieX1; i++) {
+            mat[j*nx + i] = cu;
+        }
+    }
+}
+
+// Three equal rectangular sources at the bottom of the base plate.
+static inline void h2d_heatsink_sources(const h2d_heatsink_geom* g, float temp,
+                                        h2d_rect_sources* s) {
+    int32_t baseW = g->baseX1 - g->baseX0 + 1;
+    int32_t baseH = g->baseY1 - g->baseY0 + 1;
+
+    int32_t srcH = h2d_clampi(baseH / 2, 2, baseH);
+    int32_t srcY0 = g->baseY1 - srcH + 1;
+
+    int32_t srcW = h2d_clampi(baseW / 8, 6, baseW / 3);
+    int32_t gap  = h2d_clampi(baseW / 12, 4, baseW / 4);
+
+    int32_t mid = (g->baseX0 + g->baseX1) / 2;
+
+    int32_t s0x0 = mid - (srcW/2) - (srcW + gap);
+    int32_t s1x0 = mid - (srcW/2);
+    int32_t s2x0 = mid - (srcW/2) + (srcW + gap);
+
+    if (s0x0 < g->baseX0) s0x0 = g->baseX0;
+    if (s2x0 + srcW - 1 > g->baseX1) s2x0 = g->baseX1 - srcW + 1;
+
+    s->x0[0] = s0x0;
+    s->x0[1] = s1x0;
+    s->x0[2] = s2x0;
+    s->y0    = srcY0;
+    s->w     = srcW;
+    s->h     = srcH;
+    s->temp  = temp;
+}
+
+#endif // HEAT2D_CONDUCT_H
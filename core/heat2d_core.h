@@ -0,0 +1,43 @@
+// heat2d_core.h - platform-neutral Heat2D solver and render core
+//
+// Header-only and freestanding: no libc, no MMIO, no firmware calls. It builds
+// as C (uefi/, the host driver) and as C++ (metal/). Everything that touches a
+// device (UART, fw_cfg, GOP, PSCI) stays in the front ends; they hand the core
+// plain float grids and uint32_t pixel surfaces.
+//
+//   heat2d_plate.h    uniform-alpha explicit solver (metal demo)
+//   heat2d_conduct.h  variable-conductivity solver, boundary modes, heatsink scene (uefi demo)
+//   heat2d_render.h   palette LUTs and cell-to-pixel rendering
+//   heat2d_active.h   active-tile tracking: skip tiles at thermal equilibrium
+//   heat2d_multigrid.h  steady state of the conduction solver in one solve
+//   heat2d_adi.h      implicit ADI steps, many explicit steps of time each
+//   heat2d_spectral.h exact plate integration in a sine basis, any time interval per jump
+//   heat2d_half.h     fp16 field storage, fp32 compute, stochastic rounding on the store
+//   heat2d_display.h  LUT-index plane and changed rows, written by the stencils as they store
+//
+// core/Makefile builds a hosted driver around these headers for native tests
+// and benchmarks (make -C core test / bench).
+
+#ifndef HEAT2D_CORE_H
+#define HEAT2D_CORE_H
+
+#include <stdint.h>
+
+static inline float h2d_clamp01(float x) {
+    // fmaxnm/fminnm on AArch64, no compare-and-branch in the stencil
+    return __builtin_fminf(__builtin_fmaxf(x, 0.f), 1.f);
+}
+
+static inline float h2d_clampf(float v, float lo, float hi) {
+    if (v < lo) return lo;
+    if (v > hi) return hi;
+    return v;
+}
+
+static inline int32_t h2d_clampi(int32_t v, int32_t lo, int32_t hi) {
+    if (v < lo) return lo;
+    if (v > hi) return hi;
+    return v;
+}
+
+#endif // HEAT2D_CORE_H
@@ -0,0 +1,93 @@
+// heat2d_display.h - LUT-index plane written by the stepping kernels
+//
+// A frame used to re-read the whole float field (scale by 255, clamp, LUT
+// index) right after the solver had written it: a second full pass over the
+// grid. A h2d_display holds the LUT index of every cell instead, one byte
+// each, and a flag per row that is set when one of the row's indices changes.
+// The blocked stencils fill it as they store their last step, while the row is
+// still in L1 (h2d_plate_advance_q, h2d_conduct_advance_q). Anything else that
+// writes the field (brush stamps, steady-state solves, the other solvers)
+// quantizes the rows it touched with h2d_display_rows. The renderer
+// (h2d_render_display_rows) reads one byte per cell and skips clean rows.
+//
+// Rows are independent, so cores stepping different bands can share a plane.
+
+#ifndef HEAT2D_DISPLAY_H
+#define HEAT2D_DISPLAY_H
+
+#include "heat2d_core.h"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+typedef struct {
+    uint32_t w, h;      // grid size in cells
+    float    bias;      // added to t*255 before truncating: 0 as h2d_lut_index, 0.5 to round
+    uint8_t* idx;       // [w*h] LUT index of every cell
+    uint8_t* rows;      // [h] nonzero: an index in the row changed since the renderer took it
+} h2d_display;
+
+// Every index 0 and every row flagged, so the first frame draws everything.
+static inline void h2d_display_init(h2d_display* d, uint32_t w, uint32_t h, float bias,
+                                    uint8_t* idx, uint8_t* rows) {
+    d->w = w;
+    d->h = h;
+    d->bias = bias;
+    d->idx = idx;
+    d->rows = rows;
+    for (uint32_t i = 0; i < w * h; i++) idx[i] = 0;
+    for (uint32_t y = 0; y < h; y++) rows[y] = 1;
+}
+
+// LUT index of a temperature; anything outside [0, 1] (NaN included) clamps.
+static inline uint8_t h2d_display_index(const h2d_display* d, float t) {
+    float x = t * 255.0f + d->bias;
+    if (!(x > 0.0f)) return 0;
+    if (x > 255.0f) return 255;
+    return (uint8_t)x;
+}
+
+// Cells [x0, x1) of grid row y from row, the field row they were stored to.
+static inline void h2d_display_span(h2d_display* d, const float* row, uint32_t y,
+                                    uint32_t x0, uint32_t x1) {
+    uint8_t* q = d->idx + y * d->w;
+    uint32_t x = x0;
+    uint32_t diff = 0;
+#if defined(__ARM_NEON)
+    // same clamps as h2d_display_index: FCVTZU sends negatives and NaN to 0
+    const float32x4_t bias = vdupq_n_f32(d->bias);
+    const float32x4_t top  = vdupq_n_f32(255.0f);
+    uint8x8_t acc = vdup_n_u8(0);
+    for (; x + 8 <= x1; x += 8) {
+        float32x4_t lo = vminq_f32(vaddq_f32(vmulq_n_f32(vld1q_f32(row + x), 255.0f), bias), top);
+        float32x4_t hi = vminq_f32(vaddq_f32(vmulq_n_f32(vld1q_f32(row + x + 4), 255.0f), bias), top);
+        uint16x8_t w16 = vcombine_u16(vmovn_u32(vcvtq_u32_f32(lo)), vmovn_u32(vcvtq_u32_f32(hi)));
+        uint8x8_t v = vmovn_u16(w16);
+        acc = vorr_u8(acc, veor_u8(v, vld1_u8(q + x)));
+        vst1_u8(q + x, v);
+    }
+    diff = (vget_lane_u64(vreinterpret_u64_u8(acc), 0) != 0);
+#endif
+    for (; x < x1; x++) {
+        uint8_t v = h2d_display_index(d, row[x]);
+        diff |= (uint32_t)(v ^ q[x]);
+        q[x] = v;
+    }
+    if (diff) d->rows[y] = 1;
+}
+
+// Grid rows [y0, y1) of the full field.
+static inline void h2d_display_rows(h2d_display* d, const float* field, uint32_t y0, uint32_t y1) {
+    if (y1 > d->h) y1 = d->h;
+    for (uint32_t y = y0; y < y1; y++) h2d_display_span(d, field + y * d->w, y, 0, d->w);
+}
+
+// Flag rows [y0, y1) for the renderer without touching their indices (e.g.
+// under a cursor drawn over the field).
+static inline void h2d_display_mark_rows(h2d_display* d, uint32_t y0, uint32_t y1) {
+    if (y1 > d->h) y1 = d->h;
+    for (uint32_t y = y0; y < y1; y++) d->rows[y] = 1;
+}
+
+#endif // HEAT2D_DISPLAY_H
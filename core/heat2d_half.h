@@ -0,0 +1,453 @@
+// heat2d_half.h - half-precision (IEEE binary16) field storage, fp32 compute
+//
+// The fields live in [0, 1] and reach the screen through a 256-entry LUT, so
+// the 24-bit float mantissa is mostly carried around for nothing. These are
+// the plate and conduction steps over fields of 16-bit halves: cells are
+// widened to fp32 in registers (FCVTL with NEON), stepped with exactly the
+// arithmetic of the fp32 kernels, and narrowed back on the store. The stencil
+// streams half the bytes.
+//
+// A step moves a cell by base_r times its neighbours' differences, often less
+// than half an fp16 ulp (2^-12 at 0.5). Rounded to nearest, such an update is
+// lost every step: the heatsink's air stops diffusing altogether (from a cold
+// start it sits 0.5 below fp32 after 20000 steps). So the steps store with
+// stochastic rounding, up with probability equal to the dropped fraction,
+// which keeps every update on average. The dither is a hash of the cell index
+// and a step number the caller counts, so bands, tiles and temporal blocking
+// stay bit-identical to single full steps and runs are repeatable. The
+// heatsink then stays within a couple of display levels of fp32 (the
+// rounding noise random-walks, it does not pile up); heat2d_bench reports the
+// drift (BENCH fp16_drift).
+//
+// The arithmetic stays fp32: FP16 arithmetic would round those same small
+// updates inside the stencil, where no dither can reach them.
+//
+// The _hq steps fill a display plane from the halves their last step stores,
+// and h2d_display_rows_h quantizes half rows written any other way, so a front
+// end draws straight from the half field; widening it to fp32 is only needed
+// for the code that works on floats (brush, steady-state solve).
+//
+// h2d_half is the bit pattern (uint16_t), so the header builds on any host;
+// the conversions are exact software RNE where the target has no FP16 format.
+
+#ifndef HEAT2D_HALF_H
+#define HEAT2D_HALF_H
+
+#include "heat2d_plate.h"
+#include "heat2d_conduct.h"
+#include "heat2d_display.h"
+
+typedef uint16_t h2d_half;
+
+// -------------------- Conversions --------------------
+static inline float h2d_half_to_float(h2d_half h) {
+#if defined(__ARM_FP16_FORMAT_IEEE)
+    union { h2d_half u; __fp16 f; } v = { h };
+    return (float)v.f;
+#else
+    uint32_t sign = (uint32_t)(h & 0x8000u) << 16;
+    uint32_t e = (h >> 10) & 0x1fu;
+    uint32_t m = h & 0x3ffu;
+    uint32_t bits;
+    if (e == 0x1fu) {
+        bits = sign | 0x7f800000u | (m << 13);          // inf, nan
+    } else if (e) {
+        bits = sign | ((e + 112u) << 23) | (m << 13);   // rebias 15 -> 127
+    } else if (!m) {
+        bits = sign;
+    } else {                                            // subnormal: normalise
+        e = 113u;
+        while (!(m & 0x400u)) { m <<= 1; e--; }
+        bits = sign | (e << 23) | ((m & 0x3ffu) << 13);
+    }
+    union { uint32_t u; float f; } v = { bits };
+    return v.f;
+#endif
+}
+
+// Round to nearest, ties to even, as FCVT/FCVTN do with the default FPCR.
+static inline h2d_half h2d_half_from_float(float f) {
+#if defined(__ARM_FP16_FORMAT_IEEE)
+    union { __fp16 f; h2d_half u; } v = { (__fp16)f };
+    return v.u;
+#else
+    union { float f; uint32_t u; } v = { f };
+    uint32_t sign = (v.u >> 16) & 0x8000u;
+    uint32_t a = v.u & 0x7fffffffu;
+    if (a > 0x7f800000u) return (h2d_half)(sign | 0x7e00u | ((a >> 13) & 0x1ffu));   // quiet nan
+    if (a >= 0x477ff000u) return (h2d_half)(sign | 0x7c00u);   // 65520 and up round to inf
+    if (a >= 0x38800000u) {                                    // normal half
+        uint32_t r = a - 0x38000000u;                          // rebias 127 -> 15
+        r += 0xfffu + ((r >> 13) & 1u);
+        return (h2d_half)(sign | (r >> 13));
+    }
+    if (a < 0x33000000u) return (h2d_half)sign;                // at most 2^-25: 0
+    // subnormal half: the significand in units of 2^-24
+    uint32_t shift = 126u - (a >> 23);
+    uint32_t m = (a & 0x7fffffu) | 0x800000u;
+    uint32_t q = m >> shift;
+    uint32_t rem = m & ((1u << shift) - 1u);
+    uint32_t halfway = 1u << (shift - 1);
+    if (rem > halfway || (rem == halfway && (q & 1u))) q++;
+    return (h2d_half)(sign | q);
+#endif
+}
+
+static inline void h2d_half_from_floats(const float* src, h2d_half* dst, uint32_t n) {
+    uint32_t i = 0;
+#if defined(__ARM_NEON)
+    for (; i + 4 <= n; i += 4) vst1_u16(dst + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src + i))));
+#endif
+    for (; i < n; i++) dst[i] = h2d_half_from_float(src[i]);
+}
+
+static inline void h2d_half_to_floats(const h2d_half* src, float* dst, uint32_t n) {
+    uint32_t i = 0;
+#if defined(__ARM_NEON)
+    for (; i + 4 <= n; i += 4) vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + i))));
+#endif
+    for (; i < n; i++) dst[i] = h2d_half_to_float(src[i]);
+}
+
+// -------------------- Stochastic rounding --------------------
+// 32 well-mixed bits per (cell, step).
+static inline uint32_t h2d_half_dither(uint32_t cell, uint32_t step) {
+    uint32_t x = (cell * 0x9e3779b1u) ^ (step * 0x85ebca77u);
+    x ^= x >> 15;
+    x *= 0x2c1b3c6du;
+    x ^= x >> 12;
+    return x;
+}
+
+// f to half, rounded up with probability equal to the dropped fraction.
+// Normal halves only; subnormals (below 2^-14, far under one display level)
+// and the top of the range round to nearest.
+static inline h2d_half h2d_half_round(float f, uint32_t cell, uint32_t step) {
+    union { float f; uint32_t u; } v = { f };
+    uint32_t a = v.u & 0x7fffffffu;
+    if (a < 0x38800000u || a >= 0x477fe000u) return h2d_half_from_float(f);
+    uint32_t r = a - 0x38000000u + (h2d_half_dither(cell, step) & 0x1fffu);
+    return (h2d_half)(((v.u >> 16) & 0x8000u) | (r >> 13));
+}
+
+#if defined(__ARM_NEON)
+static inline float32x4_t h2d_half_load4(const h2d_half* p) {
+    return vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(p)));
+}
+
+// h2d_half_round of four cells cell, cell+1, ... (same bits as the scalar).
+static inline void h2d_half_round4(h2d_half* p, float32x4_t f, uint32_t cell, uint32_t step) {
+    static const uint32_t lane[4] = { 0, 1, 2, 3 };
+    uint32x4_t x = vmulq_n_u32(vaddq_u32(vdupq_n_u32(cell), vld1q_u32(lane)), 0x9e3779b1u);
+    x = veorq_u32(x, vdupq_n_u32(step * 0x85ebca77u));
+    x = veorq_u32(x, vshrq_n_u32(x, 15));
+    x = vmulq_n_u32(x, 0x2c1b3c6du);
+    x = veorq_u32(x, vshrq_n_u32(x, 12));
+
+    uint32x4_t u = vreinterpretq_u32_f32(f);
+    uint32x4_t a = vandq_u32(u, vdupq_n_u32(0x7fffffffu));
+    uint32x4_t r = vaddq_u32(vsubq_u32(a, vdupq_n_u32(0x38000000u)), vandq_u32(x, vdupq_n_u32(0x1fffu)));
+    uint16x4_t sr = vorr_u16(vmovn_u32(vshrq_n_u32(r, 13)),
+                             vmovn_u32(vandq_u32(vshrq_n_u32(u, 16), vdupq_n_u32(0x8000u))));
+    uint32x4_t normal = vandq_u32(vcgeq_u32(a, vdupq_n_u32(0x38800000u)),
+                                  vcltq_u32(a, vdupq_n_u32(0x477fe000u)));
+    uint16x4_t rne = vreinterpret_u16_f16(vcvt_f16_f32(f));
+    vst1_u16(p, vbsl_u16(vmovn_u32(normal), sr, rne));
+}
+#endif
+
+// -------------------- Display --------------------
+// h2d_display_span over a half row: the indices of the widened row.
+static inline void h2d_display_span_h(h2d_display* d, const h2d_half* row, uint32_t y,
+                                      uint32_t x0, uint32_t x1) {
+    uint8_t* q = d->idx + y * d->w;
+    uint32_t x = x0;
+    uint32_t diff = 0;
+#if defined(__ARM_NEON)
+    const float32x4_t bias = vdupq_n_f32(d->bias);
+    const float32x4_t top  = vdupq_n_f32(255.0f);
+    uint8x8_t acc = vdup_n_u8(0);
+    for (; x + 8 <= x1; x += 8) {
+        float32x4_t lo = vminq_f32(vaddq_f32(vmulq_n_f32(h2d_half_load4(row + x), 255.0f), bias), top);
+        float32x4_t hi = vminq_f32(vaddq_f32(vmulq_n_f32(h2d_half_load4(row + x + 4), 255.0f), bias), top);
+        uint16x8_t w16 = vcombine_u16(vmovn_u32(vcvtq_u32_f32(lo)), vmovn_u32(vcvtq_u32_f32(hi)));
+        uint8x8_t v = vmovn_u16(w16);
+        acc = vorr_u8(acc, veor_u8(v, vld1_u8(q + x)));
+        vst1_u8(q + x, v);
+    }
+    diff = (vget_lane_u64(vreinterpret_u64_u8(acc), 0) != 0);
+#endif
+    for (; x < x1; x++) {
+        uint8_t v = h2d_display_index(d, h2d_half_to_float(row[x]));
+        diff |= (uint32_t)(v ^ q[x]);
+        q[x] = v;
+    }
+    if (diff) d->rows[y] = 1;
+}
+
+// h2d_display_rows over a half field.
+static inline void h2d_display_rows_h(h2d_display* d, const h2d_half* field, uint32_t y0, uint32_t y1) {
+    if (y1 > d->h) y1 = d->h;
+    for (uint32_t y = y0; y < y1; y++) h2d_display_span_h(d, field + y * d->w, y, 0, d->w);
+}
+
+// -------------------- Plate --------------------
+// h2d_plate_row_span over half rows; cell0 is the grid index of the row's
+// first cell and step the dither's step number.
+static inline void h2d_plate_row_span_h(const h2d_plate* p, const h2d_half* up, const h2d_half* c,
+                                        const h2d_half* dn, h2d_half* out, uint32_t x0, uint32_t x1,
+                                        uint32_t cell0, uint32_t step) {
+    uint32_t x = x0;
+#if defined(__ARM_NEON)
+    for (; x + STENCIL_VEC_CELLS <= x1; x += STENCIL_VEC_CELLS) {
+#pragma GCC unroll 4
+        for (uint32_t v = 0; v < STENCIL_VEC_CELLS; v += 4) {
+            const uint32_t i = x + v;
+            h2d_half_round4(out + i, h2d_plate_vec4_v(p, h2d_half_load4(c + i), h2d_half_load4(c + i - 1),
+                                                      h2d_half_load4(c + i + 1), h2d_half_load4(up + i),
+                                                      h2d_half_load4(dn + i)), cell0 + i, step);
+        }
+    }
+#endif
+    for (; x < x1; x++) {
+        out[x] = h2d_half_round(h2d_plate_cell(p, h2d_half_to_float(c[x]), h2d_half_to_float(c[x - 1]),
+                                               h2d_half_to_float(c[x + 1]), h2d_half_to_float(up[x]),
+                                               h2d_half_to_float(dn[x])), cell0 + x, step);
+    }
+}
+
+// h2d_plate_stamp_disk over half rows.
+static inline void h2d_plate_stamp_disk_h(const h2d_plate* p, h2d_half* rows, uint32_t row0,
+                                          uint32_t y0, uint32_t y1, int cx, int cy, int r, float v) {
+    const h2d_half hv = h2d_half_from_float(v);
+    int r2 = r * r;
+    for (int dy = -r; dy <= r; dy++) {
+        int y = cy + dy;
+        if (y <= 0 || y >= (int)p->h - 1 || y < (int)y0 || y >= (int)y1) continue;
+        h2d_half* row = rows + ((uint32_t)y - row0) * p->w;
+        for (int dx = -r; dx <= r; dx++) {
+            int x = cx + dx;
+            if (x <= 0 || x >= (int)p->w - 1) continue;
+            if (dx*dx + dy*dy <= r2) row[x] = hv;
+        }
+    }
+}
+
+// h2d_plate_step_rows_q over half fields, as step number step.
+static inline void h2d_plate_step_rows_hq(const h2d_plate* p, const h2d_half* src, uint32_t src_row0,
+                                          h2d_half* dst, uint32_t dst_row0, uint32_t y0, uint32_t y1,
+                                          uint32_t step, h2d_display* disp) {
+    const uint32_t w = p->w;
+    for (uint32_t y = y0; y < y1; y++) {
+        h2d_half* out = dst + (y - dst_row0) * w;
+        if (y == 0 || y == p->h - 1) {
+            for (uint32_t x = 0; x < w; x++) out[x] = 0;
+        } else {
+            const h2d_half* c = src + (y - src_row0) * w;
+            h2d_plate_row_span_h(p, c - w, c, c + w, out, 1, w - 1, y * w, step);
+            out[0] = 0;
+            out[w - 1] = 0;
+        }
+        if (disp) {
+            h2d_plate_stamp_disk_h(p, dst, dst_row0, y, y + 1, p->src_x, p->src_y, p->src_r, p->src_temp);
+            h2d_display_span_h(disp, out, y, 0, w);
+        }
+    }
+    if (!disp) h2d_plate_stamp_disk_h(p, dst, dst_row0, y0, y1, p->src_x, p->src_y, p->src_r, p->src_temp);
+}
+
+static inline void h2d_plate_step_rows_h(const h2d_plate* p, const h2d_half* src, uint32_t src_row0,
+                                         h2d_half* dst, uint32_t dst_row0, uint32_t y0, uint32_t y1,
+                                         uint32_t step) {
+    h2d_plate_step_rows_hq(p, src, src_row0, dst, dst_row0, y0, y1, step, 0);
+}
+
+// h2d_plate_advance_q over half fields, as steps step0 .. step0+k-1. The
+// scratch pair holds half rows too (tile_rows + 2*(k-1) of them), so k blocked
+// steps match k single ones.
+static inline void h2d_plate_advance_hq(const h2d_plate* p, const h2d_half* src, h2d_half* dst,
+                                        h2d_half* scratch0, h2d_half* scratch1, uint32_t tile_rows,
+                                        uint32_t b0, uint32_t b1, uint32_t k, uint32_t step0,
+                                        h2d_display* disp) {
+    if (k <= 1) {
+        h2d_plate_step_rows_hq(p, src, 0, dst, 0, b0, b1, step0, disp);
+        return;
+    }
+
+    h2d_half* scratch[2] = { scratch0, scratch1 };
+    for (uint32_t t0 = b0; t0 < b1; t0 += tile_rows) {
+        uint32_t t1 = (t0 + tile_rows < b1) ? (t0 + tile_rows) : b1;
+        uint32_t lo = (t0 > k - 1) ? (t0 - (k - 1)) : 0;
+
+        const h2d_half* s_src = src;
+        uint32_t src_row0 = 0;
+        for (uint32_t s = 1; s <= k; s++) {
+            uint32_t halo = k - s;
+            uint32_t r0 = (t0 > halo) ? (t0 - halo) : 0;
+            uint32_t r1 = (t1 + halo < p->h) ? (t1 + halo) : p->h;
+
+            h2d_half* s_dst    = (s == k) ? dst : scratch[s & 1];
+            uint32_t  dst_row0 = (s == k) ? 0 : lo;
+            h2d_plate_step_rows_hq(p, s_src, src_row0, s_dst, dst_row0, r0, r1, step0 + s - 1,
+                                   (s == k) ? disp : 0);
+
+            s_src = s_dst;
+            src_row0 = dst_row0;
+        }
+    }
+}
+
+static inline void h2d_plate_advance_h(const h2d_plate* p, const h2d_half* src, h2d_half* dst,
+                                       h2d_half* scratch0, h2d_half* scratch1, uint32_t tile_rows,
+                                       uint32_t b0, uint32_t b1, uint32_t k, uint32_t step0) {
+    h2d_plate_advance_hq(p, src, dst, scratch0, scratch1, tile_rows, b0, b1, k, step0, 0);
+}
+
+// -------------------- Conduction --------------------
+// h2d_boundary_edge_span over half rows: copies bits, cold is +0.
+static inline void h2d_boundary_edge_span_h(h2d_half* t, const h2d_half* in, int32_t nx,
+                                            int32_t x0, int32_t x1, int mode) {
+    int32_t i0 = (x0 < 1) ? 1 : x0;
+    int32_t i1 = (x1 > nx-1) ? nx-1 : x1;
+    for (int32_t i = i0; i < i1; i++) t[i] = (mode == H2D_BC_DIRICHLET_COLD) ? 0 : in[i];
+
+    if (x0 <= 0 && x1 > 1)     t[0]    = (mode == H2D_BC_NEUMANN_INSULATED) ? in[1]    : 0;
+    if (x1 >= nx && x0 < nx-1) t[nx-1] = (mode == H2D_BC_NEUMANN_INSULATED) ? in[nx-2] : 0;
+}
+
+// h2d_conduct_span_q over half fields as step number step, boundary folded in
+// the same way.
+static inline void h2d_conduct_span_hq(const h2d_conduct* c, const h2d_half* src, int32_t src_row0,
+                                       h2d_half* dst, int32_t dst_row0, int32_t y0, int32_t y1,
+                                       int32_t x0, int32_t x1, uint32_t step, h2d_display* disp) {
+    const int32_t nx = c->nx;
+    int32_t j0 = (y0 < 1) ? 1 : y0;
+    int32_t j1 = (y1 > c->ny-1) ? c->ny-1 : y1;
+    int32_t i0 = (x0 < 1) ? 1 : x0;
+    int32_t i1 = (x1 > nx-1) ? nx-1 : x1;
+    const int insulated = (c->bc == H2D_BC_NEUMANN_INSULATED);
+    const int left  = (x0 <= 0 && x1 > 1);
+    const int right = (x1 >= nx && x0 < nx-1);
+
+#if defined(__ARM_NEON)
+    uint8x16x4_t tbl_regs;
+    const uint8x16x4_t* tbl = h2d_conduct_tbl(c, &tbl_regs);
+#endif
+
+    for (int32_t j = j0; j < j1; j++) {
+        const h2d_half* A = src + (j - src_row0)*nx;
+        h2d_half*       B = dst + (j - dst_row0)*nx;
+        const uint8_t*  M = c->mat + j*nx;
+        int32_t i = i0;
+#if defined(__ARM_NEON)
+        for (; i + 4 <= i1; i += 4) {
+            h2d_half_round4(B + i, h2d_conduct_vec4_v(c, tbl, M, i, nx, h2d_half_load4(A + i),
+                                                      h2d_half_load4(A + i + 1), h2d_half_load4(A + i - 1),
+                                                      h2d_half_load4(A + i + nx), h2d_half_load4(A + i - nx)),
+                            (uint32_t)(j*nx + i), step);
+        }
+#endif
+        for (; i < i1; i++) {
+            B[i] = h2d_half_round(h2d_conduct_cell_v(c, M, i, nx, h2d_half_to_float(A[i]),
+                                                     h2d_half_to_float(A[i + 1]),
+                                                     h2d_half_to_float(A[i - 1]),
+                                                     h2d_half_to_float(A[i + nx]),
+                                                     h2d_half_to_float(A[i - nx])),
+                                  (uint32_t)(j*nx + i), step);
+        }
+
+        if (left)  B[0]    = insulated ? B[1]    : 0;
+        if (right) B[nx-1] = insulated ? B[nx-2] : 0;
+        const int top    = (j == 1 && y0 <= 0);
+        const int bottom = (j == c->ny-2 && y1 >= c->ny);
+        if (top)    h2d_boundary_edge_span_h(B - nx, B, nx, x0, x1, c->bc);
+        if (bottom) h2d_boundary_edge_span_h(B + nx, B, nx, x0, x1, c->bc);
+        if (disp) {
+            if (top)    h2d_display_span_h(disp, B - nx, 0, (uint32_t)x0, (uint32_t)x1);
+            h2d_display_span_h(disp, B, (uint32_t)j, (uint32_t)x0, (uint32_t)x1);
+            if (bottom) h2d_display_span_h(disp, B + nx, (uint32_t)(c->ny-1), (uint32_t)x0, (uint32_t)x1);
+        }
+    }
+}
+
+static inline void h2d_conduct_span_h(const h2d_conduct* c, const h2d_half* src, int32_t src_row0,
+                                      h2d_half* dst, int32_t dst_row0, int32_t y0, int32_t y1,
+                                      int32_t x0, int32_t x1, uint32_t step) {
+    h2d_conduct_span_hq(c, src, src_row0, dst, dst_row0, y0, y1, x0, x1, step, 0);
+}
+
+static inline void h2d_conduct_rows_h(const h2d_conduct* c, const h2d_half* src, int32_t src_row0,
+                                      h2d_half* dst, int32_t dst_row0, int32_t y0, int32_t y1,
+                                      uint32_t step) {
+    h2d_conduct_span_h(c, src, src_row0, dst, dst_row0, y0, y1, 0, c->nx, step);
+}
+
+// h2d_stamp_sources_rows over half rows (the max taken on the stored values).
+static inline void h2d_stamp_sources_rows_h(const h2d_rect_sources* s, h2d_half* rows, int32_t row0,
+                                            int32_t nx, int32_t ny, int32_t row_lo, int32_t row_hi) {
+    const h2d_half hv = h2d_half_from_float(s->temp);
+    const float v = h2d_half_to_float(hv);
+    for (uint32_t n = 0; n < sizeof(s->x0)/sizeof(s->x0[0]); n++) {
+        int32_t x0 = h2d_clampi(s->x0[n], 0, nx-1);
+        int32_t x1 = h2d_clampi(s->x0[n] + s->w - 1, 0, nx-1);
+        int32_t y0 = h2d_clampi(s->y0, 0, ny-1);
+        int32_t y1 = h2d_clampi(s->y0 + s->h - 1, 0, ny-1);
+        if (y0 < row_lo) y0 = row_lo;
+        if (y1 > row_hi - 1) y1 = row_hi - 1;
+        for (int32_t j = y0; j <= y1; j++) {
+            h2d_half* r = rows + (j - row0)*nx;
+            for (int32_t i = x0; i <= x1; i++) {
+                if (v > h2d_half_to_float(r[i])) r[i] = hv;
+            }
+        }
+    }
+}
+
+// h2d_conduct_advance_q over half fields as steps step0 .. step0+k-1, half
+// scratch rows included.
+static inline void h2d_conduct_advance_hq(const h2d_conduct* c, const h2d_half* a, h2d_half* b,
+                                          h2d_half* scratch0, h2d_half* scratch1, int32_t tile_rows,
+                                          int32_t b0, int32_t b1, uint32_t k, uint32_t step0,
+                                          h2d_display* disp) {
+    const int32_t nx = c->nx, ny = c->ny;
+    if (k <= 1 || scratch0 == 0 || scratch1 == 0) {
+        h2d_conduct_span_hq(c, a, 0, b, 0, b0, b1, 0, nx, step0, disp);
+        return;
+    }
+
+    h2d_half* scratch[2] = { scratch0, scratch1 };
+    int32_t halo = (int32_t)k - 1;
+
+    for (int32_t t0 = b0; t0 < b1; ) {
+        int32_t t1 = (t0 + tile_rows < b1) ? (t0 + tile_rows) : b1;
+        if (t1 > ny - 2) t1 = b1;
+        int32_t lo = (t0 > halo) ? (t0 - halo) : 0;
+
+        const h2d_half* s_src = a;
+        int32_t src_row0 = 0;
+        for (uint32_t s = 1; s <= k; s++) {
+            int32_t h  = (int32_t)(k - s);
+            int32_t r0 = (t0 > h) ? (t0 - h) : 0;
+            int32_t r1 = (t1 + h < ny) ? (t1 + h) : ny;
+
+            h2d_half* s_dst    = (s == k) ? b : scratch[s & 1];
+            int32_t   dst_row0 = (s == k) ? 0 : lo;
+
+            h2d_conduct_span_hq(c, s_src, src_row0, s_dst, dst_row0, r0, r1, 0, nx, step0 + s - 1,
+                                (s == k) ? disp : 0);
+            if (s < k && c->src) h2d_stamp_sources_rows_h(c->src, s_dst, dst_row0, nx, ny, r0, r1);
+
+            s_src = s_dst;
+            src_row0 = dst_row0;
+        }
+        t0 = t1;
+    }
+}
+
+static inline void h2d_conduct_advance_h(const h2d_conduct* c, const h2d_half* a, h2d_half* b,
+                                         h2d_half* scratch0, h2d_half* scratch1, int32_t tile_rows,
+                                         int32_t b0, int32_t b1, uint32_t k, uint32_t step0) {
+    h2d_conduct_advance_hq(c, a, b, scratch0, scratch1, tile_rows, b0, b1, k, step0, 0);
+}
+
+#endif // HEAT2D_HALF_H
@@ -0,0 +1,374 @@
+// heat2d_multigrid.h - steady state of the conduction solver by geometric multigrid
+//
+// The explicit step needs tens of thousands of steps to settle the heatsink:
+// the 1:100 copper/air contrast makes it stiff, and the slowest mode shrinks
+// with the grid size squared. The field it settles to solves
+//
+//     sum over faces  kface * (T_neighbour - T) = 0
+//
+// in every interior cell, with the source rectangles held at their temperature
+// and the edges given by the boundary mode. h2d_mg_solve solves that directly:
+// conjugate gradients preconditioned by one multigrid V-cycle per iteration,
+// with red-black Gauss-Seidel smoothing on every level, 2x2 cell aggregation
+// between levels and coarse operators built from the fine face conductivities
+// (Galerkin over the aggregates, so a copper fin stays one strong path on every
+// level instead of being averaged into the air around it). Plain V-cycles with
+// that transfer stall at a few digits on the heatsink; as a preconditioner the
+// same cycle converges in a few dozen iterations whatever the grid size.
+//
+// The result is the fixed point of h2d_conduct_rows (boundary included)
+// outside the sources: stepping it again only nudges the source cells, which
+// the next stamp puts back.
+
+#ifndef HEAT2D_MULTIGRID_H
+#define HEAT2D_MULTIGRID_H
+
+#include "heat2d_conduct.h"
+
+#define H2D_MG_LEVELS_MAX 16
+
+// One level. Cells are unknown or fixed; the frame (row/column 0 and n-1) is
+// always fixed, so the smoother never leaves the grid. kx/ky are the face
+// conductivities to the right/down neighbour, kg a conductance to 0 (faces
+// to fixed cells folded in on coarse levels).
+typedef struct {
+    int32_t  nx, ny;
+    float*   u;        // correction; 0 on fixed cells
+    float*   f;        // right-hand side (level 0: the CG residual)
+    float*   kx;
+    float*   ky;
+    float*   kg;
+    uint8_t* fixed;
+} h2d_mg_level;
+
+typedef struct {
+    const h2d_conduct* c;
+    uint32_t     levels;
+    uint32_t     pre, post;        // smoothing sweeps per level on the way down / up
+    uint32_t     coarse;           // sweeps each way on the coarsest level
+    float        over;             // coarse-correction scale, in [1, 2)
+    float*       p;                // CG search direction and its image, level 0 size
+    float*       q;
+    h2d_mg_level lv[H2D_MG_LEVELS_MAX];
+} h2d_mg;
+
+// Interior cells [1, n-1) pair up into coarse cells; stop once a side has two
+// interior cells left.
+static inline int32_t h2d_mg_coarse_n(int32_t n) {
+    return (n - 2 + 1) / 2 + 2;
+}
+
+static inline uint32_t h2d_mg_level_count(int32_t nx, int32_t ny) {
+    uint32_t levels = 1;
+    while (levels < H2D_MG_LEVELS_MAX && nx - 2 > 2 && ny - 2 > 2) {
+        nx = h2d_mg_coarse_n(nx);
+        ny = h2d_mg_coarse_n(ny);
+        levels++;
+    }
+    return levels;
+}
+
+// Workspace h2d_mg_init needs for an nx x ny grid (about 36 bytes per cell).
+static inline uint32_t h2d_mg_bytes(int32_t nx, int32_t ny) {
+    uint32_t levels = h2d_mg_level_count(nx, ny);
+    uint32_t bytes = 2 * (uint32_t)nx * (uint32_t)ny * (uint32_t)sizeof(float);
+    for (uint32_t l = 0; l < levels; l++) {
+        uint32_t n = (uint32_t)nx * (uint32_t)ny;
+        bytes += n * (uint32_t)(5 * sizeof(float) + 1);
+        nx = h2d_mg_coarse_n(nx);
+        ny = h2d_mg_coarse_n(ny);
+    }
+    return bytes;
+}
+
+// Level 0 from the conduction setup: faces into an insulated edge carry no
+// flux (the edge copies its neighbour), cold edges and sources are fixed cells.
+static inline void h2d_mg_fine_level(h2d_mg_level* L, const h2d_conduct* c) {
+    const int32_t nx = c->nx, ny = c->ny;
+    const int bc = c->bc;
+    const int side_cold = (bc != H2D_BC_NEUMANN_INSULATED);
+    const int edge_cold = (bc == H2D_BC_DIRICHLET_COLD);
+
+    for (int32_t j = 0; j < ny; j++) {
+        for (int32_t i = 0; i < nx; i++) {
+            int32_t idx = j*nx + i;
+            const float* KC = c->kface + c->mat[idx] * c->nmat;
+            float kx = (i < nx-1) ? KC[c->mat[idx + 1]]  : 0.0f;
+            float ky = (j < ny-1) ? KC[c->mat[idx + nx]] : 0.0f;
+            if (!side_cold && (i == 0 || i == nx-2)) kx = 0.0f;
+            if (!edge_cold && (j == 0 || j == ny-2)) ky = 0.0f;
+            if (j == 0 || j == ny-1) kx = 0.0f;   // along an edge, never interior
+            if (i == 0 || i == nx-1) ky = 0.0f;
+            L->kx[idx] = kx;
+            L->ky[idx] = ky;
+            L->kg[idx] = 0.0f;
+            L->fixed[idx] = (i == 0 || i == nx-1 || j == 0 || j == ny-1);
+        }
+    }
+
+    const h2d_rect_sources* s = c->src;
+    if (!s) return;
+    for (uint32_t n = 0; n < sizeof(s->x0)/sizeof(s->x0[0]); n++) {
+        int32_t x0 = h2d_clampi(s->x0[n], 0, nx-1);
+        int32_t x1 = h2d_clampi(s->x0[n] + s->w - 1, 0, nx-1);
+        int32_t y0 = h2d_clampi(s->y0, 0, ny-1);
+        int32_t y1 = h2d_clampi(s->y0 + s->h - 1, 0, ny-1);
+        for (int32_t j = y0; j <= y1; j++) {
+            for (int32_t i = x0; i <= x1; i++) L->fixed[j*nx + i] = 1;
+        }
+    }
+}
+
+// Coarse operator over the 2x2 aggregates of F's unknown cells (Galerkin with
+// piecewise-constant transfer): faces between aggregates add up, faces from an
+// aggregate to fixed cells become its kg. Symmetric, like the fine operator.
+static inline void h2d_mg_coarse_level(h2d_mg_level* C, const h2d_mg_level* F) {
+    const int32_t fx = F->nx, cx = C->nx;
+    const int32_t cn = C->nx * C->ny;
+    for (int32_t i = 0; i < cn; i++) {
+        C->kx[i] = 0.0f;
+        C->ky[i] = 0.0f;
+        C->kg[i] = 0.0f;
+        C->fixed[i] = 1;
+    }
+
+    for (int32_t j = 1; j < F->ny - 1; j++) {
+        int32_t J = (j + 1) / 2;
+        for (int32_t i = 1; i < fx - 1; i++) {
+            int32_t idx = j*fx + i;
+            if (F->fixed[idx]) continue;
+            int32_t I = (i + 1) / 2;
+            int32_t ci = J*cx + I;
+            float g = F->kg[idx];
+
+            C->fixed[ci] = 0;
+            if (F->fixed[idx + 1])      g += F->kx[idx];
+            else if ((i + 2) / 2 != I)  C->kx[ci] += F->kx[idx];
+            if (F->fixed[idx + fx])     g += F->ky[idx];
+            else if ((j + 2) / 2 != J)  C->ky[ci] += F->ky[idx];
+            if (F->fixed[idx - 1])      g += F->kx[idx - 1];
+            if (F->fixed[idx - fx])     g += F->ky[idx - fx];
+            C->kg[ci] += g;
+        }
+    }
+}
+
+// Carve the level hierarchy for c out of work (h2d_mg_bytes(c->nx, c->ny)
+// bytes, float-aligned) and build every level's operator. Rebuild when the
+// materials, sources or boundary mode change.
+static inline void h2d_mg_init(h2d_mg* m, const h2d_conduct* c, void* work) {
+    m->c = c;
+    m->levels = h2d_mg_level_count(c->nx, c->ny);
+    m->pre = 2;
+    m->post = 2;
+    m->coarse = 16;
+    m->over = 1.8f;
+
+    float* fp = (float*)work;
+    int32_t nx = c->nx, ny = c->ny;
+    m->p = fp; fp += nx * ny;
+    m->q = fp; fp += nx * ny;
+    for (uint32_t l = 0; l < m->levels; l++) {
+        h2d_mg_level* L = &m->lv[l];
+        int32_t n = nx * ny;
+        L->nx = nx;
+        L->ny = ny;
+        L->u  = fp; fp += n;
+        L->f  = fp; fp += n;
+        L->kx = fp; fp += n;
+        L->ky = fp; fp += n;
+        L->kg = fp; fp += n;
+        nx = h2d_mg_coarse_n(nx);
+        ny = h2d_mg_coarse_n(ny);
+    }
+    uint8_t* bp = (uint8_t*)fp;
+    for (uint32_t l = 0; l < m->levels; l++) {
+        m->lv[l].fixed = bp;
+        bp += m->lv[l].nx * m->lv[l].ny;
+    }
+
+    h2d_mg_fine_level(&m->lv[0], c);
+    for (uint32_t l = 1; l < m->levels; l++) h2d_mg_coarse_level(&m->lv[l], &m->lv[l - 1]);
+}
+
+// Residual of cell idx: f + sum k (u_n - u) - kg u.
+static inline float h2d_mg_residual(const h2d_mg_level* L, int32_t idx) {
+    const int32_t nx = L->nx;
+    const float* u = L->u;
+    float uc = u[idx];
+    return L->f[idx]
+         + L->kx[idx]      * (u[idx + 1]  - uc)
+         + L->kx[idx - 1]  * (u[idx - 1]  - uc)
+         + L->ky[idx]      * (u[idx + nx] - uc)
+         + L->ky[idx - nx] * (u[idx - nx] - uc)
+         - L->kg[idx] * uc;
+}
+
+// Red-black Gauss-Seidel: each colour solves its cells' equations against the
+// other colour's current values, red first or black first. Cells with no
+// conductance keep their value.
+static inline void h2d_mg_smooth(h2d_mg_level* L, uint32_t sweeps, int32_t first) {
+    const int32_t nx = L->nx, ny = L->ny;
+    float* u = L->u;
+    for (uint32_t s = 0; s < sweeps; s++) {
+        for (int32_t pass = 0; pass < 2; pass++) {
+            int32_t color = first ^ pass;
+            for (int32_t j = 1; j < ny - 1; j++) {
+                int32_t i0 = 1 + ((j + 1 + color) & 1);
+                for (int32_t i = i0; i < nx - 1; i += 2) {
+                    int32_t idx = j*nx + i;
+                    if (L->fixed[idx]) continue;
+                    float kr = L->kx[idx], kl = L->kx[idx - 1];
+                    float kd = L->ky[idx], ku = L->ky[idx - nx];
+                    float diag = kr + kl + kd + ku + L->kg[idx];
+                    if (diag <= 0.0f) continue;
+                    u[idx] = (L->f[idx] + kr * u[idx + 1] + kl * u[idx - 1]
+                                        + kd * u[idx + nx] + ku * u[idx - nx]) / diag;
+                }
+            }
+        }
+    }
+}
+
+// Coarse right-hand side: each aggregate sums its unknown cells' residuals.
+// The coarse correction starts from 0.
+static inline void h2d_mg_restrict(const h2d_mg_level* F, h2d_mg_level* C) {
+    const int32_t cn = C->nx * C->ny;
+    for (int32_t i = 0; i < cn; i++) {
+        C->u[i] = 0.0f;
+        C->f[i] = 0.0f;
+    }
+    for (int32_t j = 1; j < F->ny - 1; j++) {
+        int32_t crow = ((j + 1) / 2) * C->nx;
+        for (int32_t i = 1; i < F->nx - 1; i++) {
+            int32_t idx = j*F->nx + i;
+            if (!F->fixed[idx]) C->f[crow + (i + 1) / 2] += h2d_mg_residual(F, idx);
+        }
+    }
+}
+
+// Add each aggregate's correction, times over, to its unknown cells. A constant
+// per aggregate undershoots a smooth error by about half; scaling it back up
+// halves the CG iterations on the heatsink (41 -> 20 at 260x220).
+static inline void h2d_mg_prolong(const h2d_mg_level* C, h2d_mg_level* F, float over) {
+    for (int32_t j = 1; j < F->ny - 1; j++) {
+        const float* e = C->u + ((j + 1) / 2) * C->nx;
+        for (int32_t i = 1; i < F->nx - 1; i++) {
+            int32_t idx = j*F->nx + i;
+            if (!F->fixed[idx]) F->u[idx] += over * e[(i + 1) / 2];
+        }
+    }
+}
+
+// One V-cycle from u = 0 on level 0 for its f. Black-first sweeps on the way
+// up mirror the red-first ones on the way down, so the cycle is a symmetric
+// operator and can precondition CG.
+static inline void h2d_mg_vcycle(h2d_mg* m) {
+    const uint32_t last = m->levels - 1;
+    h2d_mg_level* L0 = &m->lv[0];
+    for (int32_t i = 0; i < L0->nx * L0->ny; i++) L0->u[i] = 0.0f;
+
+    for (uint32_t l = 0; l < last; l++) {
+        h2d_mg_smooth(&m->lv[l], m->pre, 0);
+        h2d_mg_restrict(&m->lv[l], &m->lv[l + 1]);
+    }
+    h2d_mg_smooth(&m->lv[last], m->coarse, 0);
+    h2d_mg_smooth(&m->lv[last], m->coarse, 1);
+    for (uint32_t l = last; l-- > 0; ) {
+        h2d_mg_prolong(&m->lv[l + 1], &m->lv[l], m->over);
+        h2d_mg_smooth(&m->lv[l], m->post, 1);
+    }
+}
+
+// out = -(sum k (v_n - v) - kg v) on level 0's unknown cells, 0 on fixed ones.
+// v must be 0 on fixed cells.
+static inline void h2d_mg_apply(const h2d_mg_level* L, const float* v, float* out) {
+    const int32_t nx = L->nx;
+    for (int32_t i = 0; i < nx * L->ny; i++) out[i] = 0.0f;
+    for (int32_t j = 1; j < L->ny - 1; j++) {
+        for (int32_t i = 1; i < nx - 1; i++) {
+            int32_t idx = j*nx + i;
+            if (L->fixed[idx]) continue;
+            float vc = v[idx];
+            out[idx] = L->kx[idx]      * (vc - v[idx + 1])
+                     + L->kx[idx - 1]  * (vc - v[idx - 1])
+                     + L->ky[idx]      * (vc - v[idx + nx])
+                     + L->ky[idx - nx] * (vc - v[idx - nx])
+                     + L->kg[idx] * vc;
+        }
+    }
+}
+
+static inline double h2d_mg_dot(const float* a, const float* b, int32_t n) {
+    double s = 0.0;
+    for (int32_t i = 0; i < n; i++) s += (double)a[i] * (double)b[i];
+    return s;
+}
+
+static inline float h2d_mg_max_abs(const float* a, int32_t n) {
+    float m = 0.0f;
+    for (int32_t i = 0; i < n; i++) m = __builtin_fmaxf(m, __builtin_fabsf(a[i]));
+    return m;
+}
+
+// Solve t (nx*ny, any starting field) for the steady state of m->c in place:
+// sources set to their temperature, edges per the boundary mode. Iterates
+// until the largest residual is rtol times the starting one or max_iters ran;
+// the residual is in explicit-step units divided by base_r, so rtol 1e-6 from
+// a cold start leaves steps of a few 1e-7. Returns the iterations run.
+static inline uint32_t h2d_mg_solve(h2d_mg* m, float* t, uint32_t max_iters, float rtol) {
+    const h2d_conduct* c = m->c;
+    h2d_mg_level* L = &m->lv[0];
+    const int32_t n = c->nx * c->ny;
+    float* r = L->f;
+    float* z = L->u;
+    float* p = m->p;
+    float* q = m->q;
+
+    if (c->src) {
+        const h2d_rect_sources* s = c->src;
+        for (uint32_t k = 0; k < sizeof(s->x0)/sizeof(s->x0[0]); k++) {
+            int32_t x0 = h2d_clampi(s->x0[k], 0, c->nx-1);
+            int32_t x1 = h2d_clampi(s->x0[k] + s->w - 1, 0, c->nx-1);
+            int32_t y0 = h2d_clampi(s->y0, 0, c->ny-1);
+            int32_t y1 = h2d_clampi(s->y0 + s->h - 1, 0, c->ny-1);
+            for (int32_t j = y0; j <= y1; j++) {
+                for (int32_t i = x0; i <= x1; i++) t[j*c->nx + i] = s->temp;
+            }
+        }
+    }
+    h2d_apply_boundary(t, c->nx, c->ny, c->bc);
+
+    // r = -A t: the residual of the unknown cells against the fixed ones
+    h2d_mg_apply(L, t, r);
+    for (int32_t i = 0; i < n; i++) r[i] = -r[i];
+    float r0 = h2d_mg_max_abs(r, n);
+
+    h2d_mg_vcycle(m);
+    for (int32_t i = 0; i < n; i++) p[i] = z[i];
+    double rz = h2d_mg_dot(r, z, n);
+
+    uint32_t it = 0;
+    while (it < max_iters && h2d_mg_max_abs(r, n) > rtol * r0) {
+        h2d_mg_apply(L, p, q);
+        double pq = h2d_mg_dot(p, q, n);
+        if (!(pq > 0.0)) break;          // nothing left the operator can see
+        float alpha = (float)(rz / pq);
+        for (int32_t i = 0; i < n; i++) {
+            t[i] += alpha * p[i];
+            r[i] -= alpha * q[i];
+        }
+        it++;
+
+        h2d_mg_vcycle(m);
+        double rz_next = h2d_mg_dot(r, z, n);
+        float beta = (float)(rz_next / rz);
+        rz = rz_next;
+        for (int32_t i = 0; i < n; i++) p[i] = z[i] + beta * p[i];
+    }
+
+    h2d_apply_boundary(t, c->nx, c->ny, c->bc);
+    return it;
+}
+
+#endif // HEAT2D_MULTIGRID_H
@@ -0,0 +1,276 @@
+// heat2d_plate.h - uniform-alpha explicit solver (the metal demo)
+//
+// T' = clamp01(T + alpha * lap(T) - cooling * T) on a w x h grid with
+// Dirichlet-zero edges and a disk source re-stamped after every step.
+
+#ifndef HEAT2D_PLATE_H
+#define HEAT2D_PLATE_H
+
+#include "heat2d_core.h"
+#include "heat2d_active.h"
+#include "heat2d_display.h"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Cells advanced per NEON loop iteration: 4, 8, 12 or 16 (one to four float32x4
+// registers). Override with -DSTENCIL_VEC_CELLS=N; the scalar tail covers the rest.
+#ifndef STENCIL_VEC_CELLS
+#define STENCIL_VEC_CELLS 16
+#endif
+#if STENCIL_VEC_CELLS < 4 || STENCIL_VEC_CELLS > 16 || (STENCIL_VEC_CELLS % 4) != 0
+#error "STENCIL_VEC_CELLS must be 4, 8, 12 or 16"
+#endif
+
+typedef struct {
+    uint32_t w, h;          // grid size, edge rows/columns included
+    float    alpha;         // stable for alpha <= 0.25
+    float    cooling;
+    int      src_x, src_y;  // heat source disk, re-stamped after every step
+    int      src_r;
+    float    src_temp;
+} h2d_plate;
+
+static inline float h2d_plate_cell(const h2d_plate* p, float t, float l, float r, float u, float d) {
+    float lap = l + r + u + d - 4.0f * t;
+    return h2d_clamp01(t + p->alpha * lap - p->cooling * t);
+}
+
+#if defined(__ARM_NEON)
+// Four cells from their centre and neighbour values (t, l, r, u, d).
+static inline float32x4_t h2d_plate_vec4_v(const h2d_plate* p, float32x4_t t, float32x4_t l,
+                                           float32x4_t r, float32x4_t u, float32x4_t d) {
+    // same summation order as h2d_plate_cell so the tail matches the vector body
+    float32x4_t lap = vaddq_f32(vaddq_f32(vaddq_f32(l, r), u), d);
+    lap = vsubq_f32(lap, vmulq_n_f32(t, 4.0f));
+    float32x4_t next = vsubq_f32(vaddq_f32(t, vmulq_n_f32(lap, p->alpha)),
+                                 vmulq_n_f32(t, p->cooling));
+    // clamp01 without branches: fmax/fmin against splatted bounds
+    return vminq_f32(vmaxq_f32(next, vdupq_n_f32(0.f)), vdupq_n_f32(1.f));
+}
+
+static inline float32x4_t h2d_plate_vec4(const h2d_plate* p,
+                                         const float* up, const float* c, const float* dn) {
+    return h2d_plate_vec4_v(p, vld1q_f32(c), vld1q_f32(c - 1), vld1q_f32(c + 1),
+                            vld1q_f32(up), vld1q_f32(dn));
+}
+#endif
+
+// Advance interior cells x in [x0, x1) of one row (1 <= x0, x1 <= w-1). up/c/dn
+// are the previous, current and next rows of the source field.
+static inline void h2d_plate_row_span(const h2d_plate* p, const float* up, const float* c,
+                                      const float* dn, float* out, uint32_t x0, uint32_t x1) {
+    uint32_t x = x0;
+#if defined(__ARM_NEON)
+    for (; x + STENCIL_VEC_CELLS <= x1; x += STENCIL_VEC_CELLS) {
+#pragma GCC unroll 4
+        for (uint32_t v = 0; v < STENCIL_VEC_CELLS; v += 4) {
+            vst1q_f32(out + x + v, h2d_plate_vec4(p, up + x + v, c + x + v, dn + x + v));
+        }
+    }
+#endif
+    for (; x < x1; x++) {
+        out[x] = h2d_plate_cell(p, c[x], c[x - 1], c[x + 1], up[x], dn[x]);
+    }
+}
+
+// Advance interior cells x = 1..w-2 of one row; edge columns are left to the caller.
+static inline void h2d_plate_row(const h2d_plate* p, const float* up, const float* c,
+                                 const float* dn, float* out) {
+    h2d_plate_row_span(p, up, c, dn, out, 1, p->w - 1);
+}
+
+// Stamp the part of a disk that falls in grid rows [y0, y1) and columns [x0, x1).
+// rows points at grid row row0, so this works on the full field and on partial
+// row windows alike.
+static inline void h2d_plate_stamp_disk_rect(const h2d_plate* p, float* rows, uint32_t row0,
+                                             uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1,
+                                             int cx, int cy, int r, float v) {
+    int r2 = r * r;
+    for (int dy = -r; dy <= r; dy++) {
+        int y = cy + dy;
+        if (y <= 0 || y >= (int)p->h - 1 || y < (int)y0 || y >= (int)y1) continue;
+        float* row = rows + ((uint32_t)y - row0) * p->w;
+        for (int dx = -r; dx <= r; dx++) {
+            int x = cx + dx;
+            if (x <= 0 || x >= (int)p->w - 1 || x < (int)x0 || x >= (int)x1) continue;
+            if (dx*dx + dy*dy <= r2) row[x] = v;
+        }
+    }
+}
+
+static inline void h2d_plate_stamp_disk(const h2d_plate* p, float* rows, uint32_t row0,
+                                        uint32_t y0, uint32_t y1,
+                                        int cx, int cy, int r, float v) {
+    h2d_plate_stamp_disk_rect(p, rows, row0, 0, p->w, y0, y1, cx, cy, r, v);
+}
+
+// Grid rows [y0, y1) of dst from src, edge rows/columns and heat source included,
+// so a core owning a band writes its part of the boundary in the same pass.
+// src/dst point at grid rows src_row0/dst_row0 (0 for the full field). With a
+// display plane each finished row (disk included) is quantized into it right
+// after it is stored.
+static inline void h2d_plate_step_rows_q(const h2d_plate* p, const float* src, uint32_t src_row0,
+                                         float* dst, uint32_t dst_row0, uint32_t y0, uint32_t y1,
+                                         h2d_display* disp) {
+    const uint32_t w = p->w;
+    for (uint32_t y = y0; y < y1; y++) {
+        float* out = dst + (y - dst_row0) * w;
+        if (y == 0 || y == p->h - 1) {
+            for (uint32_t x = 0; x < w; x++) out[x] = 0.f;
+        } else {
+            const float* c = src + (y - src_row0) * w;
+            h2d_plate_row(p, c - w, c, c + w, out);
+            out[0] = 0.f;
+            out[w - 1] = 0.f;
+        }
+        if (disp) {
+            h2d_plate_stamp_disk(p, dst, dst_row0, y, y + 1, p->src_x, p->src_y, p->src_r, p->src_temp);
+            h2d_display_span(disp, out, y, 0, w);
+        }
+    }
+    if (!disp) h2d_plate_stamp_disk(p, dst, dst_row0, y0, y1, p->src_x, p->src_y, p->src_r, p->src_temp);
+}
+
+static inline void h2d_plate_step_rows(const h2d_plate* p, const float* src, uint32_t src_row0,
+                                       float* dst, uint32_t dst_row0, uint32_t y0, uint32_t y1) {
+    h2d_plate_step_rows_q(p, src, src_row0, dst, dst_row0, y0, y1, 0);
+}
+
+// Temporal blocking: advance rows [b0, b1) of dst by k steps from src. The band
+// is walked in tiles of tile_rows rows; each tile plus a (k-1)-row halo on either
+// side is stepped in the scratch pair, the valid rows shrinking by one per step
+// (overlapped trapezoids), and only step k is written to dst. Every cell still
+// goes through h2d_plate_step_rows once per step, so k=4 is bit-identical to four
+// k=1 calls while src/dst are streamed once. Redundant halo work is ~(k-1)/tile_rows.
+// Each scratch buffer holds tile_rows + 2*(k-1) rows; k <= 1 needs none.
+// disp, if set, gets the LUT indices of dst as step k stores them.
+static inline void h2d_plate_advance_q(const h2d_plate* p, const float* src, float* dst,
+                                       float* scratch0, float* scratch1, uint32_t tile_rows,
+                                       uint32_t b0, uint32_t b1, uint32_t k, h2d_display* disp) {
+    if (k <= 1) {
+        h2d_plate_step_rows_q(p, src, 0, dst, 0, b0, b1, disp);
+        return;
+    }
+
+    float* scratch[2] = { scratch0, scratch1 };
+    for (uint32_t t0 = b0; t0 < b1; t0 += tile_rows) {
+        uint32_t t1 = (t0 + tile_rows < b1) ? (t0 + tile_rows) : b1;
+        uint32_t lo = (t0 > k - 1) ? (t0 - (k - 1)) : 0; // grid row of scratch row 0
+
+        const float* s_src = src;
+        uint32_t src_row0 = 0;
+        for (uint32_t s = 1; s <= k; s++) {
+            uint32_t halo = k - s;
+            uint32_t r0 = (t0 > halo) ? (t0 - halo) : 0;
+            uint32_t r1 = (t1 + halo < p->h) ? (t1 + halo) : p->h;
+
+            float*   s_dst    = (s == k) ? dst : scratch[s & 1];
+            uint32_t dst_row0 = (s == k) ? 0 : lo;
+            h2d_plate_step_rows_q(p, s_src, src_row0, s_dst, dst_row0, r0, r1, (s == k) ? disp : 0);
+
+            s_src = s_dst;
+            src_row0 = dst_row0;
+        }
+    }
+}
+
+static inline void h2d_plate_advance(const h2d_plate* p, const float* src, float* dst,
+                                     float* scratch0, float* scratch1, uint32_t tile_rows,
+                                     uint32_t b0, uint32_t b1, uint32_t k) {
+    h2d_plate_advance_q(p, src, dst, scratch0, scratch1, tile_rows, b0, b1, k, 0);
+}
+
+// -------------------- Active tiles --------------------
+// One step of the block [x0, x1) x [y0, y1) of the full field, edges and source
+// included; same arithmetic as h2d_plate_step_rows. Returns the block's max |dT|.
+static inline float h2d_plate_block(const h2d_plate* p, const float* src, float* dst,
+                                    uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1) {
+    const uint32_t w = p->w;
+    uint32_t i0 = (x0 < 1) ? 1 : x0;
+    uint32_t i1 = (x1 > w - 1) ? w - 1 : x1;
+    for (uint32_t y = y0; y < y1; y++) {
+        float* out = dst + y * w;
+        if (y == 0 || y == p->h - 1) {
+            for (uint32_t x = x0; x < x1; x++) out[x] = 0.f;
+            continue;
+        }
+        const float* c = src + y * w;
+        h2d_plate_row_span(p, c - w, c, c + w, out, i0, i1);
+        if (x0 == 0) out[0] = 0.f;
+        if (x1 == w) out[w - 1] = 0.f;
+    }
+    h2d_plate_stamp_disk_rect(p, dst, 0, x0, x1, y0, y1, p->src_x, p->src_y, p->src_r, p->src_temp);
+
+    float dmax = 0.f;
+    for (uint32_t y = y0; y < y1; y++) {
+        for (uint32_t x = x0; x < x1; x++) {
+            dmax = __builtin_fmaxf(dmax, __builtin_fabsf(dst[y * w + x] - src[y * w + x]));
+        }
+    }
+    return dmax;
+}
+
+// One step of the awake tiles in tile rows [ty0, ty1); sleeping tiles are left
+// alone (both buffers already agree there). Tile rows are independent, so cores
+// can split them; h2d_active_update follows once all rows are done.
+static inline void h2d_plate_active_rows(const h2d_plate* p, h2d_active* a,
+                                         const float* src, float* dst,
+                                         uint32_t ty0, uint32_t ty1) {
+    for (uint32_t ty = ty0; ty < ty1; ty++) {
+        uint32_t y0, y1;
+        h2d_active_span(a, ty, p->h, a->th, &y0, &y1);
+        for (uint32_t tx = 0; tx < a->tw; tx++) {
+            if (!h2d_active_awake(a, tx, ty)) continue;
+            uint32_t x0, x1;
+            h2d_active_span(a, tx, p->w, a->tw, &x0, &x1);
+            a->delta[ty * a->tw + tx] = h2d_plate_block(p, src, dst, x0, x1, y0, y1);
+            a->changed[ty * a->tw + tx] = 1;
+        }
+    }
+}
+
+// A round of k steps over the awake tiles of tile rows [ty0, ty1), for the
+// temporal blocking path. k <= 1 is h2d_plate_active_rows. Otherwise every run
+// of tile rows holding an awake tile is advanced k steps by h2d_plate_advance_q,
+// full width, so the run streams through the cache once per round; rows with
+// no awake tile are skipped and read as frozen halo. Then every tile of the run
+// is measured. The scratch pair is h2d_plate_advance_q's. disp, if set, gets
+// the LUT indices of the cells stored.
+static inline void h2d_plate_active_advance_q(const h2d_plate* p, h2d_active* a,
+                                              const float* src, float* dst,
+                                              float* scratch0, float* scratch1, uint32_t tile_rows,
+                                              uint32_t ty0, uint32_t ty1, uint32_t k,
+                                              h2d_display* disp) {
+    if (k <= 1) {
+        h2d_plate_active_rows(p, a, src, dst, ty0, ty1);
+        if (!disp) return;
+        for (uint32_t ty = ty0; ty < ty1; ty++) {
+            uint32_t y0, y1;
+            h2d_active_span(a, ty, p->h, a->th, &y0, &y1);
+            for (uint32_t tx = 0; tx < a->tw; tx++) {
+                if (!h2d_active_awake(a, tx, ty)) continue;
+                uint32_t x0, x1;
+                h2d_active_span(a, tx, p->w, a->tw, &x0, &x1);
+                for (uint32_t y = y0; y < y1; y++) h2d_display_span(disp, dst + y * p->w, y, x0, x1);
+            }
+        }
+        return;
+    }
+
+    for (uint32_t ty = ty0; ty < ty1; ) {
+        if (!h2d_active_row_awake(a, ty)) { ty++; continue; }
+        uint32_t te = ty + 1;
+        while (te < ty1 && h2d_active_row_awake(a, te)) te++;
+
+        uint32_t y0, y1, mid;
+        h2d_active_span(a, ty, p->h, a->th, &y0, &mid);
+        h2d_active_span(a, te - 1, p->h, a->th, &mid, &y1);
+        h2d_plate_advance_q(p, src, dst, scratch0, scratch1, tile_rows, y0, y1, k, disp);
+        h2d_active_measure_rows(a, src, dst, ty, te, k);
+        ty = te;
+    }
+}
+
+#endif // HEAT2D_PLATE_H
@@ -0,0 +1,164 @@
+// heat2d_render.h - palette LUTs and cell-to-pixel rendering
+//
+// Pixel packing is the front end's business (XRGB8888 for ramfb, PackPixel for
+// GOP); the core produces 8-bit RGB LUTs and blits already-packed uint32_t LUTs.
+
+#ifndef HEAT2D_RENDER_H
+#define HEAT2D_RENDER_H
+
+#include "heat2d_core.h"
+#include "heat2d_display.h"
+
+typedef struct { uint8_t r, g, b; } h2d_rgb8;
+
+typedef struct {
+    float   t;
+    uint8_t r, g, b;
+} h2d_color_stop;
+
+static inline uint8_t h2d_lerp_u8(uint8_t a, uint8_t b, float t) {
+    float x = (1.0f - t) * (float)a + t * (float)b;
+    if (x < 0) x = 0;
+    if (x > 255) x = 255;
+    return (uint8_t)(x + 0.5f);
+}
+
+// 256-entry LUT over t = i/255 from stops sorted by t (at least two).
+static inline void h2d_build_palette_lut(const h2d_color_stop* stops, uint32_t count,
+                                         h2d_rgb8* lut) {
+    if (!stops || count < 2) return;
+    for (int32_t i = 0; i < 256; i++) {
+        float t = (float)i / 255.0f;
+
+        int32_t k = 0;
+        while (k < (int32_t)count - 2 && t > stops[k+1].t) k++;
+
+        float t0 = stops[k].t;
+        float t1 = stops[k+1].t;
+        float u = (t1 > t0) ? ((t - t0) / (t1 - t0)) : 0.0f;
+        u = h2d_clampf(u, 0.0f, 1.0f);
+
+        lut[i].r = h2d_lerp_u8(stops[k].r, stops[k+1].r, u);
+        lut[i].g = h2d_lerp_u8(stops[k].g, stops[k+1].g, u);
+        lut[i].b = h2d_lerp_u8(stops[k].b, stops[k+1].b, u);
+    }
+}
+
+// LUT index of a temperature already in [0, 1] (truncating, as the plate renders).
+static inline uint8_t h2d_lut_index(float t) {
+    uint32_t pi = (uint32_t)(t * 255.0f);
+    if (pi > 255) pi = 255;
+    return (uint8_t)pi;
+}
+
+// Destination for h2d_render_cells: cell (x, y) covers the sx x sy pixel block
+// at px + y*sy*pitch + x*sx.
+typedef struct {
+    uint32_t* px;
+    uint32_t  pitch;    // pixels per scanline
+    uint32_t  sx, sy;   // pixels per cell
+} h2d_surface;
+
+typedef struct { uint32_t x0, y0, x1, y1; } h2d_rect;  // pixels, half-open
+
+// Fill the pixel block of cell (x, y).
+static inline void h2d_render_block(const h2d_surface* s, uint32_t x, uint32_t y, uint32_t color) {
+    uint32_t* blk = s->px + y * s->sy * s->pitch + x * s->sx;
+    for (uint32_t dy = 0; dy < s->sy; dy++) {
+        uint32_t* row = blk + dy * s->pitch;
+        for (uint32_t dx = 0; dx < s->sx; dx++) {
+            row[dx] = color;
+        }
+    }
+}
+
+// Draw cell rows [y0, y1) of a w x h field through a packed LUT, only rewriting
+// the blocks whose LUT index differs from drawn[] (all of them when full != 0),
+// and report what was touched as one rectangle per band of band_rows rows (bands
+// stay aligned to the full field). rects needs ceil(h / band_rows) entries;
+// returns how many were written. A settled row costs one byte compare per cell;
+// rows outside [y0, y1) (e.g. asleep per h2d_active_changed_rows) cost nothing.
+static inline uint32_t h2d_render_cells_rows(const float* field, uint32_t w, uint32_t h,
+                                             const uint32_t* lut, uint8_t* drawn, int full,
+                                             const h2d_surface* s, uint32_t band_rows,
+                                             h2d_rect* rects, uint32_t y0, uint32_t y1) {
+    uint32_t count = 0;
+    if (y1 > h) y1 = h;
+    for (uint32_t band_y0 = y0 - y0 % band_rows; band_y0 < y1; band_y0 += band_rows) {
+        uint32_t band_y1 = (band_y0 + band_rows < h) ? (band_y0 + band_rows) : h;
+        uint32_t dx0 = w, dx1 = 0;
+        uint32_t ry0 = (band_y0 > y0) ? band_y0 : y0;
+        uint32_t ry1 = (band_y1 < y1) ? band_y1 : y1;
+
+        for (uint32_t y = ry0; y < ry1; y++) {
+            const float* src = field + y * w;
+            uint8_t* d = drawn + y * w;
+
+            for (uint32_t x = 0; x < w; x++) {
+                uint8_t pi = h2d_lut_index(src[x]);
+                if (!full && d[x] == pi) continue;
+                d[x] = pi;
+                h2d_render_block(s, x, y, lut[pi]);
+
+                if (x < dx0) dx0 = x;
+                if (x + 1 > dx1) dx1 = x + 1;
+            }
+        }
+
+        if (dx0 < dx1) {
+            h2d_rect r = { dx0 * s->sx, band_y0 * s->sy, dx1 * s->sx, band_y1 * s->sy };
+            rects[count++] = r;
+        }
+    }
+    return count;
+}
+
+static inline uint32_t h2d_render_cells(const float* field, uint32_t w, uint32_t h,
+                                        const uint32_t* lut, uint8_t* drawn, int full,
+                                        const h2d_surface* s, uint32_t band_rows,
+                                        h2d_rect* rects) {
+    return h2d_render_cells_rows(field, w, h, lut, drawn, full, s, band_rows, rects, 0, h);
+}
+
+// h2d_render_cells_rows from a display plane: one byte per cell, and rows whose
+// flag is clear are skipped (unless full). The flags of the rows looked at are
+// cleared, so the next frame only visits rows whose indices changed since.
+static inline uint32_t h2d_render_display_rows(h2d_display* disp, const uint32_t* lut,
+                                               uint8_t* drawn, int full, const h2d_surface* s,
+                                               uint32_t band_rows, h2d_rect* rects,
+                                               uint32_t y0, uint32_t y1) {
+    const uint32_t w = disp->w, h = disp->h;
+    uint32_t count = 0;
+    if (y1 > h) y1 = h;
+    for (uint32_t band_y0 = y0 - y0 % band_rows; band_y0 < y1; band_y0 += band_rows) {
+        uint32_t band_y1 = (band_y0 + band_rows < h) ? (band_y0 + band_rows) : h;
+        uint32_t dx0 = w, dx1 = 0;
+        uint32_t ry0 = (band_y0 > y0) ? band_y0 : y0;
+        uint32_t ry1 = (band_y1 < y1) ? band_y1 : y1;
+
+        for (uint32_t y = ry0; y < ry1; y++) {
+            if (!full && !disp->rows[y]) continue;
+            disp->rows[y] = 0;
+            const uint8_t* src = disp->idx + y * w;
+            uint8_t* d = drawn + y * w;
+
+            for (uint32_t x = 0; x < w; x++) {
+                uint8_t pi = src[x];
+                if (!full && d[x] == pi) continue;
+                d[x] = pi;
+                h2d_render_block(s, x, y, lut[pi]);
+
+                if (x < dx0) dx0 = x;
+                if (x + 1 > dx1) dx1 = x + 1;
+            }
+        }
+
+        if (dx0 < dx1) {
+            h2d_rect r = { dx0 * s->sx, band_y0 * s->sy, dx1 * s->sx, band_y1 * s->sy };
+            rects[count++] = r;
+        }
+    }
+    return count;
+}
+
+#endif // HEAT2D_RENDER_H
@@ -0,0 +1,469 @@
+// heat2d_spectral.h - exact time integration of the plate in a sine basis
+//
+// The plate (heat2d_plate.h) has one alpha, one cooling rate and zero edges,
+// so its operator L = alpha * lap - cooling is diagonal in the 2D discrete
+// sine basis: mode (p, q) decays at
+//
+//     lambda_pq = alpha * (4 sin^2(pi p / 2(nx+1)) + 4 sin^2(pi q / 2(ny+1))) + cooling
+//
+// per explicit step of time (nx, ny: interior cells). The disk source enters
+// as a constant forcing f on its cells, sized once (capacitance matrix) so the
+// steady state holds the disk exactly at src_temp. Then
+//
+//     T(t) = T_s + exp(-lambda t) (T - T_s)
+//
+// mode by mode: one forward 2D DST-I, one scale, one inverse, for any t. The
+// jump lands on the continuous-time solution, which the explicit step only
+// approximates (its high modes decay by 1 - alpha*mu per step instead of
+// exp(-alpha*mu)), and on the way there the disk warms up through its forcing
+// rather than being held at src_temp. Like a plate step, h2d_spec_finish
+// clamps the result and stamps the disk; far enough out both land on the same
+// steady state.
+//
+// DST-I of length n is the imaginary part of a DFT of length 2(n+1) of the odd
+// extension; two real rows ride in one complex DFT. A power-of-two 2(n+1) goes
+// straight to the radix-2 FFT; any other length through Bluestein's chirp-z
+// (a power-of-two FFT convolution), so every grid size is O(n log n).
+//
+// The transforms are banded by rows or columns, like the explicit step, so the
+// SMP front end can split them; each core needs its own buffer
+// (H2D_SPEC_BUF_FLOATS).
+
+#ifndef HEAT2D_SPECTRAL_H
+#define HEAT2D_SPECTRAL_H
+
+#include "heat2d_plate.h"
+
+// Per-core transform buffer, floats: an upper bound for any plate w x h.
+#define H2D_SPEC_BUF_FLOATS(w, h) (16u * ((w) > (h) ? (w) : (h)))
+
+// -------------------- Freestanding math --------------------
+// sin(pi x) in double; the twiddles and chirps need it to the last bit of a float.
+static inline double h2d_sinpi(double x) {
+    double sign = 1.0;
+    if (x < 0.0) { x = -x; sign = -1.0; }
+    x -= 2.0 * (double)(int64_t)(x * 0.5);   // [0, 2)
+    if (x >= 1.0) { x -= 1.0; sign = -sign; }
+    if (x > 0.5) x = 1.0 - x;                // [0, 0.5]
+    const double pi = 3.14159265358979323846;
+    int use_cos = (x > 0.25);
+    double y = pi * (use_cos ? 0.5 - x : x);  // |y| <= pi/4
+    double y2 = y * y, term, sum;
+    if (use_cos) {
+        term = 1.0; sum = 1.0;
+        for (int n = 1; n <= 9; n++) { term *= -y2 / (double)((2*n - 1) * (2*n)); sum += term; }
+    } else {
+        term = y; sum = y;
+        for (int n = 1; n <= 9; n++) { term *= -y2 / (double)((2*n) * (2*n + 1)); sum += term; }
+    }
+    return sign * sum;
+}
+
+static inline double h2d_cospi(double x) {
+    return h2d_sinpi(x + 0.5);
+}
+
+// exp(x): halve into [-0.5, 0.5], Taylor, square back.
+static inline double h2d_exp(double x) {
+    if (x < -745.0) return 0.0;
+    if (x > 709.0) x = 709.0;
+    int s = 0;
+    while (x < -0.5 || x > 0.5) { x *= 0.5; s++; }
+    double term = 1.0, sum = 1.0;
+    for (int n = 1; n <= 14; n++) { term *= x / (double)n; sum += term; }
+    while (s-- > 0) sum *= sum;
+    return sum;
+}
+
+// sqrt(x), x > 0, by Newton's method (init only; no libm call behind a builtin).
+static inline double h2d_sqrt(double x) {
+    double r = (x > 1.0) ? x : 1.0;
+    for (int n = 0; n < 200; n++) {
+        double next = 0.5 * (r + x / r);
+        if (next >= r) break;
+        r = next;
+    }
+    return r;
+}
+
+// -------------------- FFT --------------------
+// In-place radix-2 FFT of n complex floats (interleaved re, im). tw holds the
+// n/2 twiddles exp(-2 pi i k / n); inverse conjugates them (no 1/n).
+static inline void h2d_fft(float* z, uint32_t n, const float* tw, int inverse) {
+    for (uint32_t i = 1, j = 0; i < n; i++) {
+        uint32_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            float r = z[2*i], m = z[2*i + 1];
+            z[2*i] = z[2*j]; z[2*i + 1] = z[2*j + 1];
+            z[2*j] = r;      z[2*j + 1] = m;
+        }
+    }
+    for (uint32_t len = 2; len <= n; len <<= 1) {
+        uint32_t half = len >> 1, step = n / len;
+        for (uint32_t i = 0; i < n; i += len) {
+            for (uint32_t k = 0; k < half; k++) {
+                float wr = tw[2*k*step];
+                float wi = inverse ? -tw[2*k*step + 1] : tw[2*k*step + 1];
+                float* a = z + 2*(i + k);
+                float* b = a + 2*half;
+                float xr = b[0]*wr - b[1]*wi;
+                float xi = b[0]*wi + b[1]*wr;
+                b[0] = a[0] - xr; b[1] = a[1] - xi;
+                a[0] += xr;       a[1] += xi;
+            }
+        }
+    }
+}
+
+static inline uint32_t h2d_pow2_at_least(uint32_t n) {
+    uint32_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// -------------------- DST-I --------------------
+// y_k = sum_{j=1..n} x_j sin(pi j k / (n+1)), k = 1..n; applying it twice
+// gives (n+1)/2 times the input.
+typedef struct {
+    uint32_t     n;
+    uint32_t     m;       // 2(n+1): length of the odd extension
+    uint32_t     l;       // FFT length: m if a power of two, else Bluestein's
+    const float* tw;      // l/2 twiddles
+    const float* chirp;   // m: exp(-i pi k^2 / m); NULL when l == m
+    const float* bhat;    // l: FFT of the conjugate chirp, / l; NULL when l == m
+} h2d_dst;
+
+static inline uint32_t h2d_dst_fft_len(uint32_t n) {
+    uint32_t m = 2 * (n + 1);
+    uint32_t p = h2d_pow2_at_least(m);
+    return (p == m) ? m : h2d_pow2_at_least(2 * m - 1);
+}
+
+// Floats h2d_dst_init carves out of its tables.
+static inline uint32_t h2d_dst_floats(uint32_t n) {
+    uint32_t m = 2 * (n + 1), l = h2d_dst_fft_len(n);
+    return l + ((l == m) ? 0 : 2 * m + 2 * l);
+}
+
+// Fill the tables (h2d_dst_floats(n) floats); buf is scratch of 2*l floats.
+static inline void h2d_dst_init(h2d_dst* d, uint32_t n, float* tables, float* buf) {
+    d->n = n;
+    d->m = 2 * (n + 1);
+    d->l = h2d_dst_fft_len(n);
+    float* tw = tables;
+    for (uint32_t k = 0; k < d->l / 2; k++) {
+        tw[2*k]     = (float)h2d_cospi(2.0 * k / d->l);
+        tw[2*k + 1] = (float)-h2d_sinpi(2.0 * k / d->l);
+    }
+    d->tw = tw;
+    d->chirp = 0;
+    d->bhat = 0;
+    if (d->l == d->m) return;
+
+    float* chirp = tables + d->l;
+    float* bhat = chirp + 2 * d->m;
+    for (uint32_t k = 0; k < d->m; k++) {
+        uint64_t k2 = ((uint64_t)k * k) % (2 * d->m);   // exact angle, however large k gets
+        chirp[2*k]     = (float)h2d_cospi((double)k2 / d->m);
+        chirp[2*k + 1] = (float)-h2d_sinpi((double)k2 / d->m);
+    }
+    for (uint32_t i = 0; i < 2 * d->l; i++) buf[i] = 0.0f;
+    for (uint32_t k = 0; k < d->m; k++) {
+        buf[2*k] = chirp[2*k];
+        buf[2*k + 1] = -chirp[2*k + 1];
+        if (k > 0) {
+            buf[2*(d->l - k)] = chirp[2*k];
+            buf[2*(d->l - k) + 1] = -chirp[2*k + 1];
+        }
+    }
+    h2d_fft(buf, d->l, tw, 0);
+    for (uint32_t i = 0; i < 2 * d->l; i++) bhat[i] = buf[i] / (float)d->l;
+    d->chirp = chirp;
+    d->bhat = bhat;
+}
+
+// DST-I of two real sequences in place: a[j*stride] and b[j*stride], j = 0..n-1
+// (b may be NULL). buf holds 2*l floats.
+static inline void h2d_dst_pair(const h2d_dst* d, float* a, float* b, uint32_t stride, float* buf) {
+    const uint32_t n = d->n, m = d->m, l = d->l;
+    for (uint32_t i = 0; i < 2 * l; i++) buf[i] = 0.0f;
+    for (uint32_t j = 1; j <= n; j++) {
+        float re = a[(j - 1) * stride];
+        float im = b ? b[(j - 1) * stride] : 0.0f;
+        buf[2*j] = re;
+        buf[2*j + 1] = im;
+        buf[2*(m - j)] = -re;
+        buf[2*(m - j) + 1] = -im;
+    }
+
+    if (!d->chirp) {
+        h2d_fft(buf, l, d->tw, 0);
+    } else {
+        // Bluestein: X_k = w_k * sum_j (z_j w_j) conj(w_{k-j})
+        for (uint32_t k = 0; k < m; k++) {
+            float zr = buf[2*k], zi = buf[2*k + 1];
+            float wr = d->chirp[2*k], wi = d->chirp[2*k + 1];
+            buf[2*k]     = zr*wr - zi*wi;
+            buf[2*k + 1] = zr*wi + zi*wr;
+        }
+        h2d_fft(buf, l, d->tw, 0);
+        for (uint32_t k = 0; k < l; k++) {
+            float zr = buf[2*k], zi = buf[2*k + 1];
+            float br = d->bhat[2*k], bi = d->bhat[2*k + 1];
+            buf[2*k]     = zr*br - zi*bi;
+            buf[2*k + 1] = zr*bi + zi*br;
+        }
+        h2d_fft(buf, l, d->tw, 1);
+        for (uint32_t k = 1; k <= n; k++) {
+            float zr = buf[2*k], zi = buf[2*k + 1];
+            float wr = d->chirp[2*k], wi = d->chirp[2*k + 1];
+            buf[2*k]     = zr*wr - zi*wi;
+            buf[2*k + 1] = zr*wi + zi*wr;
+        }
+    }
+
+    // DFT of an odd real sequence is -2i times its DST: a in -Im/2, b in Re/2
+    for (uint32_t k = 1; k <= n; k++) {
+        a[(k - 1) * stride] = -0.5f * buf[2*k + 1];
+        if (b) b[(k - 1) * stride] = 0.5f * buf[2*k];
+    }
+}
+
+// -------------------- Plate solver --------------------
+typedef struct {
+    const h2d_plate* p;
+    uint32_t     nx, ny;       // interior cells: w-2, h-2
+    h2d_dst      dx, dy;
+    const float* lx;           // nx: alpha * 4 sin^2(pi p / 2(nx+1)) + cooling/2
+    const float* ly;           // ny: the same along y
+    const float* steady;       // nx*ny: DST of the steady state, [q-1][p-1]
+    float        scale;        // 4 / ((nx+1)(ny+1)): the inverse's normalisation
+} h2d_spec;
+
+// Cells the plate stamps its disk on (h2d_plate_stamp_disk_rect), column by column.
+static inline uint32_t h2d_spec_source_cells(const h2d_plate* p, int32_t* xs, int32_t* ys) {
+    const int r = p->src_r;
+    uint32_t m = 0;
+    for (int dx = -r; dx <= r; dx++) {
+        int x = p->src_x + dx;
+        if (x <= 0 || x >= (int)p->w - 1) continue;
+        for (int dy = -r; dy <= r; dy++) {
+            int y = p->src_y + dy;
+            if (y <= 0 || y >= (int)p->h - 1) continue;
+            if (dx*dx + dy*dy > r*r) continue;
+            if (xs) { xs[m] = x; ys[m] = y; }
+            m++;
+        }
+    }
+    return m;
+}
+
+// Workspace h2d_spec_init needs for p, 8-byte aligned. Most of it (the
+// capacitance matrix, source count squared doubles) is only used by the init.
+static inline uint32_t h2d_spec_bytes(const h2d_plate* p) {
+    uint32_t nx = p->w - 2, ny = p->h - 2;
+    uint32_t m = h2d_spec_source_cells(p, 0, 0);
+    uint32_t doubles = 2 * (nx + 1) + 2 * (ny + 1) + m * m + m + 2 * ny;
+    uint32_t floats = h2d_dst_floats(nx) + h2d_dst_floats(ny) + nx + ny + nx * ny
+                    + H2D_SPEC_BUF_FLOATS(p->w, p->h) + 2 * m;   // + init buffer, cell lists
+    return doubles * (uint32_t)sizeof(double) + floats * (uint32_t)sizeof(float);
+}
+
+// Build the transforms, the decay rates and the steady state for p. The source
+// forcing q solves G q = src_temp on the disk cells, G the steady response of
+// each disk cell to a unit forcing at each other: summed over the sine modes a
+// pair of disk columns at a time, then Cholesky.
+static inline void h2d_spec_init(h2d_spec* s, const h2d_plate* p, void* work) {
+    const uint32_t nx = p->w - 2, ny = p->h - 2;
+    const uint32_t m = h2d_spec_source_cells(p, 0, 0);
+    s->p = p;
+    s->nx = nx;
+    s->ny = ny;
+    s->scale = 4.0f / (float)((nx + 1) * (ny + 1));
+
+    double* dp = (double*)work;
+    double* sinx = dp; dp += 2 * (nx + 1);     // sin(pi k / (nx+1)), k < 2(nx+1)
+    double* siny = dp; dp += 2 * (ny + 1);
+    double* G    = dp; dp += m * m;
+    double* qv   = dp; dp += m;
+    double* H    = dp; dp += ny;
+    double* C    = dp; dp += ny;
+    float* fp = (float*)dp;
+    float* tx = fp; fp += h2d_dst_floats(nx);
+    float* ty = fp; fp += h2d_dst_floats(ny);
+    float* lx = fp; fp += nx;
+    float* ly = fp; fp += ny;
+    float* st = fp; fp += nx * ny;
+    float* buf = fp; fp += H2D_SPEC_BUF_FLOATS(p->w, p->h);
+    int32_t* xs = (int32_t*)fp;
+    int32_t* ys = xs + m;
+
+    h2d_dst_init(&s->dx, nx, tx, buf);
+    h2d_dst_init(&s->dy, ny, ty, buf);
+    for (uint32_t k = 0; k < 2 * (nx + 1); k++) sinx[k] = h2d_sinpi((double)k / (nx + 1));
+    for (uint32_t k = 0; k < 2 * (ny + 1); k++) siny[k] = h2d_sinpi((double)k / (ny + 1));
+    for (uint32_t k = 1; k <= nx; k++) {
+        double sn = h2d_sinpi(0.5 * k / (nx + 1));
+        lx[k - 1] = (float)(p->alpha * 4.0 * sn * sn + 0.5 * p->cooling);
+    }
+    for (uint32_t k = 1; k <= ny; k++) {
+        double sn = h2d_sinpi(0.5 * k / (ny + 1));
+        ly[k - 1] = (float)(p->alpha * 4.0 * sn * sn + 0.5 * p->cooling);
+    }
+    s->lx = lx;
+    s->ly = ly;
+    s->steady = st;
+    for (uint32_t i = 0; i < nx * ny; i++) st[i] = 0.0f;
+    if (m == 0) return;
+
+    h2d_spec_source_cells(p, xs, ys);
+    const uint32_t px = 2 * (nx + 1), py = 2 * (ny + 1);
+    const double scale = s->scale;
+
+    // G over pairs of disk columns [a0, a1) x [b0, b1) (cells are column-major)
+    for (uint32_t a0 = 0, a1; a0 < m; a0 = a1) {
+        for (a1 = a0; a1 < m && xs[a1] == xs[a0]; a1++) {}
+        for (uint32_t b0 = a0, b1; b0 < m; b0 = b1) {
+            for (b1 = b0; b1 < m && xs[b1] == xs[b0]; b1++) {}
+            const uint32_t xa = (uint32_t)xs[a0], xb = (uint32_t)xs[b0];
+            for (uint32_t q = 1; q <= ny; q++) {
+                double h = 0.0;
+                for (uint32_t k = 1; k <= nx; k++) {
+                    h += sinx[(k * xa) % px] * sinx[(k * xb) % px] / ((double)lx[k - 1] + ly[q - 1]);
+                }
+                H[q - 1] = h;
+            }
+            for (uint32_t a = a0; a < a1; a++) {
+                for (uint32_t b = b0; b < b1; b++) {
+                    double g = 0.0;
+                    for (uint32_t q = 1; q <= ny; q++) {
+                        g += siny[(q * (uint32_t)ys[a]) % py] * siny[(q * (uint32_t)ys[b]) % py] * H[q - 1];
+                    }
+                    G[a * m + b] = G[b * m + a] = scale * g;
+                }
+            }
+        }
+    }
+
+    // Cholesky, lower triangle in place; then G q = src_temp
+    for (uint32_t j = 0; j < m; j++) {
+        double d = G[j * m + j];
+        for (uint32_t k = 0; k < j; k++) d -= G[j * m + k] * G[j * m + k];
+        d = (d > 0.0) ? h2d_sqrt(d) : 1e-30;
+        G[j * m + j] = d;
+        for (uint32_t i = j + 1; i < m; i++) {
+            double v = G[i * m + j];
+            for (uint32_t k = 0; k < j; k++) v -= G[i * m + k] * G[j * m + k];
+            G[i * m + j] = v / d;
+        }
+    }
+    for (uint32_t i = 0; i < m; i++) {
+        double v = p->src_temp;
+        for (uint32_t k = 0; k < i; k++) v -= G[i * m + k] * qv[k];
+        qv[i] = v / G[i * m + i];
+    }
+    for (uint32_t i = m; i-- > 0; ) {
+        double v = qv[i];
+        for (uint32_t k = i + 1; k < m; k++) v -= G[k * m + i] * qv[k];
+        qv[i] = v / G[i * m + i];
+    }
+
+    // steady[q][p] = sum over disk cells of q_a phi_pq(a) / lambda_pq, a column at a time
+    for (uint32_t a0 = 0, a1; a0 < m; a0 = a1) {
+        for (a1 = a0; a1 < m && xs[a1] == xs[a0]; a1++) {}
+        for (uint32_t q = 1; q <= ny; q++) {
+            double c = 0.0;
+            for (uint32_t a = a0; a < a1; a++) c += qv[a] * siny[(q * (uint32_t)ys[a]) % py];
+            C[q - 1] = c;
+        }
+        const uint32_t xa = (uint32_t)xs[a0];
+        for (uint32_t q = 1; q <= ny; q++) {
+            float* row = st + (q - 1) * nx;
+            for (uint32_t k = 1; k <= nx; k++) {
+                row[k - 1] += (float)(sinx[(k * xa) % px] * C[q - 1] / ((double)lx[k - 1] + ly[q - 1]));
+            }
+        }
+    }
+}
+
+// Band bounds rounded to the row (column) pairs that share a complex DFT, so
+// any split into bands gives the same bits: pairs start at odd indices.
+static inline uint32_t h2d_spec_pair_start(uint32_t v, uint32_t n) {
+    v = (v <= 1) ? 1 : v + ((v - 1) & 1);
+    return (v > n + 1) ? n + 1 : v;
+}
+
+// DST along x of interior rows [y0, y1) of the field, in place (coefficients
+// land where the cells were; the edges stay 0).
+static inline void h2d_spec_rows(const h2d_spec* s, float* t, uint32_t y0, uint32_t y1, float* buf) {
+    const uint32_t w = s->p->w;
+    uint32_t j0 = h2d_spec_pair_start(y0, s->ny);
+    uint32_t j1 = h2d_spec_pair_start(y1, s->ny);
+    for (uint32_t j = j0; j < j1; j += 2) {
+        float* a = t + j * w + 1;
+        h2d_dst_pair(&s->dx, a, (j + 1 < j1) ? a + w : 0, 1, buf);
+    }
+}
+
+// DST along y of interior columns [x0, x1), in place.
+static inline void h2d_spec_cols(const h2d_spec* s, float* t, uint32_t x0, uint32_t x1, float* buf) {
+    const uint32_t w = s->p->w;
+    uint32_t i0 = h2d_spec_pair_start(x0, s->nx);
+    uint32_t i1 = h2d_spec_pair_start(x1, s->nx);
+    for (uint32_t i = i0; i < i1; i += 2) {
+        float* a = t + w + i;
+        h2d_dst_pair(&s->dy, a, (i + 1 < i1) ? a + 1 : 0, w, buf);
+    }
+}
+
+// Advance the coefficients of rows [y0, y1) by dt explicit steps of time and
+// fold in the inverse's normalisation. buf holds nx floats.
+static inline void h2d_spec_decay(const h2d_spec* s, float* t, float dt,
+                                  uint32_t y0, uint32_t y1, float* buf) {
+    const uint32_t w = s->p->w, nx = s->nx;
+    uint32_t j0 = h2d_spec_pair_start(y0, s->ny);
+    uint32_t j1 = h2d_spec_pair_start(y1, s->ny);
+    for (uint32_t k = 0; k < nx; k++) buf[k] = (float)h2d_exp(-(double)s->lx[k] * dt);
+    for (uint32_t j = j0; j < j1; j++) {
+        float ey = (float)h2d_exp(-(double)s->ly[j - 1] * dt);
+        float* row = t + j * w + 1;
+        const float* st = s->steady + (j - 1) * nx;
+        for (uint32_t k = 0; k < nx; k++) {
+            float e = buf[k] * ey;
+            row[k] = s->scale * (st[k] + e * (row[k] - st[k]));
+        }
+    }
+}
+
+// Clamp rows [y0, y1) to [0, 1], zero their edges and stamp the disk, as a
+// plate step ends (the transforms never touch the edges).
+static inline void h2d_spec_finish(const h2d_spec* s, float* t, uint32_t y0, uint32_t y1) {
+    const h2d_plate* p = s->p;
+    for (uint32_t y = y0; y < y1; y++) {
+        float* row = t + y * p->w;
+        if (y == 0 || y == p->h - 1) {
+            for (uint32_t x = 0; x < p->w; x++) row[x] = 0.f;
+            continue;
+        }
+        for (uint32_t x = 1; x < p->w - 1; x++) row[x] = h2d_clamp01(row[x]);
+        row[0] = 0.f;
+        row[p->w - 1] = 0.f;
+    }
+    h2d_plate_stamp_disk(p, t, 0, y0, y1, p->src_x, p->src_y, p->src_r, p->src_temp);
+}
+
+// Advance the plate field t (edges 0) by dt explicit steps of time, in place.
+// buf: H2D_SPEC_BUF_FLOATS(w, h) floats.
+static inline void h2d_spec_advance(const h2d_spec* s, float* t, float dt, float* buf) {
+    const uint32_t w = s->p->w, h = s->p->h;
+    h2d_spec_rows(s, t, 0, h, buf);
+    h2d_spec_cols(s, t, 0, w, buf);
+    h2d_spec_decay(s, t, dt, 0, h, buf);
+    h2d_spec_rows(s, t, 0, h, buf);
+    h2d_spec_cols(s, t, 0, w, buf);
+    h2d_spec_finish(s, t, 0, h);
+}
+
+#endif // HEAT2D_SPECTRAL_H
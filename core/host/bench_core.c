@@ -0,0 +1,494 @@
+// bench_core.c - native throughput of the Heat2D core (make -C core bench)
+//
+// Same BENCH lines as the bare-metal kernels (see bench/bench.h), timed with
+// CLOCK_MONOTONIC, so host and QEMU/Pi numbers can be compared side by side.
+//
+//   ./heat2d_bench [nx ny]   grid size for both solvers (default: each demo's own)
+//
+// Single-threaded on purpose: it measures the kernels, not the SMP split. Run it
+// under `perf record` / `perf stat` for per-instruction profiles.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../heat2d_plate.h"
+#include "../heat2d_conduct.h"
+#include "../heat2d_render.h"
+#include "../heat2d_active.h"
+#include "../heat2d_multigrid.h"
+#include "../heat2d_adi.h"
+#include "../heat2d_spectral.h"
+#include "../heat2d_half.h"
+#include "../heat2d_display.h"
+#include "../../bench/bench.h"
+
+#ifndef BENCH_WARMUP
+#define BENCH_WARMUP 10
+#endif
+#ifndef BENCH_ITERS
+#define BENCH_ITERS 200
+#endif
+
+#define TB_TILE_ROWS 32
+#define TB_STEPS     4
+#define ACTIVE_TILE  16
+#define ACTIVE_TOL   1e-5f
+#define ACTIVE_QUIET 32
+#define ACTIVE_SETTLE 2000   // steps before the active-tile cases, so air can go quiet
+#define STEADY_ITERS  20     // whole solves are slow next to a step
+#define STEADY_RTOL   1e-6f
+#define ADI_STEPS     30     // explicit steps of time per ADI step
+#define SPECTRAL_JUMP 1000   // explicit steps of time per spectral jump
+#define FP16_DRIFT_STEPS 4000   // steps from the demo starts before fp16_drift compares
+
+static void put(const char* s) { fputs(s, stdout); }
+
+static void* xcalloc(size_t n, size_t size) {
+    void* p = calloc(n, size);
+    if (!p) { fprintf(stderr, "out of memory\n"); exit(2); }
+    return p;
+}
+
+// -------------------- plate (metal solver) --------------------
+typedef struct {
+    h2d_plate p;
+    float*    a;
+    float*    b;
+    float*    scratch[2];
+    uint32_t  k;
+    h2d_display* disp;   // set: the step also writes the display plane
+} plate_ctx;
+
+static void bench_plate_step(void* ctx) {
+    plate_ctx* c = (plate_ctx*)ctx;
+    h2d_plate_advance_q(&c->p, c->a, c->b, c->scratch[0], c->scratch[1], TB_TILE_ROWS,
+                        0, c->p.h, c->k, c->disp);
+    float* t = c->a; c->a = c->b; c->b = t;
+}
+
+// -------------------- conduct (uefi solver) --------------------
+typedef struct {
+    h2d_conduct      c;
+    h2d_rect_sources src;
+    float*           a;
+    float*           b;
+    float*           scratch[2];
+    uint32_t         k;
+} conduct_ctx;
+
+static void bench_conduct_step(void* ctx) {
+    conduct_ctx* c = (conduct_ctx*)ctx;
+    h2d_stamp_sources_rows(&c->src, c->a, 0, c->c.nx, c->c.ny, 0, c->c.ny);
+    h2d_step_conduction(&c->c, c->a, c->b, c->scratch[0], c->scratch[1], TB_TILE_ROWS, c->k);
+    float* t = c->a; c->a = c->b; c->b = t;
+}
+
+// -------------------- active tiles --------------------
+typedef struct {
+    h2d_active a;
+    void*      solver;   // plate_ctx or conduct_ctx
+    uint32_t   awake;
+} active_ctx;
+
+static void active_alloc(active_ctx* x, uint32_t nx, uint32_t ny, void* solver) {
+    size_t n = (size_t)h2d_active_tiles(nx, ACTIVE_TILE) * h2d_active_tiles(ny, ACTIVE_TILE);
+    h2d_active_init(&x->a, nx, ny, ACTIVE_TILE, ACTIVE_TOL, ACTIVE_QUIET,
+                    (float*)xcalloc(n, sizeof(float)), (uint8_t*)xcalloc(n, 1),
+                    (uint8_t*)xcalloc(n, 1));
+    x->solver = solver;
+}
+
+static void active_release(active_ctx* x) {
+    free(x->a.delta); free(x->a.quiet); free(x->a.changed);
+}
+
+static void bench_plate_step_active(void* ctx) {
+    active_ctx* x = (active_ctx*)ctx;
+    plate_ctx* c = (plate_ctx*)x->solver;
+    h2d_plate_active_advance_q(&c->p, &x->a, c->a, c->b, c->scratch[0], c->scratch[1], TB_TILE_ROWS,
+                               0, x->a.th, c->k, 0);
+    x->awake = h2d_active_update(&x->a, c->b, c->a);
+    float* t = c->a; c->a = c->b; c->b = t;
+}
+
+static void bench_conduct_step_active(void* ctx) {
+    active_ctx* x = (active_ctx*)ctx;
+    conduct_ctx* c = (conduct_ctx*)x->solver;
+    h2d_stamp_sources_rows(&c->src, c->a, 0, c->c.nx, c->c.ny, 0, c->c.ny);
+    h2d_conduct_active_advance_q(&c->c, &x->a, c->a, c->b, c->scratch[0], c->scratch[1], TB_TILE_ROWS,
+                                 0, x->a.th, c->k, 0);
+    x->awake = h2d_active_update(&x->a, c->b, c->a);
+    float* t = c->a; c->a = c->b; c->b = t;
+}
+
+// -------------------- steady state --------------------
+typedef struct {
+    h2d_mg   mg;
+    float*   t;
+    uint32_t iters;
+} steady_ctx;
+
+static void bench_conduct_steady(void* ctx) {
+    steady_ctx* x = (steady_ctx*)ctx;
+    memset(x->t, 0, sizeof(float) * (size_t)x->mg.c->nx * x->mg.c->ny);
+    x->iters = h2d_mg_solve(&x->mg, x->t, 200, STEADY_RTOL);
+}
+
+// -------------------- adi --------------------
+typedef struct {
+    h2d_adi      d;
+    conduct_ctx* c;
+    float*       scratch;
+} adi_ctx;
+
+static void bench_conduct_step_adi(void* ctx) {
+    adi_ctx* x = (adi_ctx*)ctx;
+    conduct_ctx* c = x->c;
+    h2d_stamp_sources_rows(&c->src, c->a, 0, c->c.nx, c->c.ny, 0, c->c.ny);
+    h2d_adi_step(&x->d, c->a, c->b, x->scratch);
+    float* t = c->a; c->a = c->b; c->b = t;
+}
+
+// -------------------- spectral --------------------
+typedef struct {
+    h2d_spec s;
+    float*   t;
+    float*   buf;
+} spectral_ctx;
+
+static void bench_plate_jump(void* ctx) {
+    spectral_ctx* x = (spectral_ctx*)ctx;
+    h2d_spec_advance(&x->s, x->t, SPECTRAL_JUMP, x->buf);
+}
+
+// -------------------- fp16 storage --------------------
+typedef struct {
+    plate_ctx*   plate;     // parameters only
+    conduct_ctx* conduct;
+    h2d_half*    a;
+    h2d_half*    b;
+    h2d_half*    scratch[2];
+    uint32_t     k;
+    uint32_t     step;      // dither step number
+    h2d_display* disp;      // set: the plate step also writes the display plane
+} half_ctx;
+
+static void bench_plate_step_half(void* ctx) {
+    half_ctx* x = (half_ctx*)ctx;
+    h2d_plate_advance_hq(&x->plate->p, x->a, x->b, x->scratch[0], x->scratch[1], TB_TILE_ROWS,
+                         0, x->plate->p.h, x->k, x->step, x->disp);
+    x->step += x->k;
+    h2d_half* t = x->a; x->a = x->b; x->b = t;
+}
+
+static void bench_conduct_step_half(void* ctx) {
+    half_ctx* x = (half_ctx*)ctx;
+    const h2d_conduct* c = &x->conduct->c;
+    h2d_stamp_sources_rows_h(&x->conduct->src, x->a, 0, c->nx, c->ny, 0, c->ny);
+    h2d_conduct_advance_h(c, x->a, x->b, x->scratch[0], x->scratch[1], TB_TILE_ROWS,
+                          0, c->ny, x->k, x->step);
+    x->step += x->k;
+    h2d_half* t = x->a; x->a = x->b; x->b = t;
+}
+
+static void half_alloc(half_ctx* x, size_t cells, uint32_t row) {
+    x->a = (h2d_half*)xcalloc(cells, sizeof(h2d_half));
+    x->b = (h2d_half*)xcalloc(cells, sizeof(h2d_half));
+    x->scratch[0] = (h2d_half*)xcalloc((size_t)(TB_TILE_ROWS + 2 * (TB_STEPS - 1)) * row, sizeof(h2d_half));
+    x->scratch[1] = (h2d_half*)xcalloc((size_t)(TB_TILE_ROWS + 2 * (TB_STEPS - 1)) * row, sizeof(h2d_half));
+    x->step = 0;
+    x->disp = 0;
+}
+
+static void half_release(half_ctx* x) {
+    free(x->a); free(x->b); free(x->scratch[0]); free(x->scratch[1]);
+}
+
+// Largest |fp32 - fp16| over n cells.
+static float half_drift(const float* f, const h2d_half* h, size_t n) {
+    float d = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        float e = f[i] - h2d_half_to_float(h[i]);
+        if (e < 0.0f) e = -e;
+        if (e > d) d = e;
+    }
+    return d;
+}
+
+// -------------------- render --------------------
+typedef struct {
+    plate_ctx*  plate;
+    uint32_t    lut[256];
+    uint8_t*    drawn;
+    h2d_surface surface;
+    h2d_rect*   rects;
+    h2d_display disp;
+} render_ctx;
+
+static void bench_render_full(void* ctx) {
+    render_ctx* r = (render_ctx*)ctx;
+    h2d_render_cells(r->plate->a, r->plate->p.w, r->plate->p.h, r->lut, r->drawn, 1,
+                     &r->surface, 10, r->rects);
+}
+
+static void bench_step_render(void* ctx) {
+    render_ctx* r = (render_ctx*)ctx;
+    bench_plate_step(r->plate);
+    h2d_render_cells(r->plate->a, r->plate->p.w, r->plate->p.h, r->lut, r->drawn, 0,
+                     &r->surface, 10, r->rects);
+}
+
+// The same frames from the display plane: the step fills it as it stores, so
+// the render reads one byte per cell and skips rows that did not change.
+static void bench_render_display_full(void* ctx) {
+    render_ctx* r = (render_ctx*)ctx;
+    h2d_render_display_rows(&r->disp, r->lut, r->drawn, 1, &r->surface, 10, r->rects, 0, r->plate->p.h);
+}
+
+static void bench_step_render_display(void* ctx) {
+    render_ctx* r = (render_ctx*)ctx;
+    bench_plate_step(r->plate);
+    h2d_render_display_rows(&r->disp, r->lut, r->drawn, 0, &r->surface, 10, r->rects, 0, r->plate->p.h);
+}
+
+static void bench_build_lut(void* ctx) {
+    static const h2d_color_stop stops[] = {
+        {0.00f,  20,  24,  82},
+        {0.35f,  30, 120, 200},
+        {0.65f, 255, 180,  60},
+        {1.00f, 255, 255, 245},
+    };
+    h2d_build_palette_lut(stops, 4, (h2d_rgb8*)ctx);
+}
+
+int main(int argc, char** argv) {
+    uint32_t pw = 200, ph = 150;   // metal/Heat2D_ramfb.cpp
+    int32_t  cw = 260, ch = 220;   // uefi/Heat2D.c
+    if (argc == 3) {
+        pw = (uint32_t)atoi(argv[1]);
+        ph = (uint32_t)atoi(argv[2]);
+        cw = (int32_t)pw;
+        ch = (int32_t)ph;
+        if (pw < 8 || ph < 8) { fprintf(stderr, "grid must be at least 8x8\n"); return 2; }
+    } else if (argc != 1) {
+        fprintf(stderr, "usage: %s [nx ny]\n", argv[0]);
+        return 2;
+    }
+
+    // plate: same parameters as the metal demo, warm start
+    plate_ctx pc;
+    pc.p.w = pw; pc.p.h = ph;
+    pc.p.alpha = 0.20f; pc.p.cooling = 0.0008f;
+    pc.p.src_x = (int)pw / 2; pc.p.src_y = (int)ph / 2; pc.p.src_r = 7; pc.p.src_temp = 1.0f;
+    pc.disp = 0;
+    pc.a = (float*)xcalloc((size_t)pw * ph, sizeof(float));
+    pc.b = (float*)xcalloc((size_t)pw * ph, sizeof(float));
+    for (size_t i = 0; i < (size_t)pw * ph; i++) pc.a[i] = 0.02f;
+    pc.scratch[0] = (float*)xcalloc((size_t)(TB_TILE_ROWS + 2 * (TB_STEPS - 1)) * pw, sizeof(float));
+    pc.scratch[1] = (float*)xcalloc((size_t)(TB_TILE_ROWS + 2 * (TB_STEPS - 1)) * pw, sizeof(float));
+
+    // conduct: the heatsink scene as UefiMain builds it
+    conduct_ctx cc;
+    size_t cn = (size_t)cw * ch;
+    uint8_t* mat = (uint8_t*)xcalloc(cn, 1);
+    float kface[H2D_HEATSINK_MAT_COUNT * H2D_HEATSINK_MAT_COUNT];
+    h2d_heatsink_geom g;
+    h2d_build_heatsink(mat, cw, ch, &g);
+    h2d_face_table(h2d_heatsink_k, H2D_HEATSINK_MAT_COUNT, kface);
+    h2d_heatsink_sources(&g, 1.0f, &cc.src);
+    cc.c.nx = cw; cc.c.ny = ch;
+    cc.c.mat = mat; cc.c.kface = kface; cc.c.nmat = H2D_HEATSINK_MAT_COUNT;
+    cc.c.base_r = 0.20f;
+    cc.c.bc = H2D_BC_DIRICHLET_COLD;
+    cc.c.src = &cc.src;
+    cc.a = (float*)xcalloc(cn, sizeof(float));
+    cc.b = (float*)xcalloc(cn, sizeof(float));
+    cc.scratch[0] = (float*)xcalloc((size_t)(TB_TILE_ROWS + 2 * (TB_STEPS - 1)) * cw, sizeof(float));
+    cc.scratch[1] = (float*)xcalloc((size_t)(TB_TILE_ROWS + 2 * (TB_STEPS - 1)) * cw, sizeof(float));
+
+    // render: 4x4 pixel blocks, as the metal ramfb renderer
+    render_ctx rc;
+    rc.plate = &pc;
+    for (uint32_t i = 0; i < 256; i++) rc.lut[i] = i * 0x010101u;
+    rc.drawn = (uint8_t*)xcalloc((size_t)pw * ph, 1);
+    rc.surface.pitch = pw * 4;
+    rc.surface.sx = 4;
+    rc.surface.sy = 4;
+    rc.surface.px = (uint32_t*)xcalloc((size_t)rc.surface.pitch * ph * 4, sizeof(uint32_t));
+    rc.rects = (h2d_rect*)xcalloc((ph + 9) / 10, sizeof(h2d_rect));
+    uint8_t* disp_idx  = (uint8_t*)xcalloc((size_t)pw * ph, 1);
+    uint8_t* disp_rows = (uint8_t*)xcalloc(ph, 1);
+    h2d_display_init(&rc.disp, pw, ph, 0.0f, disp_idx, disp_rows);
+
+    h2d_rgb8 lut8[256];
+    const uint64_t pcells = (uint64_t)pw * ph;
+
+    printf("BENCHCFG host plate=%ux%u conduct=%dx%d tb_steps=%u\n", pw, ph, cw, ch, TB_STEPS);
+    fflush(stdout);
+
+    bench_case c1 = { "build_lut", bench_build_lut, lut8, BENCH_WARMUP, BENCH_ITERS, 256, "entries/s" };
+    bench_run(&c1, put);
+
+    pc.k = 1;
+    bench_case c2 = { "plate_step", bench_plate_step, &pc, BENCH_WARMUP, BENCH_ITERS, pcells, "cells/s" };
+    bench_run(&c2, put);
+    pc.k = TB_STEPS;
+    bench_case c3 = { "plate_step_tb", bench_plate_step, &pc, BENCH_WARMUP, BENCH_ITERS,
+                      pcells * TB_STEPS, "cells/s" };
+    bench_run(&c3, put);
+
+    cc.k = 1;
+    bench_case c4 = { "conduct_step", bench_conduct_step, &cc, BENCH_WARMUP, BENCH_ITERS, cn, "cells/s" };
+    bench_run(&c4, put);
+    cc.k = TB_STEPS;
+    bench_case c5 = { "conduct_step_tb", bench_conduct_step, &cc, BENCH_WARMUP, BENCH_ITERS,
+                      cn * TB_STEPS, "cells/s" };
+    bench_run(&c5, put);
+
+    // active tiles: cells/s counts the whole grid, so the speedup over
+    // plate_step/conduct_step is the fraction of tiles asleep
+    active_ctx pa, ca;
+    pc.k = 1;
+    cc.k = 1;
+    active_alloc(&pa, pw, ph, &pc);
+    active_alloc(&ca, (uint32_t)cw, (uint32_t)ch, &cc);
+    for (uint32_t s = 0; s < ACTIVE_SETTLE; s++) {
+        bench_plate_step_active(&pa);
+        bench_conduct_step_active(&ca);
+    }
+    bench_case c8 = { "plate_step_active", bench_plate_step_active, &pa, BENCH_WARMUP, BENCH_ITERS,
+                      pcells, "cells/s" };
+    bench_run(&c8, put);
+    bench_case c9 = { "conduct_step_active", bench_conduct_step_active, &ca, BENCH_WARMUP,
+                      BENCH_ITERS, cn, "cells/s" };
+    bench_run(&c9, put);
+    printf("BENCHCFG active plate_awake=%u/%u conduct_awake=%u/%u\n",
+           pa.awake, pa.a.tw * pa.a.th, ca.awake, ca.a.tw * ca.a.th);
+    fflush(stdout);
+    // the same settled fields in rounds of TB_STEPS blocked steps
+    pc.k = TB_STEPS;
+    cc.k = TB_STEPS;
+    bench_case c8b = { "plate_step_active_tb", bench_plate_step_active, &pa, BENCH_WARMUP, BENCH_ITERS,
+                       pcells * TB_STEPS, "cells/s" };
+    bench_run(&c8b, put);
+    bench_case c9b = { "conduct_step_active_tb", bench_conduct_step_active, &ca, BENCH_WARMUP,
+                       BENCH_ITERS, cn * TB_STEPS, "cells/s" };
+    bench_run(&c9b, put);
+    active_release(&pa);
+    active_release(&ca);
+
+    // steady state from a cold field: cells/s counts the grid once per solve
+    steady_ctx sc;
+    void* mg_work = xcalloc(h2d_mg_bytes(cw, ch), 1);
+    h2d_mg_init(&sc.mg, &cc.c, mg_work);
+    sc.t = (float*)xcalloc(cn, sizeof(float));
+    bench_case c10 = { "conduct_steady", bench_conduct_steady, &sc, 1, STEADY_ITERS, cn, "cells/s" };
+    bench_run(&c10, put);
+    printf("BENCHCFG steady cg_iters=%u\n", sc.iters);
+    fflush(stdout);
+    free(mg_work); free(sc.t);
+
+    // ADI: cells/s counts ADI_STEPS explicit steps of time per step, so it
+    // compares with conduct_step directly
+    adi_ctx ac;
+    uint8_t* adi_fixed = (uint8_t*)xcalloc(cn, 1);
+    h2d_adi_mark_sources(&cc.src, cw, ch, adi_fixed);
+    ac.d.c = &cc.c; ac.d.steps = ADI_STEPS; ac.d.sink = 0.0f;
+    ac.d.fixed = adi_fixed; ac.d.clamp01 = 0;
+    ac.c = &cc;
+    ac.scratch = (float*)xcalloc(h2d_adi_scratch_floats(cw, ch), sizeof(float));
+    bench_case c11 = { "conduct_step_adi", bench_conduct_step_adi, &ac, BENCH_WARMUP, BENCH_ITERS,
+                       cn * ADI_STEPS, "cells/s" };
+    bench_run(&c11, put);
+    free(adi_fixed); free(ac.scratch);
+
+    // spectral jumps of the plate, counted like ADI; the init (capacitance
+    // matrix for the disk) is outside the timing
+    spectral_ctx xc;
+    void* spec_work = xcalloc(h2d_spec_bytes(&pc.p), 1);
+    h2d_spec_init(&xc.s, &pc.p, spec_work);
+    xc.t = (float*)xcalloc(pcells, sizeof(float));
+    xc.buf = (float*)xcalloc(H2D_SPEC_BUF_FLOATS(pw, ph), sizeof(float));
+    h2d_plate_step_rows(&pc.p, pc.a, 0, xc.t, 0, 0, ph);
+    bench_case c12 = { "plate_jump", bench_plate_jump, &xc, BENCH_WARMUP, BENCH_ITERS,
+                       pcells * SPECTRAL_JUMP, "cells/s" };
+    bench_run(&c12, put);
+    free(spec_work); free(xc.t); free(xc.buf);
+
+    // fp16 storage: the same cases over half fields; then both precisions run
+    // FP16_DRIFT_STEPS from the demo starts (plate warm, heatsink cold) and
+    // BENCHCFG fp16_drift reports how far apart they ended, in display levels
+    half_ctx hp, hc;
+    hp.plate = &pc; hp.conduct = 0;
+    hc.plate = 0;   hc.conduct = &cc;
+    half_alloc(&hp, pcells, pw);
+    half_alloc(&hc, cn, (uint32_t)cw);
+    h2d_half_from_floats(pc.a, hp.a, (uint32_t)pcells);
+    h2d_half_from_floats(cc.a, hc.a, (uint32_t)cn);
+    hp.k = 1;
+    bench_case c13 = { "plate_step_fp16", bench_plate_step_half, &hp, BENCH_WARMUP, BENCH_ITERS,
+                       pcells, "cells/s" };
+    bench_run(&c13, put);
+    hp.k = TB_STEPS;
+    bench_case c14 = { "plate_step_tb_fp16", bench_plate_step_half, &hp, BENCH_WARMUP, BENCH_ITERS,
+                       pcells * TB_STEPS, "cells/s" };
+    bench_run(&c14, put);
+    hc.k = 1;
+    bench_case c15 = { "conduct_step_fp16", bench_conduct_step_half, &hc, BENCH_WARMUP, BENCH_ITERS,
+                       cn, "cells/s" };
+    bench_run(&c15, put);
+    hc.k = TB_STEPS;
+    bench_case c16 = { "conduct_step_tb_fp16", bench_conduct_step_half, &hc, BENCH_WARMUP,
+                       BENCH_ITERS, cn * TB_STEPS, "cells/s" };
+    bench_run(&c16, put);
+
+    pc.k = TB_STEPS; hp.k = TB_STEPS;
+    cc.k = TB_STEPS; hc.k = TB_STEPS;
+    for (size_t i = 0; i < pcells; i++) pc.a[i] = 0.02f;
+    memset(cc.a, 0, cn * sizeof(float));
+    h2d_half_from_floats(pc.a, hp.a, (uint32_t)pcells);
+    h2d_half_from_floats(cc.a, hc.a, (uint32_t)cn);
+    for (uint32_t s = 0; s < FP16_DRIFT_STEPS; s += TB_STEPS) {
+        bench_plate_step(&pc);
+        bench_plate_step_half(&hp);
+        bench_conduct_step(&cc);
+        bench_conduct_step_half(&hc);
+    }
+    printf("BENCHCFG fp16_drift steps=%u plate=%.2f conduct=%.2f levels\n", FP16_DRIFT_STEPS,
+           255.0f * half_drift(pc.a, hp.a, pcells), 255.0f * half_drift(cc.a, hc.a, cn));
+    fflush(stdout);
+
+    // the half step filling the display plane itself, as the demos draw it
+    hp.k = 1;
+    hp.disp = &rc.disp;
+    h2d_display_rows_h(&rc.disp, hp.a, 0, ph);
+    bench_case c17h = { "plate_step_display_fp16", bench_plate_step_half, &hp, BENCH_WARMUP,
+                        BENCH_ITERS, pcells, "cells/s" };
+    bench_run(&c17h, put);
+    half_release(&hp);
+    half_release(&hc);
+
+    pc.k = 1;
+    bench_case c6 = { "render_full", bench_render_full, &rc, BENCH_WARMUP, BENCH_ITERS, pcells, "cells/s" };
+    bench_run(&c6, put);
+    bench_case c7 = { "step_render", bench_step_render, &rc, BENCH_WARMUP, BENCH_ITERS, pcells, "cells/s" };
+    bench_run(&c7, put);
+    pc.disp = &rc.disp;
+    h2d_display_rows(&rc.disp, pc.a, 0, ph);
+    bench_case c17 = { "plate_step_display", bench_plate_step, &pc, BENCH_WARMUP, BENCH_ITERS,
+                       pcells, "cells/s" };
+    bench_run(&c17, put);
+    bench_case c18 = { "render_display_full", bench_render_display_full, &rc, BENCH_WARMUP,
+                       BENCH_ITERS, pcells, "cells/s" };
+    bench_run(&c18, put);
+    bench_case c19 = { "step_render_display", bench_step_render_display, &rc, BENCH_WARMUP,
+                       BENCH_ITERS, pcells, "cells/s" };
+    bench_run(&c19, put);
+
+    free(pc.a); free(pc.b); free(pc.scratch[0]); free(pc.scratch[1]);
+    free(mat);
+    free(cc.a); free(cc.b); free(cc.scratch[0]); free(cc.scratch[1]);
+    free(rc.drawn); free(rc.surface.px); free(rc.rects); free(disp_idx); free(disp_rows);
+    return 0;
+}
@@ -0,0 +1,1481 @@
+// test_core.c - native checks for the Heat2D core (make -C core test)
+//
+// The properties the bare-metal and UEFI front ends rely on but cannot check
+// without a QEMU boot: temporal blocking matches single steps bit-for-bit,
+// banded stepping matches a full sweep, active-tile stepping (single or
+// blocked rounds) matches it while every tile is awake, ADI steps track
+// explicit ones and split across bands bit-for-bit, spectral jumps land where
+// explicit steps go, fp16 storage rounds like the hardware and stays close to
+// fp32, the display plane the stencils (fp32 or half) fill matches the field
+// they store, and the incremental renderer only touches what changed.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../heat2d_plate.h"
+#include "../heat2d_conduct.h"
+#include "../heat2d_render.h"
+#include "../heat2d_active.h"
+#include "../heat2d_multigrid.h"
+#include "../heat2d_adi.h"
+#include "../heat2d_spectral.h"
+#include "../heat2d_half.h"
+#include "../heat2d_display.h"
+
+static int g_failures = 0;
+
+#define CHECK(cond, ...) do {                         \
+    if (!(cond)) {                                    \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__);   \
+        printf(__VA_ARGS__);                          \
+        printf("\n");                                 \
+        g_failures++;                                 \
+    }                                                 \
+} while (0)
+
+static float* alloc_grid(size_t n) {
+    float* p = (float*)calloc(n, sizeof(float));
+    if (!p) { printf("out of memory\n"); exit(2); }
+    return p;
+}
+
+// Deterministic pseudo-random field in [0, 1] so the stencil sees real gradients.
+static void fill_noise(float* t, size_t n, uint32_t seed) {
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        t[i] = (float)(seed >> 8) / (float)(1u << 24);
+    }
+}
+
+// -------------------- plate (metal solver) --------------------
+static const h2d_plate k_plate = { 200, 150, 0.20f, 0.0008f, 100, 75, 7, 1.0f };
+
+static void test_plate_temporal_blocking(void) {
+    const h2d_plate* p = &k_plate;
+    const size_t n = (size_t)p->w * p->h;
+    const uint32_t tile = 32, max_k = 16;
+    float* ref[2] = { alloc_grid(n), alloc_grid(n) };
+    float* a      = alloc_grid(n);
+    float* b      = alloc_grid(n);
+    float* s0     = alloc_grid((size_t)(tile + 2 * (max_k - 1)) * p->w);
+    float* s1     = alloc_grid((size_t)(tile + 2 * (max_k - 1)) * p->w);
+
+    static const uint32_t ks[] = { 2, 3, 5, 8, 16 };
+    static const uint32_t bands[] = { 1, 3, 4 };
+    for (size_t ki = 0; ki < sizeof(ks) / sizeof(ks[0]); ki++) {
+        for (size_t bi = 0; bi < sizeof(bands) / sizeof(bands[0]); bi++) {
+            uint32_t k = ks[ki], nb = bands[bi];
+
+            fill_noise(ref[0], n, 1234u + k);
+            memcpy(a, ref[0], n * sizeof(float));
+            for (uint32_t s = 0; s < k; s++) {
+                h2d_plate_advance(p, ref[s & 1], ref[(s + 1) & 1], 0, 0, tile, 0, p->h, 1);
+            }
+            // bands as the metal SMP split computes them
+            for (uint32_t c = 0; c < nb; c++) {
+                h2d_plate_advance(p, a, b, s0, s1, tile, p->h * c / nb, p->h * (c + 1) / nb, k);
+            }
+            CHECK(memcmp(b, ref[k & 1], n * sizeof(float)) == 0,
+                  "plate: k=%u over %u bands differs from %u single steps", k, nb, k);
+        }
+    }
+
+    free(ref[0]); free(ref[1]); free(a); free(b); free(s0); free(s1);
+}
+
+static void test_plate_source_and_edges(void) {
+    const h2d_plate* p = &k_plate;
+    const size_t n = (size_t)p->w * p->h;
+    float* a = alloc_grid(n);
+    float* b = alloc_grid(n);
+    fill_noise(a, n, 99u);
+
+    h2d_plate_advance(p, a, b, 0, 0, 32, 0, p->h, 1);
+    CHECK(b[p->src_y * p->w + p->src_x] == p->src_temp, "plate: source not stamped");
+    int edges_zero = 1;
+    for (uint32_t x = 0; x < p->w; x++) {
+        if (b[x] != 0.f || b[(p->h - 1) * p->w + x] != 0.f) edges_zero = 0;
+    }
+    for (uint32_t y = 0; y < p->h; y++) {
+        if (b[y * p->w] != 0.f || b[y * p->w + p->w - 1] != 0.f) edges_zero = 0;
+    }
+    CHECK(edges_zero, "plate: edges not held at 0");
+    int in_range = 1;
+    for (size_t i = 0; i < n; i++) {
+        if (!(b[i] >= 0.f && b[i] <= 1.f)) in_range = 0;
+    }
+    CHECK(in_range, "plate: field left [0, 1]");
+
+    free(a); free(b);
+}
+
+// -------------------- conduct (uefi solver) --------------------
+typedef struct {
+    int32_t nx, ny;
+    uint8_t* mat;
+    float kface[H2D_HEATSINK_MAT_COUNT * H2D_HEATSINK_MAT_COUNT];
+    h2d_rect_sources src;
+    h2d_conduct c;
+} heatsink;
+
+static void heatsink_init(heatsink* h, int32_t nx, int32_t ny) {
+    size_t n = (size_t)nx * ny;
+    h->nx = nx; h->ny = ny;
+    h->mat = (uint8_t*)calloc(n, 1);
+
+    h2d_heatsink_geom g;
+    h2d_build_heatsink(h->mat, nx, ny, &g);
+    h2d_face_table(h2d_heatsink_k, H2D_HEATSINK_MAT_COUNT, h->kface);
+    h2d_heatsink_sources(&g, 1.0f, &h->src);
+
+    h->c.nx = nx; h->c.ny = ny;
+    h->c.mat = h->mat;
+    h->c.kface = h->kface;
+    h->c.nmat = H2D_HEATSINK_MAT_COUNT;
+    h->c.base_r = 0.20f;
+    h->c.bc = H2D_BC_DIRICHLET_COLD;
+    h->c.src = &h->src;
+}
+
+static void heatsink_free(heatsink* h) {
+    free(h->mat);
+}
+
+// The per-face float arrays the material table replaced: the right/down face of
+// every cell computed from its two cells' conductivities, stepped the way
+// h2d_conduct_span did before. The table kernel has to match it bit-for-bit.
+static void conduct_faces_reference(const float* k, int32_t nx, int32_t ny, float base_r,
+                                    const float* a, float* b) {
+    float* kx = alloc_grid((size_t)nx * ny);
+    float* ky = alloc_grid((size_t)nx * ny);
+    for (int32_t j = 0; j < ny; j++) {
+        for (int32_t i = 0; i < nx; i++) {
+            int32_t idx = j*nx + i;
+            kx[idx] = (i < nx-1) ? h2d_kface_harmonic(k[idx], k[idx + 1])  : 0.0f;
+            ky[idx] = (j < ny-1) ? h2d_kface_harmonic(k[idx], k[idx + nx]) : 0.0f;
+        }
+    }
+    for (int32_t j = 1; j < ny-1; j++) {
+        for (int32_t i = 1; i < nx-1; i++) {
+            int32_t idx = j*nx + i;
+            float tC = a[idx];
+            float flux_r = kx[idx]      * (a[idx + 1]  - tC);
+            float flux_l = kx[idx - 1]  * (a[idx - 1]  - tC);
+            float flux_d = ky[idx]      * (a[idx + nx] - tC);
+            float flux_u = ky[idx - nx] * (a[idx - nx] - tC);
+            b[idx] = tC + base_r * (flux_r + flux_l + flux_d + flux_u);
+        }
+    }
+    free(kx); free(ky);
+}
+
+static void test_conduct_material_table(void) {
+    // more materials than the heatsink uses, with contrasts both ways and a
+    // zero-k insulator (harmonic mean 0 against anything)
+    static const float kmat[] = { 0.01f, 1.00f, 0.37f, 0.0f, 0.6f };
+    const uint32_t nmat = sizeof(kmat) / sizeof(kmat[0]);
+    const int32_t nx = 53, ny = 41;
+    const size_t n = (size_t)nx * ny;
+    float kface[H2D_MAT_MAX * H2D_MAT_MAX];
+    uint8_t* mat = (uint8_t*)calloc(n, 1);
+    float* k   = alloc_grid(n);
+    float* a   = alloc_grid(n);
+    float* ref = alloc_grid(n);
+    float* b   = alloc_grid(n);
+
+    uint32_t seed = 4242u;
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        mat[i] = (uint8_t)((seed >> 16) % nmat);
+        k[i] = kmat[mat[i]];
+    }
+    h2d_face_table(kmat, nmat, kface);
+    int symmetric = 1;
+    for (uint32_t i = 0; i < nmat; i++) {
+        for (uint32_t j = 0; j < nmat; j++) {
+            if (kface[i*nmat + j] != kface[j*nmat + i]) symmetric = 0;
+        }
+    }
+    CHECK(symmetric, "conduct: face table not symmetric");
+
+    fill_noise(a, n, 8u);
+    conduct_faces_reference(k, nx, ny, 0.20f, a, ref);
+    const h2d_conduct c = { nx, ny, mat, kface, nmat, 0.20f, H2D_BC_DIRICHLET_COLD, 0 };
+    h2d_conduct_rows(&c, a, 0, b, 0, 0, ny);
+    int same = 1;
+    for (int32_t j = 1; j < ny-1; j++) {
+        if (memcmp(b + j*nx + 1, ref + j*nx + 1, (size_t)(nx - 2) * sizeof(float)) != 0) same = 0;
+    }
+    CHECK(same, "conduct: %u-material table differs from per-face conductivities", nmat);
+
+    free(mat); free(k); free(a); free(ref); free(b);
+}
+
+// Column spans of every width and offset (so the vector body, the aligned
+// head and the scalar tail all split rows differently) reproduce the full-row
+// step bit-for-bit, for a table small enough for the NEON register lookup and
+// one that is not. Without NEON this covers the plain scalar loop.
+static void test_conduct_vector_tail(void) {
+    static const float kmat[] = { 0.02f, 1.00f, 0.45f, 0.0f, 0.7f };
+    const int32_t nx = 61, ny = 9;
+    const size_t n = (size_t)nx * ny;
+    float kface[H2D_MAT_MAX * H2D_MAT_MAX];
+    uint8_t* mat = (uint8_t*)calloc(n, 1);
+    float* a   = alloc_grid(n);
+    float* ref = alloc_grid(n);
+    float* b   = alloc_grid(n);
+    fill_noise(a, n, 31u);
+
+    static const uint32_t nmats[] = { 2, 5 };
+    for (size_t m = 0; m < sizeof(nmats) / sizeof(nmats[0]); m++) {
+        const uint32_t nmat = nmats[m];
+        uint32_t seed = 99u + nmat;
+        for (size_t i = 0; i < n; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            mat[i] = (uint8_t)((seed >> 16) % nmat);
+        }
+        h2d_face_table(kmat, nmat, kface);
+        const h2d_conduct c = { nx, ny, mat, kface, nmat, 0.20f, H2D_BC_DIRICHLET_COLD, 0 };
+        memset(ref, 0, n * sizeof(float));
+        h2d_conduct_rows(&c, a, 0, ref, 0, 0, ny);
+
+        int same = 1;
+        for (int32_t w = 1; w <= 13; w++) {
+            for (int32_t x0 = 0; x0 < w; x0++) {
+                memset(b, 0, n * sizeof(float));
+                for (int32_t x = x0 - w; x < nx; x += w) h2d_conduct_span(&c, a, 0, b, 0, 0, ny, x, x + w);
+                if (memcmp(b, ref, n * sizeof(float)) != 0) same = 0;
+            }
+        }
+        CHECK(same, "conduct: %u-material column spans differ from the full-row step", nmat);
+    }
+
+    free(mat); free(a); free(ref); free(b);
+}
+
+// The boundary written inside the stencil sweep matches a plain stencil pass
+// followed by h2d_apply_boundary, and reaches every cell, whether the step
+// runs over the whole grid, over bands or over active-tile blocks.
+static void test_conduct_folded_boundary(void) {
+    heatsink hs;
+    heatsink_init(&hs, 67, 45);
+    const int32_t nx = hs.nx, ny = hs.ny;
+    const size_t n = (size_t)nx * ny;
+    float* k   = alloc_grid(n);
+    float* a   = alloc_grid(n);
+    float* ref = alloc_grid(n);
+    float* b   = alloc_grid(n);
+    for (size_t i = 0; i < n; i++) k[i] = h2d_heatsink_k[hs.mat[i]];
+
+    for (int bc = 0; bc < H2D_BC_COUNT; bc++) {
+        hs.c.bc = bc;
+        fill_noise(a, n, 140u + (uint32_t)bc);
+        conduct_faces_reference(k, nx, ny, hs.c.base_r, a, ref);
+        h2d_apply_boundary(ref, nx, ny, bc);
+
+        for (size_t i = 0; i < n; i++) b[i] = -1.0f;
+        h2d_conduct_rows(&hs.c, a, 0, b, 0, 0, ny);
+        CHECK(memcmp(b, ref, n * sizeof(float)) == 0, "conduct: bc=%d full step differs from two passes", bc);
+
+        for (size_t i = 0; i < n; i++) b[i] = -1.0f;
+        for (uint32_t i = 0; i < 3; i++) {
+            int32_t y0, y1;
+            h2d_conduct_band(ny, 3, i, &y0, &y1);
+            h2d_conduct_rows(&hs.c, a, 0, b, 0, y0, y1);
+        }
+        CHECK(memcmp(b, ref, n * sizeof(float)) == 0, "conduct: bc=%d bands differ from two passes", bc);
+
+        for (size_t i = 0; i < n; i++) b[i] = -1.0f;
+        for (int32_t y = 0; y < ny; y += 16) {
+            for (int32_t x = 0; x < nx; x += 16) {
+                h2d_conduct_block(&hs.c, a, b, x, (x + 16 < nx) ? x + 16 : nx, y, (y + 16 < ny) ? y + 16 : ny);
+            }
+        }
+        CHECK(memcmp(b, ref, n * sizeof(float)) == 0, "conduct: bc=%d blocks differ from two passes", bc);
+    }
+
+    free(k); free(a); free(ref); free(b);
+    heatsink_free(&hs);
+}
+
+static void test_conduct_temporal_blocking(void) {
+    heatsink hs;
+    heatsink_init(&hs, 260, 220);
+    const int32_t nx = hs.nx, ny = hs.ny, tile = 32;
+    const uint32_t max_k = 8;
+    const size_t n = (size_t)nx * ny;
+    float* ref[2] = { alloc_grid(n), alloc_grid(n) };
+    float* a      = alloc_grid(n);
+    float* b      = alloc_grid(n);
+    float* s0     = alloc_grid((size_t)(tile + 2 * (max_k - 1)) * nx);
+    float* s1     = alloc_grid((size_t)(tile + 2 * (max_k - 1)) * nx);
+
+    for (int bc = 0; bc < H2D_BC_COUNT; bc++) {
+        for (uint32_t k = 1; k <= max_k; k *= 2) {
+            hs.c.bc = bc;
+            fill_noise(ref[0], n, 77u + (uint32_t)bc);
+            h2d_stamp_sources_rows(&hs.src, ref[0], 0, nx, ny, 0, ny);
+            memcpy(a, ref[0], n * sizeof(float));
+
+            // what the UEFI loop did before blocking: stamp, step, boundary
+            for (uint32_t s = 0; s < k; s++) {
+                float* in  = ref[s & 1];
+                float* out = ref[(s + 1) & 1];
+                if (s > 0) h2d_stamp_sources_rows(&hs.src, in, 0, nx, ny, 0, ny);
+                h2d_conduct_rows(&hs.c, in, 0, out, 0, 0, ny);
+                h2d_apply_boundary(out, nx, ny, bc);
+            }
+            h2d_step_conduction(&hs.c, a, b, s0, s1, tile, k);
+            CHECK(memcmp(b, ref[k & 1], n * sizeof(float)) == 0,
+                  "conduct: bc=%d k=%u differs from %u single steps", bc, k, k);
+
+            // bands as the UEFI MP split computes them, last band first
+            static const uint32_t bands[] = { 2, 3, 7 };
+            for (size_t bi = 0; bi < sizeof(bands) / sizeof(bands[0]); bi++) {
+                uint32_t nb = bands[bi];
+                memset(b, 0, n * sizeof(float));
+                for (uint32_t i = 0; i < nb; i++) {
+                    int32_t y0, y1;
+                    h2d_conduct_band(ny, nb, nb - 1 - i, &y0, &y1);
+                    h2d_conduct_advance(&hs.c, a, b, s0, s1, tile, y0, y1, k);
+                }
+                CHECK(memcmp(b, ref[k & 1], n * sizeof(float)) == 0,
+                      "conduct: bc=%d k=%u over %u bands differs from %u single steps",
+                      bc, k, nb, k);
+            }
+        }
+    }
+
+    free(ref[0]); free(ref[1]); free(a); free(b); free(s0); free(s1);
+    heatsink_free(&hs);
+}
+
+static void test_conduct_boundary_modes(void) {
+    const int32_t nx = 16, ny = 12;
+    const size_t n = (size_t)nx * ny;
+    float* t = alloc_grid(n);
+
+    fill_noise(t, n, 5u);
+    h2d_apply_boundary(t, nx, ny, H2D_BC_NEUMANN_INSULATED);
+    CHECK(t[3*nx] == t[3*nx + 1] && t[3*nx + nx-1] == t[3*nx + nx-2], "neumann: side columns");
+    CHECK(t[4] == t[nx + 4] && t[(ny-1)*nx + 4] == t[(ny-2)*nx + 4], "neumann: top/bottom rows");
+
+    fill_noise(t, n, 6u);
+    h2d_apply_boundary(t, nx, ny, H2D_BC_MIXED);
+    CHECK(t[3*nx] == 0.f && t[3*nx + nx-1] == 0.f, "mixed: side columns not cold");
+    CHECK(t[4] == t[nx + 4], "mixed: top row not insulated");
+    CHECK(t[0] == 0.f && t[nx-1] == 0.f, "mixed: corners not cold");
+
+    fill_noise(t, n, 7u);
+    h2d_apply_boundary(t, nx, ny, H2D_BC_DIRICHLET_COLD);
+    CHECK(t[0] == 0.f && t[5] == 0.f && t[3*nx] == 0.f && t[(ny-1)*nx + 5] == 0.f,
+          "dirichlet: edges not cold");
+
+    free(t);
+}
+
+// -------------------- active tiles --------------------
+typedef struct {
+    h2d_active a;
+    float*     delta;
+    uint8_t*   quiet;
+    uint8_t*   changed;
+} active_tiles;
+
+static void active_init(active_tiles* t, uint32_t nx, uint32_t ny, uint32_t tile,
+                        float tol, uint32_t quiet_steps) {
+    size_t n = (size_t)h2d_active_tiles(nx, tile) * h2d_active_tiles(ny, tile);
+    t->delta   = alloc_grid(n);
+    t->quiet   = (uint8_t*)calloc(n, 1);
+    t->changed = (uint8_t*)calloc(n, 1);
+    h2d_active_init(&t->a, nx, ny, tile, tol, quiet_steps, t->delta, t->quiet, t->changed);
+}
+
+static void active_free(active_tiles* t) {
+    free(t->delta); free(t->quiet); free(t->changed);
+}
+
+static void test_active_all_awake(void) {
+    // tol < 0: nothing is ever quiet, so the tile kernels must match a full step
+    heatsink hs;
+    heatsink_init(&hs, 61, 47);   // remainder tiles on both axes
+    const int32_t nx = hs.nx, ny = hs.ny;
+    const size_t n = (size_t)nx * ny;
+    float* ref[2] = { alloc_grid(n), alloc_grid(n) };
+    float* act[2] = { alloc_grid(n), alloc_grid(n) };
+
+    for (int bc = 0; bc < H2D_BC_COUNT; bc++) {
+        active_tiles t;
+        active_init(&t, (uint32_t)nx, (uint32_t)ny, 8, -1.0f, 4);
+        hs.c.bc = bc;
+        fill_noise(ref[0], n, 300u + (uint32_t)bc);
+        memcpy(act[0], ref[0], n * sizeof(float));
+        for (uint32_t s = 0; s < 6; s++) {
+            float* in = ref[s & 1];
+            h2d_stamp_sources_rows(&hs.src, in, 0, nx, ny, 0, ny);
+            h2d_step_conduction(&hs.c, in, ref[(s + 1) & 1], 0, 0, 32, 1);
+
+            in = act[s & 1];
+            h2d_stamp_sources_rows(&hs.src, in, 0, nx, ny, 0, ny);
+            h2d_conduct_active_rows(&hs.c, &t.a, in, act[(s + 1) & 1], 0, t.a.th);
+            h2d_active_update(&t.a, act[(s + 1) & 1], in);
+        }
+        CHECK(memcmp(act[0], ref[0], n * sizeof(float)) == 0,
+              "active: conduct bc=%d with every tile awake differs from full steps", bc);
+        active_free(&t);
+    }
+
+    const h2d_plate* p = &k_plate;
+    const size_t pn = (size_t)p->w * p->h;
+    float* pr[2] = { alloc_grid(pn), alloc_grid(pn) };
+    float* pa[2] = { alloc_grid(pn), alloc_grid(pn) };
+    active_tiles t;
+    active_init(&t, p->w, p->h, 16, -1.0f, 4);
+    fill_noise(pr[0], pn, 301u);
+    memcpy(pa[0], pr[0], pn * sizeof(float));
+    for (uint32_t s = 0; s < 6; s++) {
+        h2d_plate_advance(p, pr[s & 1], pr[(s + 1) & 1], 0, 0, 32, 0, p->h, 1);
+        h2d_plate_active_rows(p, &t.a, pa[s & 1], pa[(s + 1) & 1], 0, t.a.th);
+        h2d_active_update(&t.a, pa[(s + 1) & 1], pa[s & 1]);
+    }
+    CHECK(memcmp(pa[0], pr[0], pn * sizeof(float)) == 0,
+          "active: plate with every tile awake differs from full steps");
+    active_free(&t);
+
+    free(ref[0]); free(ref[1]); free(act[0]); free(act[1]);
+    free(pr[0]); free(pr[1]); free(pa[0]); free(pa[1]);
+    heatsink_free(&hs);
+}
+
+static void test_active_sleep_and_wake(void) {
+    heatsink hs;
+    heatsink_init(&hs, 64, 48);
+    const int32_t nx = hs.nx, ny = hs.ny;
+    const size_t n = (size_t)nx * ny;
+    float* f[2] = { alloc_grid(n), alloc_grid(n) };
+    active_tiles t;
+    active_init(&t, (uint32_t)nx, (uint32_t)ny, 16, 1e-6f, 3);
+    const uint32_t tiles = t.a.tw * t.a.th;
+
+    // a cold field with no sources is at equilibrium everywhere
+    uint32_t awake = tiles;
+    for (uint32_t s = 0; s < 3; s++) {
+        h2d_conduct_active_rows(&hs.c, &t.a, f[s & 1], f[(s + 1) & 1], 0, t.a.th);
+        awake = h2d_active_update(&t.a, f[(s + 1) & 1], f[s & 1]);
+    }
+    CHECK(awake == 0, "active: %u of %u tiles still awake on a settled field", awake, tiles);
+    uint32_t y0, y1;
+    h2d_active_changed_rows(&t.a, &y0, &y1);
+    h2d_active_changed_rows(&t.a, &y0, &y1);
+    CHECK(y0 == y1, "active: settled field reports changed rows %u..%u", y0, y1);
+
+    // a brush in the middle of tile (1, 1) wakes just that tile; the heat then
+    // spreads and wakes its neighbours, but leaves the far corner alone
+    h2d_stamp_disk_max(f[0], nx, ny, 24, 24, 2, 1.0f);
+    h2d_active_wake_cells(&t.a, 22, 22, 27, 27);
+    h2d_active_changed_rows(&t.a, &y0, &y1);
+    CHECK(y0 == 16 && y1 == 32, "active: brush changed rows %u..%u, want 16..32", y0, y1);
+    for (uint32_t s = 0; s < 20; s++) {
+        h2d_conduct_active_rows(&hs.c, &t.a, f[s & 1], f[(s + 1) & 1], 0, t.a.th);
+        awake = h2d_active_update(&t.a, f[(s + 1) & 1], f[s & 1]);
+    }
+    CHECK(awake > 1 && awake < tiles, "active: %u of %u tiles awake after a brush", awake, tiles);
+    CHECK(f[0][24 * nx + 24] > 0.0f && f[0][24 * nx + 24] < 1.0f, "active: brush did not diffuse");
+    CHECK(f[0][(ny - 2) * nx + nx - 2] == 0.0f && !h2d_active_awake(&t.a, t.a.tw - 1, t.a.th - 1),
+          "active: far corner woke up");
+
+    active_free(&t);
+    free(f[0]); free(f[1]);
+    heatsink_free(&hs);
+}
+
+static void test_active_heatsink_error(void) {
+    // skipping quiet air must cost work, not accuracy: compare against full steps
+    heatsink hs;
+    heatsink_init(&hs, 260, 220);
+    const int32_t nx = hs.nx, ny = hs.ny;
+    const size_t n = (size_t)nx * ny;
+    float* ref[2] = { alloc_grid(n), alloc_grid(n) };
+    float* act[2] = { alloc_grid(n), alloc_grid(n) };
+    active_tiles t;
+    active_init(&t, (uint32_t)nx, (uint32_t)ny, 16, 1e-5f, 32);
+
+    uint32_t awake = 0;
+    const uint32_t steps = 600;
+    for (uint32_t s = 0; s < steps; s++) {
+        float* in = ref[s & 1];
+        h2d_stamp_sources_rows(&hs.src, in, 0, nx, ny, 0, ny);
+        h2d_step_conduction(&hs.c, in, ref[(s + 1) & 1], 0, 0, 32, 1);
+
+        in = act[s & 1];
+        h2d_stamp_sources_rows(&hs.src, in, 0, nx, ny, 0, ny);
+        h2d_conduct_active_rows(&hs.c, &t.a, in, act[(s + 1) & 1], 0, t.a.th);
+        awake = h2d_active_update(&t.a, act[(s + 1) & 1], in);
+    }
+    float err = 0.0f;
+    for (size_t i = 0; i < n; i++) err = __builtin_fmaxf(err, __builtin_fabsf(act[0][i] - ref[0][i]));
+    CHECK(err < 1e-4f, "active: heatsink drifted %g from full steps", (double)err);
+    CHECK(awake < t.a.tw * t.a.th, "active: heatsink never put a tile to sleep");
+
+    active_free(&t);
+    free(ref[0]); free(ref[1]); free(act[0]); free(act[1]);
+    heatsink_free(&hs);
+}
+
+static void test_active_blocked(void) {
+    // rounds of k blocked steps: with every tile awake they are the plain
+    // blocked advance; on the heatsink they track full steps as single-step
+    // rounds do, and every sleeping tile agrees in both buffers
+    const uint32_t k = 4;
+    const int32_t tile_rows = 16;
+    heatsink hs;
+    heatsink_init(&hs, 61, 47);
+    int32_t nx = hs.nx, ny = hs.ny;
+    size_t n = (size_t)nx * ny;
+    float* ref[2] = { alloc_grid(n), alloc_grid(n) };
+    float* act[2] = { alloc_grid(n), alloc_grid(n) };
+    float* s0 = alloc_grid((size_t)(tile_rows + 2 * (k - 1)) * nx);
+    float* s1 = alloc_grid((size_t)(tile_rows + 2 * (k - 1)) * nx);
+
+    for (int bc = 0; bc < H2D_BC_COUNT; bc++) {
+        active_tiles t;
+        active_init(&t, (uint32_t)nx, (uint32_t)ny, 8, -1.0f, 4);
+        hs.c.bc = bc;
+        fill_noise(ref[0], n, 310u + (uint32_t)bc);
+        memcpy(act[0], ref[0], n * sizeof(float));
+        for (uint32_t s = 0; s < 4; s++) {
+            float* in = ref[s & 1];
+            h2d_stamp_sources_rows(&hs.src, in, 0, nx, ny, 0, ny);
+            h2d_conduct_advance(&hs.c, in, ref[(s + 1) & 1], s0, s1, tile_rows, 0, ny, k);
+
+            in = act[s & 1];
+            h2d_stamp_sources_rows(&hs.src, in, 0, nx, ny, 0, ny);
+            h2d_conduct_active_advance_q(&hs.c, &t.a, in, act[(s + 1) & 1], s0, s1, tile_rows,
+                                         0, t.a.th, k, 0);
+            h2d_active_update(&t.a, act[(s + 1) & 1], in);
+        }
+        CHECK(memcmp(act[0], ref[0], n * sizeof(float)) == 0,
+              "active: conduct bc=%d k=%u rounds with every tile awake differ from blocked steps", bc, k);
+        active_free(&t);
+    }
+
+    const h2d_plate* p = &k_plate;
+    const size_t pn = (size_t)p->w * p->h;
+    free(s0); free(s1);
+    s0 = alloc_grid((size_t)(tile_rows + 2 * (k - 1)) * p->w);
+    s1 = alloc_grid((size_t)(tile_rows + 2 * (k - 1)) * p->w);
+    float* pr[2] = { alloc_grid(pn), alloc_grid(pn) };
+    float* pa[2] = { alloc_grid(pn), alloc_grid(pn) };
+    active_tiles pt;
+    active_init(&pt, p->w, p->h, 16, -1.0f, 4);
+    fill_noise(pr[0], pn, 311u);
+    memcpy(pa[0], pr[0], pn * sizeof(float));
+    for (uint32_t s = 0; s < 4; s++) {
+        h2d_plate_advance(p, pr[s & 1], pr[(s + 1) & 1], s0, s1, tile_rows, 0, p->h, k);
+        h2d_plate_active_advance_q(p, &pt.a, pa[s & 1], pa[(s + 1) & 1], s0, s1, tile_rows,
+                                   0, pt.a.th, k, 0);
+        h2d_active_update(&pt.a, pa[(s + 1) & 1], pa[s & 1]);
+    }
+    CHECK(memcmp(pa[0], pr[0], pn * sizeof(float)) == 0,
+          "active: plate k=%u rounds with every tile awake differ from blocked steps", k);
+    active_free(&pt);
+    free(pr[0]); free(pr[1]); free(pa[0]); free(pa[1]);
+    free(ref[0]); free(ref[1]); free(act[0]); free(act[1]);
+    heatsink_free(&hs);
+
+    heatsink_init(&hs, 260, 220);
+    nx = hs.nx; ny = hs.ny;
+    n = (size_t)nx * ny;
+    for (uint32_t i = 0; i < 2; i++) { ref[i] = alloc_grid(n); act[i] = alloc_grid(n); }
+    free(s0); free(s1);
+    s0 = alloc_grid((size_t)(tile_rows + 2 * (k - 1)) * nx);
+    s1 = alloc_grid((size_t)(tile_rows + 2 * (k - 1)) * nx);
+    active_tiles t;
+    active_init(&t, (uint32_t)nx, (uint32_t)ny, 16, 1e-5f, 8);
+    uint32_t awake = 0;
+    const uint32_t rounds = 150;
+    for (uint32_t s = 0; s < rounds * k; s++) {
+        float* in = ref[s & 1];
+        h2d_stamp_sources_rows(&hs.src, in, 0, nx, ny, 0, ny);
+        h2d_step_conduction(&hs.c, in, ref[(s + 1) & 1], 0, 0, 32, 1);
+    }
+    for (uint32_t r = 0; r < rounds; r++) {
+        float* in = act[r & 1];
+        h2d_stamp_sources_rows(&hs.src, in, 0, nx, ny, 0, ny);
+        h2d_conduct_active_advance_q(&hs.c, &t.a, in, act[(r + 1) & 1], s0, s1, tile_rows,
+                                     0, t.a.th, k, 0);
+        awake = h2d_active_update(&t.a, act[(r + 1) & 1], in);
+    }
+    float err = 0.0f;
+    for (size_t i = 0; i < n; i++) err = __builtin_fmaxf(err, __builtin_fabsf(act[0][i] - ref[0][i]));
+    CHECK(err < 1e-4f, "active: heatsink k=%u rounds drifted %g from full steps", k, (double)err);
+    CHECK(awake < t.a.tw * t.a.th, "active: heatsink k=%u rounds never put a tile to sleep", k);
+    int agree = 1;
+    for (uint32_t ty = 0; ty < t.a.th; ty++) {
+        for (uint32_t tx = 0; tx < t.a.tw; tx++) {
+            if (h2d_active_awake(&t.a, tx, ty)) continue;
+            uint32_t x0, x1, y0, y1;
+            h2d_active_span(&t.a, tx, (uint32_t)nx, t.a.tw, &x0, &x1);
+            h2d_active_span(&t.a, ty, (uint32_t)ny, t.a.th, &y0, &y1);
+            for (uint32_t y = y0; y < y1; y++) {
+                if (memcmp(act[0] + y * nx + x0, act[1] + y * nx + x0, (x1 - x0) * sizeof(float))) agree = 0;
+            }
+        }
+    }
+    CHECK(agree, "active: a sleeping tile differs between the buffers after k=%u rounds", k);
+
+    active_free(&t);
+    free(ref[0]); free(ref[1]); free(act[0]); free(act[1]); free(s0); free(s1);
+    heatsink_free(&hs);
+}
+
+// -------------------- steady state --------------------
+static void test_multigrid_steady(void) {
+    // the solve must land on the stepping's fixed point: one more stamp, step
+    // and boundary from it moves nothing but the source cells, which the next
+    // stamp puts back
+    heatsink hs;
+    heatsink_init(&hs, 260, 220);
+    const int32_t nx = hs.nx, ny = hs.ny;
+    const size_t n = (size_t)nx * ny;
+    float* t = alloc_grid(n);
+    float* b = alloc_grid(n);
+    void* work = calloc(h2d_mg_bytes(nx, ny), 1);
+
+    for (int bc = 0; bc < H2D_BC_COUNT; bc++) {
+        h2d_mg m;
+        hs.c.bc = bc;
+        h2d_mg_init(&m, &hs.c, work);
+        fill_noise(t, n, 400u + (uint32_t)bc);
+        uint32_t iters = h2d_mg_solve(&m, t, 200, 1e-6f);
+        CHECK(iters > 0 && iters < 60, "steady: bc=%d took %u iterations", bc, iters);
+
+        h2d_stamp_sources_rows(&hs.src, t, 0, nx, ny, 0, ny);
+        h2d_step_conduction(&hs.c, t, b, 0, 0, 32, 1);
+        h2d_stamp_sources_rows(&hs.src, b, 0, nx, ny, 0, ny);
+        float moved = 0.0f;
+        int in_range = 1;
+        for (size_t i = 0; i < n; i++) {
+            moved = __builtin_fmaxf(moved, __builtin_fabsf(b[i] - t[i]));
+            if (!(t[i] >= -1e-4f && t[i] <= 1.0f + 1e-4f)) in_range = 0;   // float CG floor
+        }
+        CHECK(moved < 2e-6f, "steady: bc=%d a step from the solution still moves %g", bc, (double)moved);
+        CHECK(in_range, "steady: bc=%d field left [0, 1]", bc);
+        // insulated everywhere with one source temperature: everything ends at it
+        CHECK(bc != H2D_BC_NEUMANN_INSULATED || t[(ny / 4) * nx + nx / 4] > 0.999f,
+              "steady: insulated field did not fill up");
+    }
+
+    free(t); free(b); free(work);
+    heatsink_free(&hs);
+}
+
+// -------------------- adi --------------------
+static void test_adi_tracks_explicit(void) {
+    // 20 ADI steps of 10 against 200 explicit steps from cold, and the steady
+    // state as a fixed point of a long ADI step
+    heatsink hs;
+    heatsink_init(&hs, 260, 220);
+    const int32_t nx = hs.nx, ny = hs.ny;
+    const size_t n = (size_t)nx * ny;
+    float* e[2] = { alloc_grid(n), alloc_grid(n) };
+    float* a[2] = { alloc_grid(n), alloc_grid(n) };
+    float* scratch = alloc_grid(h2d_adi_scratch_floats(nx, ny));
+    uint8_t* fixed = (uint8_t*)calloc(n, 1);
+    void* work = calloc(h2d_mg_bytes(nx, ny), 1);
+    h2d_adi_mark_sources(&hs.src, nx, ny, fixed);
+
+    for (int bc = 0; bc < H2D_BC_COUNT; bc++) {
+        hs.c.bc = bc;
+        h2d_adi d = { &hs.c, 10.0f, 0.0f, fixed, 0 };
+        memset(e[0], 0, n * sizeof(float));
+        memset(a[0], 0, n * sizeof(float));
+        for (int s = 0; s < 200; s++) {
+            h2d_stamp_sources_rows(&hs.src, e[s & 1], 0, nx, ny, 0, ny);
+            h2d_step_conduction(&hs.c, e[s & 1], e[(s + 1) & 1], 0, 0, 32, 1);
+        }
+        for (int s = 0; s < 20; s++) {
+            h2d_stamp_sources_rows(&hs.src, a[s & 1], 0, nx, ny, 0, ny);
+            h2d_adi_step(&d, a[s & 1], a[(s + 1) & 1], scratch);
+        }
+        h2d_stamp_sources_rows(&hs.src, e[0], 0, nx, ny, 0, ny);
+        float diff = 0.0f;
+        for (size_t i = 0; i < n; i++) diff = __builtin_fmaxf(diff, __builtin_fabsf(a[0][i] - e[0][i]));
+        CHECK(diff < 5e-3f, "adi: bc=%d 20 steps of 10 off 200 explicit steps by %g", bc, (double)diff);
+
+        h2d_mg m;
+        h2d_mg_init(&m, &hs.c, work);
+        h2d_mg_solve(&m, e[0], 200, 1e-6f);
+        d.steps = 100.0f;
+        h2d_adi_step(&d, e[0], e[1], scratch);
+        float moved = 0.0f;
+        for (size_t i = 0; i < n; i++) moved = __builtin_fmaxf(moved, __builtin_fabsf(e[1][i] - e[0][i]));
+        CHECK(moved < 1e-5f, "adi: bc=%d a step of 100 from steady state moves %g", bc, (double)moved);
+    }
+
+    free(e[0]); free(e[1]); free(a[0]); free(a[1]); free(scratch); free(fixed); free(work);
+    heatsink_free(&hs);
+}
+
+static void test_adi_bands(void) {
+    // row bands, then column bands in small chunks, as the SMP front ends split
+    // the step, must match h2d_adi_step exactly
+    heatsink hs;
+    heatsink_init(&hs, 131, 97);
+    const int32_t nx = hs.nx, ny = hs.ny;
+    const size_t n = (size_t)nx * ny;
+    float* src = alloc_grid(n);
+    float* ref = alloc_grid(n);
+    float* out = alloc_grid(n);
+    float* scratch = alloc_grid(h2d_adi_scratch_floats(nx, ny));
+    uint8_t* fixed = (uint8_t*)calloc(n, 1);
+    h2d_adi_mark_sources(&hs.src, nx, ny, fixed);
+
+    static const uint32_t bands[] = { 1, 3, 4 };
+    static const int32_t chunks[] = { 1, 7, 64 };
+    for (int bc = 0; bc < H2D_BC_COUNT; bc++) {
+        hs.c.bc = bc;
+        h2d_adi d = { &hs.c, 30.0f, 0.001f, fixed, 0 };
+        fill_noise(src, n, 500u + (uint32_t)bc);
+        h2d_adi_step(&d, src, ref, scratch);
+        for (size_t bi = 0; bi < sizeof(bands) / sizeof(bands[0]); bi++) {
+            for (size_t ci = 0; ci < sizeof(chunks) / sizeof(chunks[0]); ci++) {
+                uint32_t nb = bands[bi];
+                memset(out, 0, n * sizeof(float));
+                for (uint32_t b = 0; b < nb; b++) {
+                    h2d_adi_rows(&d, src, out, (int32_t)(ny * b / nb), (int32_t)(ny * (b + 1) / nb), scratch);
+                }
+                for (uint32_t b = 0; b < nb; b++) {
+                    h2d_adi_cols(&d, out, (int32_t)(nx * b / nb), (int32_t)(nx * (b + 1) / nb),
+                                 scratch, chunks[ci]);
+                }
+                CHECK(memcmp(out, ref, n * sizeof(float)) == 0,
+                      "adi: bc=%d over %u bands, chunk %d differs from the full step",
+                      bc, nb, chunks[ci]);
+            }
+        }
+    }
+
+    // the plate as one uniform material with a sink: long steps from noise
+    // stay in range and cool off
+    h2d_conduct pc = { nx, ny, 0, 0, 1, 0.20f, H2D_BC_DIRICHLET_COLD, 0 };
+    const float k1 = 1.0f;
+    pc.kface = &k1;
+    h2d_adi pd = { &pc, 100.0f, 0.0008f, 0, 1 };
+    fill_noise(src, n, 600u);
+    double before = 0.0, after = 0.0;
+    for (size_t i = 0; i < n; i++) before += src[i];
+    for (int s = 0; s < 10; s++) {
+        h2d_adi_step(&pd, (s & 1) ? out : src, (s & 1) ? src : out, scratch);
+    }
+    int in_range = 1;
+    for (size_t i = 0; i < n; i++) {
+        if (!(src[i] >= 0.0f && src[i] <= 1.0f)) in_range = 0;
+        after += src[i];
+    }
+    CHECK(in_range, "adi: plate field left [0, 1]");
+    CHECK(after < 0.5 * before, "adi: plate did not cool (%g -> %g)", before, after);
+
+    free(src); free(ref); free(out); free(scratch); free(fixed);
+    heatsink_free(&hs);
+}
+
+// -------------------- spectral --------------------
+static void test_spectral_dst(void) {
+    // radix-2 (127) and Bluestein lengths against the O(n^2) sum
+    static const uint32_t ns[] = { 1, 5, 127, 148, 198 };
+    for (size_t t = 0; t < sizeof(ns) / sizeof(ns[0]); t++) {
+        const uint32_t n = ns[t];
+        h2d_dst d;
+        float* tables = alloc_grid(h2d_dst_floats(n));
+        float* buf = alloc_grid(H2D_SPEC_BUF_FLOATS(n + 2, n + 2));
+        float* a = alloc_grid(n);
+        float* b = alloc_grid(n);
+        float* a0 = alloc_grid(n);
+        float* b0 = alloc_grid(n);
+        h2d_dst_init(&d, n, tables, buf);
+        fill_noise(a0, n, 700u + n);
+        fill_noise(b0, n, 800u + n);
+        memcpy(a, a0, n * sizeof(float));
+        memcpy(b, b0, n * sizeof(float));
+        h2d_dst_pair(&d, a, b, 1, buf);
+
+        double err = 0.0, mag = 0.0;
+        for (uint32_t k = 1; k <= n; k++) {
+            double sa = 0.0, sb = 0.0;
+            for (uint32_t j = 1; j <= n; j++) {
+                double sn = h2d_sinpi((double)(j * k) / (n + 1));
+                sa += a0[j - 1] * sn;
+                sb += b0[j - 1] * sn;
+            }
+            err = __builtin_fmax(err, __builtin_fmax(__builtin_fabs(sa - a[k - 1]), __builtin_fabs(sb - b[k - 1])));
+            mag = __builtin_fmax(mag, __builtin_fabs(sa));
+        }
+        CHECK(err <= 1e-6 * (mag + 1.0), "spectral: DST-I n=%u off by %g (max %g)", n, err, mag);
+
+        free(tables); free(buf); free(a); free(b); free(a0); free(b0);
+    }
+}
+
+static void test_spectral_plate(void) {
+    const uint32_t buf_floats = H2D_SPEC_BUF_FLOATS(k_plate.w, k_plate.h);
+    float* buf = alloc_grid(buf_floats);
+
+    // no source (centre off the grid): a jump is the decay the explicit steps
+    // approximate, and two jumps are one
+    {
+        const h2d_plate p = { 120, 90, 0.05f, 0.0008f, -100, -100, 7, 1.0f };
+        const size_t n = (size_t)p.w * p.h;
+        void* work = calloc(h2d_spec_bytes(&p), 1);
+        h2d_spec s;
+        h2d_spec_init(&s, &p, work);
+        float* e[2] = { alloc_grid(n), alloc_grid(n) };
+        float* a = alloc_grid(n);
+        float* b = alloc_grid(n);
+        fill_noise(a, n, 900u);
+        h2d_plate_step_rows(&p, a, 0, e[0], 0, 0, p.h);   // edges to 0
+        memcpy(a, e[0], n * sizeof(float));
+        memcpy(b, e[0], n * sizeof(float));
+        for (int k = 0; k < 400; k++) h2d_plate_step_rows(&p, e[k & 1], 0, e[(k + 1) & 1], 0, 0, p.h);
+        h2d_spec_advance(&s, a, 400.0f, buf);
+        h2d_spec_advance(&s, b, 150.0f, buf);
+        h2d_spec_advance(&s, b, 250.0f, buf);
+        float diff = 0.0f, split = 0.0f;
+        for (size_t i = 0; i < n; i++) {
+            diff = __builtin_fmaxf(diff, __builtin_fabsf(a[i] - e[0][i]));
+            split = __builtin_fmaxf(split, __builtin_fabsf(a[i] - b[i]));
+        }
+        CHECK(diff < 2e-3f, "spectral: a jump of 400 off 400 explicit steps by %g", (double)diff);
+        CHECK(split < 1e-5f, "spectral: jumps of 150 + 250 off one of 400 by %g", (double)split);
+        free(work); free(e[0]); free(e[1]); free(a); free(b);
+    }
+
+    // the metal plate: a long jump lands on the explicit steady state, and the
+    // banded split the SMP front end uses matches the full advance exactly
+    {
+        const h2d_plate* p = &k_plate;
+        const size_t n = (size_t)p->w * p->h;
+        void* work = calloc(h2d_spec_bytes(p), 1);
+        h2d_spec s;
+        h2d_spec_init(&s, p, work);
+        float* a = alloc_grid(n);
+        float* b = alloc_grid(n);
+        float* c = alloc_grid(n);
+        fill_noise(a, n, 901u);
+        h2d_plate_step_rows(p, a, 0, c, 0, 0, p->h);
+        memcpy(a, c, n * sizeof(float));
+        memcpy(b, c, n * sizeof(float));
+
+        h2d_spec_advance(&s, a, 1e7f, buf);
+        h2d_plate_step_rows(p, a, 0, c, 0, 0, p->h);
+        float moved = 0.0f;
+        for (size_t i = 0; i < n; i++) moved = __builtin_fmaxf(moved, __builtin_fabsf(c[i] - a[i]));
+        CHECK(moved < 1e-5f, "spectral: a step from the long jump still moves %g", (double)moved);
+
+        const uint32_t nb = 3;
+        memcpy(a, b, n * sizeof(float));
+        h2d_spec_advance(&s, a, 300.0f, buf);
+        for (uint32_t band = 0; band < nb; band++) h2d_spec_rows(&s, b, p->h * band / nb, p->h * (band + 1) / nb, buf);
+        for (uint32_t band = 0; band < nb; band++) h2d_spec_cols(&s, b, p->w * band / nb, p->w * (band + 1) / nb, buf);
+        for (uint32_t band = 0; band < nb; band++) {
+            uint32_t y0 = p->h * band / nb, y1 = p->h * (band + 1) / nb;
+            h2d_spec_decay(&s, b, 300.0f, y0, y1, buf);
+            h2d_spec_rows(&s, b, y0, y1, buf);
+        }
+        for (uint32_t band = 0; band < nb; band++) h2d_spec_cols(&s, b, p->w * band / nb, p->w * (band + 1) / nb, buf);
+        for (uint32_t band = 0; band < nb; band++) h2d_spec_finish(&s, b, p->h * band / nb, p->h * (band + 1) / nb);
+        CHECK(memcmp(a, b, n * sizeof(float)) == 0, "spectral: banded advance differs from the full one");
+
+        free(work); free(a); free(b); free(c);
+    }
+
+    free(buf);
+}
+
+// -------------------- half storage --------------------
+static void test_half_convert(void) {
+    int roundtrip = 1, ties = 1;
+    for (uint32_t h = 0; h < 0x10000u; h++) {
+        if ((h & 0x7c00u) == 0x7c00u && (h & 0x3ffu)) continue;   // nan
+        if (h2d_half_from_float(h2d_half_to_float((h2d_half)h)) != h) roundtrip = 0;
+    }
+    // halfway between neighbours (subnormals included): ties go to the even one,
+    // anything off the midpoint to the nearer one
+    for (uint32_t h = 0; h < 0x7bffu; h++) {
+        float lo = h2d_half_to_float((h2d_half)h), hi = h2d_half_to_float((h2d_half)(h + 1));
+        float mid = 0.5f * (lo + hi);
+        h2d_half even = (h2d_half)((h & 1u) ? h + 1 : h);
+        if (h2d_half_from_float(mid) != even) ties = 0;
+        if (h2d_half_from_float(nextafterf(mid, 0.0f)) != h) ties = 0;
+        if (h2d_half_from_float(nextafterf(mid, 1e9f)) != h + 1) ties = 0;
+        if (h2d_half_from_float(-mid) != (h2d_half)(even | 0x8000u)) ties = 0;
+    }
+    CHECK(roundtrip, "half: half -> float -> half is not the identity");
+    CHECK(ties, "half: float -> half does not round to nearest even");
+    CHECK(h2d_half_from_float(70000.0f) == 0x7c00u && h2d_half_from_float(65519.0f) == 0x7bffu,
+          "half: overflow does not round to inf at 65520");
+
+#if defined(__FLT16_MAX__)
+    // the compiler's own conversion, where it has one
+    uint32_t seed = 7u;
+    int same = 1;
+    for (int i = 0; i < 1000000; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        union { uint32_t u; float f; } v = { (seed & 0x807fffffu) | ((90u + (seed >> 25) % 60u) << 23) };
+        union { _Float16 f; uint16_t u; } w = { (_Float16)v.f };
+        if (h2d_half_from_float(v.f) != w.u) same = 0;
+    }
+    CHECK(same, "half: differs from the compiler's float -> _Float16");
+#endif
+}
+
+static void test_half_round(void) {
+    // exact halves stay put; anything else lands on a neighbour, up about as
+    // often as the dropped fraction says
+    int exact = 1, neighbour = 1;
+    for (uint32_t h = 0x0400u; h < 0x7bffu; h++) {
+        float lo = h2d_half_to_float((h2d_half)h), hi = h2d_half_to_float((h2d_half)(h + 1));
+        for (uint32_t step = 0; step < 4; step++) {
+            if (h2d_half_round(lo, h, step) != h) exact = 0;
+            h2d_half r = h2d_half_round(lo + 0.3f * (hi - lo), h, step);
+            if (r != h && r != h + 1) neighbour = 0;
+        }
+    }
+    CHECK(exact, "half: stochastic rounding moved an exact half");
+    CHECK(neighbour, "half: stochastic rounding left the two neighbours");
+
+    const float x = 0.5f + 0.3f * (1.0f / 2048.0f);   // 0.3 of the way from 0.5 to the next half
+    uint32_t up = 0;
+    for (uint32_t i = 0; i < 100000; i++) up += h2d_half_round(x, i, 17u) != h2d_half_from_float(0.5f);
+    CHECK(up > 29000 && up < 31000, "half: rounded up %u times in 100000, expected about 30000", up);
+}
+
+// Largest |fp32 - fp16| over a field, after the fp16 one is widened back.
+static float half_drift(const float* f, const h2d_half* h, size_t n) {
+    float d = 0.0f;
+    for (size_t i = 0; i < n; i++) d = fmaxf(d, fabsf(f[i] - h2d_half_to_float(h[i])));
+    return d;
+}
+
+static void test_half_plate(void) {
+    const uint32_t w = 61, h = 47, k = 4;
+    const size_t n = (size_t)w * h;
+    const h2d_plate p = { w, h, 0.20f, 0.0008f, 30, 23, 5, 1.0f };
+    float* f[2] = { alloc_grid(n), alloc_grid(n) };
+    h2d_half* a   = (h2d_half*)calloc(n, sizeof(h2d_half));
+    h2d_half* ref = (h2d_half*)calloc(n, sizeof(h2d_half));
+    h2d_half* b   = (h2d_half*)calloc(n, sizeof(h2d_half));
+    h2d_half* s0  = (h2d_half*)calloc((size_t)(8 + 2 * (k - 1)) * w, sizeof(h2d_half));
+    h2d_half* s1  = (h2d_half*)calloc((size_t)(8 + 2 * (k - 1)) * w, sizeof(h2d_half));
+
+    fill_noise(f[0], n, 61u);
+    h2d_half_from_floats(f[0], a, (uint32_t)n);
+
+    // column spans of every width reproduce the full row (vector body and tail)
+    for (uint32_t y = 1; y < h - 1; y++) {
+        h2d_plate_row_span_h(&p, a + (y - 1) * w, a + y * w, a + (y + 1) * w, ref + y * w, 1, w - 1, y * w, 5u);
+    }
+    int same = 1;
+    for (uint32_t cw = 1; cw <= 13; cw++) {
+        memset(b, 0, n * sizeof(h2d_half));
+        for (uint32_t y = 1; y < h - 1; y++) {
+            for (uint32_t x = 1; x < w - 1; x += cw) {
+                uint32_t x1 = (x + cw < w - 1) ? x + cw : w - 1;
+                h2d_plate_row_span_h(&p, a + (y - 1) * w, a + y * w, a + (y + 1) * w, b + y * w, x, x1,
+                                     y * w, 5u);
+            }
+        }
+        if (memcmp(b, ref, n * sizeof(h2d_half)) != 0) same = 0;
+    }
+    CHECK(same, "half: plate column spans differ from the full row");
+
+    // k blocked steps in half scratch are k single half steps
+    h2d_half* t[2] = { ref, b };
+    memcpy(ref, a, n * sizeof(h2d_half));
+    for (uint32_t s = 0; s < k; s++) h2d_plate_step_rows_h(&p, t[s & 1], 0, t[(s + 1) & 1], 0, 0, h, 40u + s);
+    h2d_half* blocked = (h2d_half*)calloc(n, sizeof(h2d_half));
+    h2d_plate_advance_h(&p, a, blocked, s0, s1, 8, 0, h, k, 40u);
+    CHECK(memcmp(blocked, t[k & 1], n * sizeof(h2d_half)) == 0,
+          "half: plate k=%u blocked differs from single steps", k);
+    free(blocked);
+
+    // from the demo's start the fp16 plate tracks fp32 to within a display level
+    for (size_t i = 0; i < n; i++) f[0][i] = 0.02f;
+    h2d_half_from_floats(f[0], a, (uint32_t)n);
+    for (uint32_t s = 0; s < 2000; s++) {
+        h2d_plate_step_rows(&p, f[s & 1], 0, f[(s + 1) & 1], 0, 0, h);
+        h2d_plate_step_rows_h(&p, (s & 1) ? b : a, 0, (s & 1) ? a : b, 0, 0, h, s);
+    }
+    float drift = half_drift(f[0], a, n);
+    CHECK(drift < 1.0f / 255.0f, "half: plate drifted %g from fp32 in 2000 steps", drift);
+
+    free(f[0]); free(f[1]); free(a); free(ref); free(b); free(s0); free(s1);
+}
+
+static void test_half_conduct(void) {
+    heatsink hs;
+    heatsink_init(&hs, 131, 97);
+    const int32_t nx = hs.nx, ny = hs.ny, tile = 16;
+    const uint32_t k = 4;
+    const size_t n = (size_t)nx * ny;
+    float* f[2] = { alloc_grid(n), alloc_grid(n) };
+    h2d_half* a    = (h2d_half*)calloc(n, sizeof(h2d_half));
+    h2d_half* r[2] = { (h2d_half*)calloc(n, sizeof(h2d_half)), (h2d_half*)calloc(n, sizeof(h2d_half)) };
+    h2d_half* b    = (h2d_half*)calloc(n, sizeof(h2d_half));
+    h2d_half* s0   = (h2d_half*)calloc((size_t)(tile + 2 * (k - 1)) * nx, sizeof(h2d_half));
+    h2d_half* s1   = (h2d_half*)calloc((size_t)(tile + 2 * (k - 1)) * nx, sizeof(h2d_half));
+
+    for (int bc = 0; bc < H2D_BC_COUNT; bc++) {
+        hs.c.bc = bc;
+        fill_noise(f[0], n, 71u + (uint32_t)bc);
+        h2d_half_from_floats(f[0], a, (uint32_t)n);
+        h2d_stamp_sources_rows_h(&hs.src, a, 0, nx, ny, 0, ny);
+
+        // column spans of every width reproduce the full step, boundary included
+        h2d_conduct_rows_h(&hs.c, a, 0, r[0], 0, 0, ny, 9u);
+        int same = 1;
+        for (int32_t cw = 2; cw <= 13; cw++) {
+            memset(b, 0, n * sizeof(h2d_half));
+            for (int32_t x = 0; x < nx; x += cw) {
+                int32_t x1 = (x + cw < nx - 1) ? x + cw : nx;   // keep the right edge with its neighbour
+                h2d_conduct_span_h(&hs.c, a, 0, b, 0, 0, ny, x, x1, 9u);
+                if (x1 == nx) break;
+            }
+            if (memcmp(b, r[0], n * sizeof(h2d_half)) != 0) same = 0;
+        }
+        CHECK(same, "half: bc=%d conduct column spans differ from the full step", bc);
+
+        // k blocked steps over bands are k single steps with re-stamps
+        for (uint32_t s = 0; s < k; s++) {
+            const h2d_half* in = s ? r[s & 1] : a;
+            if (s > 0) h2d_stamp_sources_rows_h(&hs.src, r[s & 1], 0, nx, ny, 0, ny);
+            h2d_conduct_rows_h(&hs.c, in, 0, r[(s + 1) & 1], 0, 0, ny, 100u + s);
+        }
+        for (uint32_t i = 0; i < 3; i++) {
+            int32_t y0, y1;
+            h2d_conduct_band(ny, 3, i, &y0, &y1);
+            h2d_conduct_advance_h(&hs.c, a, b, s0, s1, tile, y0, y1, k, 100u);
+        }
+        CHECK(memcmp(b, r[k & 1], n * sizeof(h2d_half)) == 0,
+              "half: bc=%d conduct k=%u over bands differs from single steps", bc, k);
+
+        // from a cold start the fp16 heatsink tracks fp32 to within two display
+        // levels (rounded to nearest, its air would stop diffusing)
+        memset(f[0], 0, n * sizeof(float));
+        memset(a, 0, n * sizeof(h2d_half));
+        for (uint32_t s = 0; s < 4000; s++) {
+            h2d_stamp_sources_rows(&hs.src, f[s & 1], 0, nx, ny, 0, ny);
+            h2d_conduct_rows(&hs.c, f[s & 1], 0, f[(s + 1) & 1], 0, 0, ny);
+            h2d_half* in  = (s & 1) ? b : a;
+            h2d_half* out = (s & 1) ? a : b;
+            h2d_stamp_sources_rows_h(&hs.src, in, 0, nx, ny, 0, ny);
+            h2d_conduct_rows_h(&hs.c, in, 0, out, 0, 0, ny, s);
+        }
+        float drift = half_drift(f[0], a, n);
+        CHECK(drift < 2.0f / 255.0f, "half: bc=%d conduct drifted %g from fp32 in 4000 steps", bc, drift);
+    }
+
+    free(f[0]); free(f[1]); free(a); free(r[0]); free(r[1]); free(b); free(s0); free(s1);
+    heatsink_free(&hs);
+}
+
+// -------------------- display plane --------------------
+// Every index of the plane is the field's, and every row whose indices moved
+// since the flags were last cleared is flagged.
+static int display_matches(const h2d_display* d, const float* field, const uint8_t* before) {
+    for (uint32_t y = 0; y < d->h; y++) {
+        int moved = 0;
+        for (uint32_t x = 0; x < d->w; x++) {
+            uint32_t i = y * d->w + x;
+            if (d->idx[i] != h2d_display_index(d, field[i])) return 0;
+            if (d->idx[i] != before[i]) moved = 1;
+        }
+        if (moved && !d->rows[y]) return 0;
+    }
+    return 1;
+}
+
+static void test_display_index(void) {
+    uint8_t idx[19], rows[1];
+    float t[19];
+    h2d_display d;
+    h2d_display_init(&d, 19, 1, 0.0f, idx, rows);
+    int same = 1;
+    for (uint32_t i = 0; i < 19; i++) t[i] = (float)i / 18.0f;
+    h2d_display_span(&d, t, 0, 0, 19);
+    for (uint32_t i = 0; i < 19; i++) same &= (idx[i] == h2d_lut_index(t[i]));
+    CHECK(same, "display: bias 0 differs from h2d_lut_index");
+
+    // out of range and NaN clamp, in the vector body and the tail alike
+    const float odd[19] = { -1.0f, 2.0f, NAN, 1e-9f, 1.0f, -0.0f, 0.9999f, 300.0f,
+                            -1.0f, 2.0f, NAN, 1e-9f, 1.0f, -0.0f, 0.9999f, 300.0f,
+                            NAN, -5.0f, 7.0f };
+    const uint8_t want[19] = { 0, 255, 0, 0, 255, 0, 254, 255, 0, 255, 0, 0, 255, 0, 254, 255, 0, 0, 255 };
+    rows[0] = 0;
+    h2d_display_span(&d, odd, 0, 0, 19);
+    CHECK(memcmp(idx, want, 19) == 0, "display: clamping of out-of-range temperatures");
+    CHECK(rows[0], "display: changed row not flagged");
+    rows[0] = 0;
+    h2d_display_span(&d, odd, 0, 0, 19);
+    CHECK(!rows[0], "display: unchanged row flagged");
+
+    d.bias = 0.5f;   // rounds, as the uefi demo does
+    h2d_display_span(&d, t, 0, 0, 19);
+    same = 1;
+    for (uint32_t i = 0; i < 19; i++) same &= (idx[i] == (uint8_t)(t[i] * 255.0f + 0.5f));
+    CHECK(same, "display: bias 0.5 does not round to nearest");
+}
+
+static void test_display_plate(void) {
+    const uint32_t w = 61, h = 47, k = 4;
+    const size_t n = (size_t)w * h;
+    const h2d_plate p = { w, h, 0.20f, 0.0008f, 30, 23, 5, 1.0f };
+    float* src = alloc_grid(n);
+    float* ref = alloc_grid(n);
+    float* dst = alloc_grid(n);
+    float* s0 = alloc_grid((size_t)(8 + 2 * (k - 1)) * w);
+    float* s1 = alloc_grid((size_t)(8 + 2 * (k - 1)) * w);
+    uint8_t* idx = (uint8_t*)calloc(n, 1);
+    uint8_t* before = (uint8_t*)calloc(n, 1);
+    uint8_t rows[47];
+    h2d_display d;
+    h2d_display_init(&d, w, h, 0.0f, idx, rows);
+
+    fill_noise(src, n, 81u);
+    for (uint32_t kk = 1; kk <= k; kk += k - 1) {
+        memcpy(before, idx, n);
+        memset(rows, 0, sizeof(rows));
+        h2d_plate_advance(&p, src, ref, s0, s1, 8, 0, h, kk);
+        for (uint32_t b = 0; b < 3; b++) {   // bands, as the cores split them
+            h2d_plate_advance_q(&p, src, dst, s0, s1, 8, h * b / 3, h * (b + 1) / 3, kk, &d);
+        }
+        CHECK(memcmp(dst, ref, n * sizeof(float)) == 0, "display: plate k=%u field differs", kk);
+        CHECK(display_matches(&d, dst, before), "display: plate k=%u plane differs from the field", kk);
+        memcpy(src, dst, n * sizeof(float));
+    }
+
+    // a settled field leaves every row clean
+    for (size_t i = 0; i < n; i++) src[i] = 0.0f;
+    h2d_display_rows(&d, src, 0, h);
+    memset(rows, 0, sizeof(rows));
+    h2d_plate_step_rows_q(&p, src, 0, dst, 0, 0, h, &d);
+    int clean = 1;
+    for (uint32_t y = 0; y < h; y++) {
+        int disk = ((int)y >= p.src_y - p.src_r && (int)y <= p.src_y + p.src_r);
+        if (rows[y] != disk) clean = 0;
+    }
+    CHECK(clean, "display: plate flags rows beyond the disk on a cold field");
+
+    free(src); free(ref); free(dst); free(s0); free(s1); free(idx); free(before);
+}
+
+static void test_display_conduct(void) {
+    heatsink hs;
+    heatsink_init(&hs, 131, 97);
+    const int32_t nx = hs.nx, ny = hs.ny, tile = 16;
+    const uint32_t k = 4;
+    const size_t n = (size_t)nx * ny;
+    float* a   = alloc_grid(n);
+    float* ref = alloc_grid(n);
+    float* b   = alloc_grid(n);
+    float* s0  = alloc_grid((size_t)(tile + 2 * (k - 1)) * nx);
+    float* s1  = alloc_grid((size_t)(tile + 2 * (k - 1)) * nx);
+    uint8_t* idx = (uint8_t*)calloc(n, 1);
+    uint8_t* before = (uint8_t*)calloc(n, 1);
+    uint8_t* rows = (uint8_t*)calloc((size_t)ny, 1);
+    h2d_display d;
+    h2d_display_init(&d, (uint32_t)nx, (uint32_t)ny, 0.5f, idx, rows);
+
+    for (int bc = 0; bc < H2D_BC_COUNT; bc++) {
+        hs.c.bc = bc;
+        fill_noise(a, n, 91u + (uint32_t)bc);
+        h2d_stamp_sources_rows(&hs.src, a, 0, nx, ny, 0, ny);
+        for (uint32_t kk = 1; kk <= k; kk += k - 1) {
+            memcpy(before, idx, n);
+            memset(rows, 0, (size_t)ny);
+            memset(b, 0, n * sizeof(float));
+            h2d_conduct_advance(&hs.c, a, ref, s0, s1, tile, 0, ny, kk);
+            for (uint32_t i = 0; i < 3; i++) {
+                int32_t y0, y1;
+                h2d_conduct_band(ny, 3, i, &y0, &y1);
+                h2d_conduct_advance_q(&hs.c, a, b, s0, s1, tile, y0, y1, kk, &d);
+            }
+            CHECK(memcmp(b, ref, n * sizeof(float)) == 0, "display: bc=%d conduct k=%u field differs", bc, kk);
+            CHECK(display_matches(&d, b, before),
+                  "display: bc=%d conduct k=%u plane differs from the field", bc, kk);
+        }
+    }
+
+    free(a); free(ref); free(b); free(s0); free(s1); free(idx); free(before); free(rows);
+    heatsink_free(&hs);
+}
+
+static void test_display_active(void) {
+    // active rounds fill the plane for the tiles (k = 1) or tile-row runs
+    // (k > 1) they step; whatever sleeps kept both its cells and its indices
+    heatsink hs;
+    heatsink_init(&hs, 96, 80);
+    const int32_t nx = hs.nx, ny = hs.ny, tile_rows = 16;
+    const uint32_t k = 4;
+    const size_t n = (size_t)nx * ny;
+    float* f[2] = { alloc_grid(n), alloc_grid(n) };
+    float* s0 = alloc_grid((size_t)(tile_rows + 2 * (k - 1)) * nx);
+    float* s1 = alloc_grid((size_t)(tile_rows + 2 * (k - 1)) * nx);
+    uint8_t* idx = (uint8_t*)calloc(n, 1);
+    uint8_t* before = (uint8_t*)calloc(n, 1);
+    uint8_t* rows = (uint8_t*)calloc((size_t)ny, 1);
+    h2d_display d;
+
+    for (uint32_t kk = 1; kk <= k; kk += k - 1) {
+        active_tiles t;
+        active_init(&t, (uint32_t)nx, (uint32_t)ny, 16, 1e-6f, 3);
+        memset(f[0], 0, n * sizeof(float));
+        memset(f[1], 0, n * sizeof(float));
+        h2d_stamp_disk_max(f[0], nx, ny, 24, 24, 3, 1.0f);
+        memcpy(f[1], f[0], n * sizeof(float));
+        h2d_display_init(&d, (uint32_t)nx, (uint32_t)ny, 0.5f, idx, rows);
+        h2d_display_rows(&d, f[0], 0, (uint32_t)ny);
+        int ok = 1;
+        for (uint32_t r = 0; r < 12; r++) {
+            memcpy(before, idx, n);
+            memset(rows, 0, (size_t)ny);
+            h2d_conduct_active_advance_q(&hs.c, &t.a, f[r & 1], f[(r + 1) & 1], s0, s1, tile_rows,
+                                         0, t.a.th, kk, &d);
+            h2d_active_update(&t.a, f[(r + 1) & 1], f[r & 1]);
+            if (!display_matches(&d, f[(r + 1) & 1], before)) ok = 0;
+        }
+        CHECK(ok, "display: active k=%u plane differs from the field", kk);
+        active_free(&t);
+    }
+
+    free(f[0]); free(f[1]); free(s0); free(s1); free(idx); free(before); free(rows);
+    heatsink_free(&hs);
+}
+
+static void test_display_half(void) {
+    // the half steps fill the plane with the indices of the widened halves
+    // they store; h2d_display_span_h clamps like the fp32 span
+    float odd[19] = { -1.0f, 2.0f, NAN, 1e-9f, 1.0f, -0.0f, 0.9999f, 300.0f,
+                      -1.0f, 2.0f, NAN, 1e-9f, 1.0f, -0.0f, 0.9999f, 300.0f,
+                      NAN, -5.0f, INFINITY };
+    h2d_half hodd[19];
+    uint8_t idx19[19], want[19], rows19[1];
+    h2d_display d;
+    h2d_half_from_floats(odd, hodd, 19);
+    h2d_half_to_floats(hodd, odd, 19);
+    h2d_display_init(&d, 19, 1, 0.5f, want, rows19);
+    h2d_display_span(&d, odd, 0, 0, 19);
+    h2d_display_init(&d, 19, 1, 0.5f, idx19, rows19);
+    h2d_display_span_h(&d, hodd, 0, 0, 19);
+    CHECK(memcmp(idx19, want, 19) == 0, "display: half span differs from the widened row");
+
+    heatsink hs;
+    heatsink_init(&hs, 131, 97);
+    const int32_t nx = hs.nx, ny = hs.ny, tile = 16;
+    const uint32_t k = 4, pw = 61, ph = 47;
+    const size_t n = (size_t)nx * ny;
+    const h2d_plate p = { pw, ph, 0.20f, 0.0008f, 30, 23, 5, 1.0f };
+    float* f = alloc_grid(n);
+    h2d_half* a   = (h2d_half*)calloc(n, sizeof(h2d_half));
+    h2d_half* ref = (h2d_half*)calloc(n, sizeof(h2d_half));
+    h2d_half* b   = (h2d_half*)calloc(n, sizeof(h2d_half));
+    h2d_half* s0  = (h2d_half*)calloc((size_t)(tile + 2 * (k - 1)) * nx, sizeof(h2d_half));
+    h2d_half* s1  = (h2d_half*)calloc((size_t)(tile + 2 * (k - 1)) * nx, sizeof(h2d_half));
+    uint8_t* idx = (uint8_t*)calloc(n, 1);
+    uint8_t* before = (uint8_t*)calloc(n, 1);
+    uint8_t* rows = (uint8_t*)calloc((size_t)ny, 1);
+
+    h2d_display_init(&d, pw, ph, 0.0f, idx, rows);
+    fill_noise(f, (size_t)pw * ph, 83u);
+    h2d_half_from_floats(f, a, pw * ph);
+    for (uint32_t kk = 1; kk <= k; kk += k - 1) {
+        memcpy(before, idx, (size_t)pw * ph);
+        memset(rows, 0, ph);
+        h2d_plate_advance_h(&p, a, ref, s0, s1, 8, 0, ph, kk, 5u);
+        for (uint32_t i = 0; i < 3; i++) {
+            h2d_plate_advance_hq(&p, a, b, s0, s1, 8, ph * i / 3, ph * (i + 1) / 3, kk, 5u, &d);
+        }
+        h2d_half_to_floats(b, f, pw * ph);
+        CHECK(memcmp(b, ref, (size_t)pw * ph * sizeof(h2d_half)) == 0, "display: half plate k=%u field differs", kk);
+        CHECK(display_matches(&d, f, before), "display: half plate k=%u plane differs from the field", kk);
+        memcpy(a, b, (size_t)pw * ph * sizeof(h2d_half));
+    }
+
+    h2d_display_init(&d, (uint32_t)nx, (uint32_t)ny, 0.5f, idx, rows);
+    for (int bc = 0; bc < H2D_BC_COUNT; bc++) {
+        hs.c.bc = bc;
+        fill_noise(f, n, 93u + (uint32_t)bc);
+        h2d_half_from_floats(f, a, (uint32_t)n);
+        h2d_stamp_sources_rows_h(&hs.src, a, 0, nx, ny, 0, ny);
+        for (uint32_t kk = 1; kk <= k; kk += k - 1) {
+            memcpy(before, idx, n);
+            memset(rows, 0, (size_t)ny);
+            memset(b, 0, n * sizeof(h2d_half));
+            h2d_conduct_advance_h(&hs.c, a, ref, s0, s1, tile, 0, ny, kk, 7u);
+            for (uint32_t i = 0; i < 3; i++) {
+                int32_t y0, y1;
+                h2d_conduct_band(ny, 3, i, &y0, &y1);
+                h2d_conduct_advance_hq(&hs.c, a, b, s0, s1, tile, y0, y1, kk, 7u, &d);
+            }
+            h2d_half_to_floats(b, f, (uint32_t)n);
+            CHECK(memcmp(b, ref, n * sizeof(h2d_half)) == 0, "display: bc=%d half conduct k=%u field differs", bc, kk);
+            CHECK(display_matches(&d, f, before),
+                  "display: bc=%d half conduct k=%u plane differs from the field", bc, kk);
+        }
+    }
+
+    free(f); free(a); free(ref); free(b); free(s0); free(s1); free(idx); free(before); free(rows);
+    heatsink_free(&hs);
+}
+
+// -------------------- render --------------------
+static void test_palette_lut(void) {
+    static const h2d_color_stop stops[] = {
+        {0.00f,  10,  20,  30},
+        {0.50f, 100, 110, 120},
+        {1.00f, 250, 240, 230},
+    };
+    h2d_rgb8 lut[256];
+    h2d_build_palette_lut(stops, 3, lut);
+    CHECK(lut[0].r == 10 && lut[0].g == 20 && lut[0].b == 30, "palette: first entry");
+    CHECK(lut[255].r == 250 && lut[255].g == 240 && lut[255].b == 230, "palette: last entry");
+    int monotonic = 1;
+    for (int i = 1; i < 256; i++) {
+        if (lut[i].r < lut[i - 1].r) monotonic = 0;
+    }
+    CHECK(monotonic, "palette: red channel not monotonic");
+}
+
+static void test_render_cells(void) {
+    const uint32_t w = 20, h = 15, sx = 4, sy = 3, band = 5;
+    const uint32_t pitch = w * sx + 7;   // padded scanline
+    float* field = alloc_grid((size_t)w * h);
+    uint8_t* drawn = (uint8_t*)calloc((size_t)w * h, 1);
+    uint32_t* fb = (uint32_t*)calloc((size_t)pitch * h * sy, sizeof(uint32_t));
+    uint32_t lut[256];
+    h2d_rect rects[3];
+    for (uint32_t i = 0; i < 256; i++) lut[i] = 0xFF000000u | i;
+
+    fill_noise(field, (size_t)w * h, 11u);
+    const h2d_surface s = { fb, pitch, sx, sy };
+
+    uint32_t nr = h2d_render_cells(field, w, h, lut, drawn, 1, &s, band, rects);
+    CHECK(nr == 3, "render: full redraw gave %u rects", nr);
+    int ok = 1;
+    for (uint32_t y = 0; y < h * sy; y++) {
+        for (uint32_t x = 0; x < w * sx; x++) {
+            if (fb[y * pitch + x] != lut[h2d_lut_index(field[(y / sy) * w + x / sx])]) ok = 0;
+        }
+        for (uint32_t x = w * sx; x < pitch; x++) {
+            if (fb[y * pitch + x] != 0) ok = 0;   // padding untouched
+        }
+    }
+    CHECK(ok, "render: full redraw pixels");
+
+    nr = h2d_render_cells(field, w, h, lut, drawn, 0, &s, band, rects);
+    CHECK(nr == 0, "render: unchanged field gave %u rects", nr);
+
+    field[7 * w + 9] = (field[7 * w + 9] < 0.5f) ? 0.9f : 0.1f;
+    nr = h2d_render_cells(field, w, h, lut, drawn, 0, &s, band, rects);
+    CHECK(nr == 1 && rects[0].x0 == 9 * sx && rects[0].x1 == 10 * sx &&
+          rects[0].y0 == 5 * sy && rects[0].y1 == 10 * sy,
+          "render: one changed cell gave %u rects", nr);
+    CHECK(fb[(7 * sy + 1) * pitch + 9 * sx + 2] == lut[h2d_lut_index(field[7 * w + 9])],
+          "render: changed cell not redrawn");
+
+    // rows outside the requested range are not even looked at
+    field[2 * w + 3] = (field[2 * w + 3] < 0.5f) ? 0.9f : 0.1f;
+    field[12 * w + 4] = (field[12 * w + 4] < 0.5f) ? 0.9f : 0.1f;
+    nr = h2d_render_cells_rows(field, w, h, lut, drawn, 0, &s, band, rects, 11, 15);
+    CHECK(nr == 1 && rects[0].y0 == 10 * sy && rects[0].x0 == 4 * sx,
+          "render: row range gave %u rects", nr);
+    CHECK(drawn[2 * w + 3] != h2d_lut_index(field[2 * w + 3]), "render: row outside range drawn");
+
+    free(field); free(drawn); free(fb);
+}
+
+static void test_render_display(void) {
+    const uint32_t w = 20, h = 15, sx = 4, sy = 3, band = 5;
+    const uint32_t pitch = w * sx + 7;
+    float* field = alloc_grid((size_t)w * h);
+    uint8_t* drawn[2] = { (uint8_t*)calloc((size_t)w * h, 1), (uint8_t*)calloc((size_t)w * h, 1) };
+    uint32_t* fb[2] = { (uint32_t*)calloc((size_t)pitch * h * sy, sizeof(uint32_t)),
+                        (uint32_t*)calloc((size_t)pitch * h * sy, sizeof(uint32_t)) };
+    uint8_t idx[20 * 15], rows[15];
+    uint32_t lut[256];
+    h2d_rect rects[2][3];
+    for (uint32_t i = 0; i < 256; i++) lut[i] = 0xFF000000u | i;
+
+    fill_noise(field, (size_t)w * h, 13u);
+    h2d_display d;
+    h2d_display_init(&d, w, h, 0.0f, idx, rows);
+    h2d_display_rows(&d, field, 0, h);
+    const h2d_surface s[2] = { { fb[0], pitch, sx, sy }, { fb[1], pitch, sx, sy } };
+
+    // the same pixels and rectangles as rendering the floats
+    uint32_t nf = h2d_render_cells(field, w, h, lut, drawn[0], 1, &s[0], band, rects[0]);
+    uint32_t nd = h2d_render_display_rows(&d, lut, drawn[1], 1, &s[1], band, rects[1], 0, h);
+    CHECK(nf == nd && memcmp(rects[0], rects[1], nf * sizeof(h2d_rect)) == 0 &&
+          memcmp(fb[0], fb[1], (size_t)pitch * h * sy * sizeof(uint32_t)) == 0 &&
+          memcmp(drawn[0], drawn[1], (size_t)w * h) == 0,
+          "render: display plane differs from the field render");
+
+    int clear = 1;
+    for (uint32_t y = 0; y < h; y++) clear &= !rows[y];
+    CHECK(clear, "render: display flags not consumed");
+
+    field[7 * w + 9] = (field[7 * w + 9] < 0.5f) ? 0.9f : 0.1f;
+    field[12 * w + 4] = (field[12 * w + 4] < 0.5f) ? 0.9f : 0.1f;
+    h2d_display_rows(&d, field, 0, h);
+    CHECK(rows[7] && rows[12] && !rows[6], "render: changed rows not flagged");
+    drawn[1][12 * w + 4] = idx[12 * w + 4];   // only rows flagged are looked at...
+    rows[12] = 0;
+    nd = h2d_render_display_rows(&d, lut, drawn[1], 0, &s[1], band, rects[1], 0, h);
+    CHECK(nd == 1 && rects[1][0].x0 == 9 * sx && rects[1][0].x1 == 10 * sx &&
+          rects[1][0].y0 == 5 * sy && rects[1][0].y1 == 10 * sy,
+          "render: one changed row gave %u rects", nd);
+    CHECK(fb[1][(12 * sy) * pitch + 4 * sx] == fb[0][(12 * sy) * pitch + 4 * sx],
+          "render: clean row redrawn");   // ...so row 12 still shows the old colour
+
+    free(field); free(drawn[0]); free(drawn[1]); free(fb[0]); free(fb[1]);
+}
+
+int main(void) {
+    test_plate_temporal_blocking();
+    test_plate_source_and_edges();
+    test_conduct_temporal_blocking();
+    test_conduct_boundary_modes();
+    test_conduct_material_table();
+    test_conduct_vector_tail();
+    test_conduct_folded_boundary();
+    test_active_all_awake();
+    test_active_sleep_and_wake();
+    test_active_heatsink_error();
+    test_active_blocked();
+    test_multigrid_steady();
+    test_adi_tracks_explicit();
+    test_adi_bands();
+    test_spectral_dst();
+    test_spectral_plate();
+    test_half_convert();
+    test_half_round();
+    test_half_plate();
+    test_half_conduct();
+    test_display_index();
+    test_display_plate();
+    test_display_conduct();
+    test_display_active();
+    test_display_half();
+    test_palette_lut();
+    test_render_cells();
+    test_render_display();
+
+    if (g_failures) {
+        printf("%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    printf("all core tests passed\n");
+    return 0;
+}
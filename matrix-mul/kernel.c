@@ -1,5 +1,29 @@
 #include <stdint.h>
 
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#if defined(MM_BENCH)
+#include "../bench/bench.h"
+#endif
+
+// --- TINY LIBC ---
+// GCC may turn zero/copy loops into memset/memcpy calls even with -ffreestanding,
+// and nothing else provides them here.
+void* memset(void* dst, int v, unsigned long n) {
+    unsigned char* p = (unsigned char*)dst;
+    while (n--) *p++ = (unsigned char)v;
+    return dst;
+}
+
+void* memcpy(void* dst, const void* src, unsigned long n) {
+    unsigned char* d = (unsigned char*)dst;
+    const unsigned char* s = (const unsigned char*)src;
+    while (n--) *d++ = *s++;
+    return dst;
+}
+
 // --- UART DRIVER (To replace printf) ---
 // Base Address for Pi 4 MMIO is 0xFE000000
 #define MMIO_BASE       0xFE000000
@@ -52,41 +76,331 @@ int my_rand(void) {
     return (unsigned int)(next / 65536) % 32768;
 }
 
-void kernel_main(void) {
-    uart_puts("\n\rBare Metal Matrix Multiplication (Pi 4 Emulator)\n\r");
-    uart_puts("Initializing matrices...\n\r");
+// --- PACKED GEMM ENGINE ---
+//
+// C += A * B, all N x N row-major, blocked the GotoBLAS/BLIS way:
+//   - B is packed once into KC x NR column panels (k-major, NR doubles per k).
+//     All cores read the same copy, so it is packed once up front rather than
+//     per core and per block; each slice's panels are contiguous, so the NC
+//     columns of a jc pass are one KC x NC block of it.
+//   - For each MC-row block of C, NC-column pass and KC slice, A is packed into
+//     MR-row panels (MR doubles per k) that stay in L2 while the pass's B panels
+//     stream by. The B a packed A block sees is bounded to KC x NC, not KC x N.
+//   - The 8x6 micro-kernel keeps its whole C tile in 24 NEON registers and does
+//     one vector FMA per 2 flops, reading only the packed panels.
+// Partial tiles at the right/bottom edge are zero-padded in the packed panels and
+// go through a small scratch tile.
 
-    // Initialize with random values
-    for (int i = 0; i < N * N; i++) {
-        A[i] = (double)(my_rand() % 100) / 10.0;
-        B[i] = (double)(my_rand() % 100) / 10.0;
-        C[i] = 0.0;
+#define MR 8      // micro-tile rows (4 x float64x2 of A)
+#define NR 6      // micro-tile cols (3 x float64x2 of B)
+#define MC 128    // rows of A per packed block  (MC*KC*8 = 256 KiB, L2)
+#define KC 256    // depth of a packed slice     (KC*NR*8 =  12 KiB, L1)
+#define NC 384    // columns of B per pass       (KC*NC*8 = 768 KiB, L2; a multiple of NR)
+
+#define NCORES 4  // Pi 4 / QEMU raspi4b
+
+#define N_PANELS  ((N + NR - 1) / NR)
+#define N_PADDED  (N_PANELS * NR)
+
+// Packed B: slice p (rows p..p+kc of B) starts at p * N_PADDED; panel jp of that
+// slice is kc x NR at offset jp * kc * NR.
+double Bp[N_PADDED * N] __attribute__((aligned(64)));
+double Ap[NCORES][MC * KC] __attribute__((aligned(64)));   // one A block per core
+
+static void pack_b(void) {
+    for (int p = 0; p < N; p += KC) {
+        int kc = (N - p < KC) ? (N - p) : KC;
+        double* slice = &Bp[(long)p * N_PADDED];
+        for (int jp = 0; jp < N_PANELS; jp++) {
+            double* dst = slice + (long)jp * kc * NR;
+            int j0 = jp * NR;
+            for (int k = 0; k < kc; k++) {
+                const double* src = &B[(long)(p + k) * N];
+                for (int j = 0; j < NR; j++) {
+                    *dst++ = (j0 + j < N) ? src[j0 + j] : 0.0;
+                }
+            }
+        }
+    }
+}
+
+static void pack_a(double* dst, int i0, int mc, int p, int kc) {
+    for (int ip = 0; ip < mc; ip += MR) {
+        for (int k = 0; k < kc; k++) {
+            for (int i = 0; i < MR; i++) {
+                *dst++ = (ip + i < mc) ? A[(long)(i0 + ip + i) * N + p + k] : 0.0;
+            }
+        }
+    }
+}
+
+// C[0..MR)[0..NR) += Ap(kc x MR) * Bp(kc x NR); C has row stride ldc.
+static void micro_kernel_8x6(int kc, const double* a, const double* b, double* c, long ldc) {
+#if defined(__ARM_NEON)
+    float64x2_t c00 = vdupq_n_f64(0.0), c01 = c00, c02 = c00;
+    float64x2_t c10 = c00, c11 = c00, c12 = c00;
+    float64x2_t c20 = c00, c21 = c00, c22 = c00;
+    float64x2_t c30 = c00, c31 = c00, c32 = c00;
+    float64x2_t c40 = c00, c41 = c00, c42 = c00;
+    float64x2_t c50 = c00, c51 = c00, c52 = c00;
+    float64x2_t c60 = c00, c61 = c00, c62 = c00;
+    float64x2_t c70 = c00, c71 = c00, c72 = c00;
+
+#define FMA_ROW(r, av, lane)                                \
+    c##r##0 = vfmaq_laneq_f64(c##r##0, b0, av, lane);       \
+    c##r##1 = vfmaq_laneq_f64(c##r##1, b1, av, lane);       \
+    c##r##2 = vfmaq_laneq_f64(c##r##2, b2, av, lane);
+
+    for (int k = 0; k < kc; k++) {
+        float64x2_t b0 = vld1q_f64(b + 0);
+        float64x2_t b1 = vld1q_f64(b + 2);
+        float64x2_t b2 = vld1q_f64(b + 4);
+        float64x2_t a01 = vld1q_f64(a + 0);
+        float64x2_t a23 = vld1q_f64(a + 2);
+        float64x2_t a45 = vld1q_f64(a + 4);
+        float64x2_t a67 = vld1q_f64(a + 6);
+
+        FMA_ROW(0, a01, 0) FMA_ROW(1, a01, 1)
+        FMA_ROW(2, a23, 0) FMA_ROW(3, a23, 1)
+        FMA_ROW(4, a45, 0) FMA_ROW(5, a45, 1)
+        FMA_ROW(6, a67, 0) FMA_ROW(7, a67, 1)
+
+        a += MR;
+        b += NR;
     }
+#undef FMA_ROW
 
-    uart_puts("Starting calculation (Naive O(N^3))...\n\r");
+#define STORE_ROW(r)                                                        \
+    vst1q_f64(c + r * ldc + 0, vaddq_f64(vld1q_f64(c + r * ldc + 0), c##r##0)); \
+    vst1q_f64(c + r * ldc + 2, vaddq_f64(vld1q_f64(c + r * ldc + 2), c##r##1)); \
+    vst1q_f64(c + r * ldc + 4, vaddq_f64(vld1q_f64(c + r * ldc + 4), c##r##2));
 
-    // Matrix Multiply: C = A * B
-    for (int i = 0; i < N; i++) {
-        for (int k = 0; k < N; k++) {
-            double r = A[i * N + k];
-            for (int j = 0; j < N; j++) {
-                C[i * N + j] += r * B[k * N + j];
+    STORE_ROW(0) STORE_ROW(1) STORE_ROW(2) STORE_ROW(3)
+    STORE_ROW(4) STORE_ROW(5) STORE_ROW(6) STORE_ROW(7)
+#undef STORE_ROW
+#else
+    double acc[MR][NR] = {{0.0}};
+    for (int k = 0; k < kc; k++) {
+        for (int i = 0; i < MR; i++) {
+            for (int j = 0; j < NR; j++) {
+                acc[i][j] += a[i] * b[j];
             }
         }
-        // Progress indicator every 10 rows
-        if (i % 50 == 0) {
+        a += MR;
+        b += NR;
+    }
+    for (int i = 0; i < MR; i++) {
+        for (int j = 0; j < NR; j++) {
+            c[i * ldc + j] += acc[i][j];
+        }
+    }
+#endif
+}
+
+// C rows [i0, i0+mc) += A rows [i0, i0+mc) * B, NC columns of B per pass
+static void gemm_row_block(int core, int i0, int mc) {
+    double edge[MR * NR] __attribute__((aligned(16)));
+
+    for (int jc = 0; jc < N_PANELS; jc += NC / NR) {
+        int jc_end = (N_PANELS - jc < NC / NR) ? N_PANELS : jc + NC / NR;
+
+        for (int p = 0; p < N; p += KC) {
+            int kc = (N - p < KC) ? (N - p) : KC;
+            pack_a(Ap[core], i0, mc, p, kc);
+            const double* slice = &Bp[(long)p * N_PADDED];
+
+            for (int jp = jc; jp < jc_end; jp++) {
+                int j0 = jp * NR;
+                int nr = (N - j0 < NR) ? (N - j0) : NR;
+                const double* bpanel = slice + (long)jp * kc * NR;
+
+                for (int ip = 0; ip < mc; ip += MR) {
+                    int mr = (mc - ip < MR) ? (mc - ip) : MR;
+                    const double* apanel = &Ap[core][(long)ip * kc];
+                    double* ctile = &C[(long)(i0 + ip) * N + j0];
+
+                    if (mr == MR && nr == NR) {
+                        micro_kernel_8x6(kc, apanel, bpanel, ctile, N);
+                    } else {
+                        for (int t = 0; t < MR * NR; t++) edge[t] = 0.0;
+                        micro_kernel_8x6(kc, apanel, bpanel, edge, NR);
+                        for (int i = 0; i < mr; i++) {
+                            for (int j = 0; j < nr; j++) {
+                                ctile[(long)i * N + j] += edge[i * NR + j];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// --- MULTI-CORE ---
+//
+// All four cores pull MC-row blocks of C from a shared atomic counter, so faster
+// cores simply take more blocks. Only core 0 talks to the UART.
+
+#define SPIN_TABLE_BASE 0xd8   // firmware spin table: release address of core n at 0xd8 + 8n
+
+extern void secondary_entry(void);
+
+// For cores parked in start.S instead. They poll it with caches off from reset,
+// before core 0 clears BSS, so it lives in .data: its 0 comes from the image,
+// not from whatever RAM held.
+volatile unsigned long secondary_release __attribute__((section(".data"))) = 0;
+
+unsigned long next_block = 0;         // round << 32 | next MC-row block to hand out
+unsigned int rows_done = 0;           // rows of C finished by any core
+unsigned int gemm_go = 0;             // bumped by core 0 to start a multiply
+unsigned int blocks_by_core[NCORES];  // per-core completion report
+int report_progress = 1;              // core 0 prints "Row completed" lines
+
+// Make a store visible to a core that still runs with its MMU and caches off.
+static void clean_to_poc(volatile void* p) {
+    __asm__ volatile("dc civac, %0" :: "r"(p) : "memory");
+    __asm__ volatile("dsb sy" ::: "memory");
+}
+
+static void release_secondaries(void) {
+    for (int core = 1; core < NCORES; core++) {
+        volatile unsigned long* slot = (volatile unsigned long*)(SPIN_TABLE_BASE + 8UL * core);
+        *slot = (unsigned long)&secondary_entry;
+        clean_to_poc(slot);
+    }
+    secondary_release = 1;
+    clean_to_poc(&secondary_release);
+    __asm__ volatile("sev");
+}
+
+// Takes row blocks of round `round` (the gemm_go value this core acquired);
+// returns once the counter runs past the last block or belongs to a later round.
+static void gemm_worker(int core, unsigned int round) {
+    for (;;) {
+        unsigned long t = __atomic_load_n(&next_block, __ATOMIC_ACQUIRE);
+        int i;
+        do {
+            i = (int)(unsigned int)t * MC;
+            if ((unsigned int)(t >> 32) != round || i >= N) return;
+        } while (!__atomic_compare_exchange_n(&next_block, &t, t + 1, 1,
+                                              __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE));
+
+        int mc = (N - i < MC) ? (N - i) : MC;
+        gemm_row_block(core, i, mc);
+        blocks_by_core[core]++;
+        unsigned int done = __atomic_add_fetch(&rows_done, (unsigned int)mc, __ATOMIC_RELEASE);
+
+        if (core == 0 && report_progress) {
             uart_puts("Row completed: ");
-            uart_print_int(i);
+            uart_print_int(done);
             uart_puts(" out of ");
             uart_print_int(N);
             uart_puts(" rows \n\r");
         }
     }
+}
+
+void secondary_main(unsigned long core) {
+    unsigned int seen = 0;
+    for (;;) {
+        unsigned int go;
+        while ((go = __atomic_load_n(&gemm_go, __ATOMIC_ACQUIRE)) == seen) {
+            __asm__ volatile("wfe");
+        }
+        seen = go;
+        gemm_worker((int)core, go);
+        __asm__ volatile("sev");
+    }
+}
+
+// C = A * B on every core; returns when all N rows are done. The block counter
+// carries the round number, and a core only takes blocks of the round whose
+// gemm_go it acquired, which orders the clear of C before its first C +=. A
+// core still leaving the previous round finds a round it never joined and
+// goes back to waiting; it cannot touch rows_done, since every block of that
+// round was finished before core 0 got here.
+static void gemm_all_cores(void) {
+    unsigned int round = gemm_go + 1;   // only core 0 writes gemm_go
+    for (int i = 0; i < N * N; i++) C[i] = 0.0;
+    __atomic_store_n(&rows_done, 0u, __ATOMIC_RELAXED);
+    __atomic_store_n(&next_block, (unsigned long)round << 32, __ATOMIC_RELAXED);
+    __atomic_store_n(&gemm_go, round, __ATOMIC_RELEASE);
+    __asm__ volatile("sev");
+
+    gemm_worker(0, round);
+
+    while (__atomic_load_n(&rows_done, __ATOMIC_ACQUIRE) < N) {
+        __asm__ volatile("wfe");
+    }
+}
+
+#if defined(MM_BENCH)
+// make BENCH=1: time the packing and the full multiply after the normal run.
+#ifndef BENCH_WARMUP
+#define BENCH_WARMUP 1
+#endif
+#ifndef BENCH_ITERS
+#define BENCH_ITERS 5
+#endif
+
+static void bench_pack_b(void* ctx) { (void)ctx; pack_b(); }
+static void bench_gemm(void* ctx)   { (void)ctx; gemm_all_cores(); }
+
+static void run_benchmarks(void) {
+    const bench_case cases[] = {
+        { "pack_b", bench_pack_b, 0, BENCH_WARMUP, BENCH_ITERS, (uint64_t)N * N, "elems/s" },
+        { "dgemm",  bench_gemm,   0, BENCH_WARMUP, BENCH_ITERS, 2ull * N * N * N, "flop/s" },
+    };
+
+    report_progress = 0;
+    uart_puts("BENCHCFG n=");
+    bench_put_u64(uart_puts, N);
+    uart_puts(" cores=");
+    bench_put_u64(uart_puts, NCORES);
+    uart_puts("\n\r");
+    for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        bench_run(&cases[i], uart_puts);
+    }
+}
+#endif
+
+void kernel_main(void) {
+    uart_puts("\n\rBare Metal Matrix Multiplication (Pi 4 Emulator)\n\r");
+    uart_puts("Initializing matrices...\n\r");
+
+    // Initialize with random values
+    for (int i = 0; i < N * N; i++) {
+        A[i] = (double)(my_rand() % 100) / 10.0;
+        B[i] = (double)(my_rand() % 100) / 10.0;
+    }
+
+    uart_puts("Waking secondary cores...\n\r");
+    release_secondaries();
+
+    uart_puts("Packing B...\n\r");
+    pack_b();
+
+    uart_puts("Starting calculation (packed GEMM, 8x6 micro-kernel, 4 cores)...\n\r");
+
+    // Matrix Multiply: C = A * B, MC-row blocks of C shared out between cores
+    gemm_all_cores();
+
+    for (int core = 0; core < NCORES; core++) {
+        uart_puts("Core ");
+        uart_print_int(core);
+        uart_puts(" completed ");
+        uart_print_int(blocks_by_core[core]);
+        uart_puts(" row blocks\n\r");
+    }
 
     uart_puts("Calculation Done!\n\r");
     uart_puts("Value at C[0][0]: ");
     uart_print_int((long)C[0]); // Cast to int just for simple printing
     uart_puts("\n\r");
+
+#if defined(MM_BENCH)
+    run_benchmarks();
+#endif
     
     while(1) { } // Halt
 }
\ No newline at end of file
@@ -12,7 +12,18 @@
 #include <stdint.h>
 #include <stddef.h>
 
-extern "C" char __bss_end__[];
+#include "../core/heat2d_plate.h"
+#include "../core/heat2d_render.h"
+#include "../core/heat2d_adi.h"
+#include "../core/heat2d_spectral.h"
+#include "../core/heat2d_half.h"
+#include "../core/heat2d_display.h"
+
+#if defined(HEAT2D_BENCH)
+#include "../bench/bench.h"
+#endif
+
+extern "C" char __fb_start__[]; // 2 MiB block after .bss, mapped non-cacheable by start.S
 
 /* ------------------------- tiny libc ------------------------- */
 extern "C" void* memset(void* dst, int v, size_t n) {
@@ -53,6 +64,30 @@ static inline void mmio_write32be(uintptr_t addr, uint32_t v) {
 static inline void dsb_sy() { asm volatile("dsb sy" ::: "memory"); }
 static inline void isb()    { asm volatile("isb" ::: "memory"); }
 
+/* ------------------------- Cache maintenance ------------------------- */
+// start.S runs with the D-cache on and RAM write-back, but fw_cfg DMA is not
+// coherent with it on real hardware: clean what the device will read, invalidate
+// what it wrote. Harmless with the MMU off (EL2) and on QEMU, which has no caches.
+static inline uintptr_t dcache_line() {
+    uint64_t ctr;
+    asm volatile("mrs %0, ctr_el0" : "=r"(ctr));
+    return (uintptr_t)4u << ((ctr >> 16) & 0xF); // CTR_EL0.DminLine, in words
+}
+
+static void dcache_clean_range(const volatile void* p, size_t len) {
+    uintptr_t line = dcache_line();
+    uintptr_t a = (uintptr_t)p & ~(line - 1);
+    for (; a < (uintptr_t)p + len; a += line) asm volatile("dc cvac, %0" :: "r"(a) : "memory");
+    dsb_sy();
+}
+
+static void dcache_invalidate_range(const volatile void* p, size_t len) {
+    uintptr_t line = dcache_line();
+    uintptr_t a = (uintptr_t)p & ~(line - 1);
+    for (; a < (uintptr_t)p + len; a += line) asm volatile("dc ivac, %0" :: "r"(a) : "memory");
+    dsb_sy();
+}
+
 /* ------------------------- PL011 UART (virt) ------------------------- */
 static constexpr uintptr_t UART_BASE = 0x09000000UL;
 
@@ -101,6 +136,144 @@ static void delay_ms(uint32_t ms) {
     while ((read_cntpct_el0() - start) < ticks) { }
 }
 
+// EL1 physical timer (CNTP), PPI 30. Only ever used to wake the boot core from
+// wfi, so the interrupt stays masked in PSTATE and is never taken.
+static constexpr uint32_t CNTP_PPI = 30;
+
+static inline void cntp_arm(uint64_t deadline) {
+    asm volatile("msr cntp_cval_el0, %0" :: "r"(deadline));
+    asm volatile("msr cntp_ctl_el0, %0" :: "r"((uint64_t)1)); // ENABLE, IMASK=0
+    isb();
+}
+
+static inline void cntp_disarm() {
+    asm volatile("msr cntp_ctl_el0, %0" :: "r"((uint64_t)0)); // drops the timer line
+    isb();
+}
+
+/* ------------------------- GICv2 (virt) ------------------------- */
+// QEMU virt's default GIC (gic-version=2). WFI wakes on a pending interrupt even
+// with PSTATE.I set, so routing CNTP through the distributor and CPU interface is
+// all sleep_until() needs: no vector table, no acknowledge/EOI.
+static constexpr uintptr_t GICD_BASE = 0x08000000UL;
+static constexpr uintptr_t GICC_BASE = 0x08010000UL;
+
+static constexpr uintptr_t GICD_CTLR       = GICD_BASE + 0x000;
+static constexpr uintptr_t GICD_ISENABLER0 = GICD_BASE + 0x100;
+static constexpr uintptr_t GICD_IPRIORITYR = GICD_BASE + 0x400;
+static constexpr uintptr_t GICD_PIDR2      = GICD_BASE + 0xFE8;
+static constexpr uintptr_t GICC_CTLR       = GICC_BASE + 0x000;
+static constexpr uintptr_t GICC_PMR        = GICC_BASE + 0x004;
+
+static bool g_timer_wfi = false; // CNTP can wake wfi; otherwise sleep_until spins
+
+// Enable the CNTP PPI on the calling core. Returns false on anything but a GICv2
+// (e.g. -M virt,gic-version=3, whose CPU interface is system registers).
+static bool gic_init_timer_wakeup() {
+    uint32_t arch = (mmio_read32(GICD_PIDR2) >> 4) & 0xF;
+    if (arch != 2) return false;
+
+    mmio_write32(GICD_CTLR, 1);
+    uintptr_t prio = GICD_IPRIORITYR + (CNTP_PPI & ~3u);
+    uint32_t shift = (CNTP_PPI & 3u) * 8;
+    mmio_write32(prio, (mmio_read32(prio) & ~(0xFFu << shift)) | (0xA0u << shift));
+    mmio_write32(GICD_ISENABLER0, 1u << CNTP_PPI); // banked per core
+    mmio_write32(GICC_PMR, 0xFF);
+    mmio_write32(GICC_CTLR, 1);
+    dsb_sy();
+    return true;
+}
+
+// Sleep until CNTPCT reaches deadline: wfi on the CNTP interrupt when the GIC is
+// set up, a busy-wait otherwise. Spurious wakeups just go back to sleep.
+static void sleep_until(uint64_t deadline) {
+    if (!g_timer_wfi) {
+        while (read_cntpct_el0() < deadline) { }
+        return;
+    }
+    cntp_arm(deadline);
+    while (read_cntpct_el0() < deadline) {
+        asm volatile("wfi" ::: "memory");
+    }
+    cntp_disarm();
+}
+
+/* ------------------------- PSCI + SMP (virt) ------------------------- */
+// QEMU virt implements PSCI in the emulator itself. The conduit is HVC when we
+// run at EL1 and SMC when the guest owns EL2 (-M virt,virtualization=on).
+static constexpr uint64_t PSCI_CPU_ON = 0xC4000003; // SMC64 function id
+
+static constexpr int64_t PSCI_SUCCESS = 0;
+
+static constexpr uint32_t SMP_MAX_CPUS = 8; // must match __max_cpus in link.ld
+
+extern "C" void _secondary_start();
+
+static inline uint32_t current_el() {
+    uint64_t v;
+    asm volatile("mrs %0, CurrentEL" : "=r"(v));
+    return (uint32_t)((v >> 2) & 3);
+}
+
+static int64_t psci_call(uint64_t fn, uint64_t a1, uint64_t a2, uint64_t a3) {
+    register uint64_t x0 asm("x0") = fn;
+    register uint64_t x1 asm("x1") = a1;
+    register uint64_t x2 asm("x2") = a2;
+    register uint64_t x3 asm("x3") = a3;
+    if (current_el() == 2) {
+        asm volatile("smc #0" : "+r"(x0), "+r"(x1), "+r"(x2), "+r"(x3) :: "memory");
+    } else {
+        asm volatile("hvc #0" : "+r"(x0), "+r"(x1), "+r"(x2), "+r"(x3) :: "memory");
+    }
+    return (int64_t)x0;
+}
+
+struct SmpState {
+    uint32_t ncpus;    // cores taking part in step_sim (boot core included)
+    uint32_t online;   // secondaries that reached secondary_main
+    uint32_t released; // set once ncpus is final
+    // sense-reversing barrier
+    uint32_t bar_count;
+    uint32_t bar_sense;
+};
+
+static SmpState g_smp = { 1, 0, 0, 0, 0 };
+
+static void smp_barrier(uint32_t& local_sense) {
+    uint32_t sense = local_sense ^ 1u;
+    local_sense = sense;
+    if (__atomic_add_fetch(&g_smp.bar_count, 1u, __ATOMIC_ACQ_REL) == g_smp.ncpus) {
+        __atomic_store_n(&g_smp.bar_count, 0u, __ATOMIC_RELAXED);
+        __atomic_store_n(&g_smp.bar_sense, sense, __ATOMIC_RELEASE);
+        asm volatile("sev" ::: "memory");
+    } else {
+        while (__atomic_load_n(&g_smp.bar_sense, __ATOMIC_ACQUIRE) != sense) {
+            asm volatile("wfe" ::: "memory");
+        }
+    }
+}
+
+// Start cores 1..SMP_MAX_CPUS-1 (virt uses MPIDR Aff0 = cpu index) and wait for
+// them to check in. Stops at the first core PSCI refuses, e.g. beyond -smp N.
+static void smp_start_secondaries() {
+    uint32_t started = 0;
+    for (uint32_t cpu = 1; cpu < SMP_MAX_CPUS; cpu++) {
+        int64_t r = psci_call(PSCI_CPU_ON, cpu, (uint64_t)(uintptr_t)&_secondary_start, cpu);
+        if (r != PSCI_SUCCESS) break;
+        started++;
+    }
+
+    while (__atomic_load_n(&g_smp.online, __ATOMIC_ACQUIRE) < started) { }
+
+    g_smp.ncpus = 1 + started;
+    __atomic_store_n(&g_smp.released, 1u, __ATOMIC_RELEASE);
+    asm volatile("sev" ::: "memory");
+
+    uart_puts("SMP: cores running step_sim = ");
+    uart_hex32(g_smp.ncpus);
+    uart_puts(current_el() == 2 ? " (PSCI via SMC)\n" : " (PSCI via HVC)\n");
+}
+
 /* ------------------------- fw_cfg + DMA (virt) ------------------------- */
 static constexpr uintptr_t FW_CFG_BASE     = 0x09020000UL;
 static constexpr uintptr_t FW_CFG_DMA_ADDR = FW_CFG_BASE + 0x10;
@@ -139,14 +312,29 @@ struct __attribute__((packed)) RAMFBCfg {
 };
 static_assert(sizeof(RAMFBCfg) == 28, "RAMFBCfg must be 28 bytes");
 
-static volatile FWCfgDmaAccess g_dma __attribute__((aligned(16)));
+// The descriptor and a bounce buffer each own whole cache lines (128 covers
+// every Cortex-A line size), so invalidating them can never drop a neighbour's
+// dirty data, e.g. stack slots next to a caller's buffer.
+static constexpr uint32_t DMA_BOUNCE_SIZE = 256;
+
+static volatile FWCfgDmaAccess g_dma __attribute__((aligned(128)));
+static uint8_t g_dma_bounce[DMA_BOUNCE_SIZE] __attribute__((aligned(128)));
 
 static void fw_cfg_dma_transfer(uint32_t control, void* buf, uint32_t len) {
+    if (len > DMA_BOUNCE_SIZE) {
+        uart_puts("fw_cfg DMA transfer too large\nHALTING.\n");
+        while (1) asm volatile("wfi");
+    }
+
+    // WRITE/SKIP: the device reads the bounce buffer; READ: it writes it, so no
+    // dirty line may be evicted over the data while the transfer is in flight.
+    if (control & DMA_CTL_WRITE) memcpy(g_dma_bounce, buf, len);
+    dcache_clean_range(g_dma_bounce, len);
+
     g_dma.control_be = bswap32(control);
     g_dma.length_be  = bswap32(len);
-    g_dma.address_be = bswap64((uint64_t)(uintptr_t)buf);
-
-    dsb_sy();
+    g_dma.address_be = bswap64((uint64_t)(uintptr_t)g_dma_bounce);
+    dcache_clean_range(&g_dma, sizeof(g_dma));
 
     uint64_t desc_addr = (uint64_t)(uintptr_t)&g_dma;
 
@@ -154,8 +342,10 @@ static void fw_cfg_dma_transfer(uint32_t control, void* buf, uint32_t len) {
     mmio_write32be(FW_CFG_DMA_ADDR + 0, (uint32_t)(desc_addr >> 32));
     mmio_write32be(FW_CFG_DMA_ADDR + 4, (uint32_t)(desc_addr & 0xFFFFFFFFu));
 
-    // Poll completion; QEMU clears control to 0, sets ERROR bit on failure
+    // Poll completion; QEMU clears control to 0, sets ERROR bit on failure.
+    // The device writes control behind the cache, so re-fetch it every time.
     for (;;) {
+        dcache_invalidate_range(&g_dma, sizeof(g_dma));
         uint32_t c = bswap32(g_dma.control_be);
         if (c == 0) break;
         if (c & DMA_CTL_ERROR) {
@@ -165,6 +355,11 @@ static void fw_cfg_dma_transfer(uint32_t control, void* buf, uint32_t len) {
             while (1) asm volatile("wfi");
         }
     }
+
+    if (control & DMA_CTL_READ) {
+        dcache_invalidate_range(g_dma_bounce, len);
+        memcpy(buf, g_dma_bounce, len);
+    }
 }
 
 static bool fw_cfg_find_file(const char* target, uint16_t& out_sel, uint32_t& out_size) {
@@ -224,158 +419,530 @@ static constexpr uint32_t fourcc(char a, char b, char c, char d) {
 /* ------------------------- Heat2D demo ------------------------- */
 static constexpr uint32_t FB_W = 800;
 static constexpr uint32_t FB_H = 600;
+static_assert(FB_W * FB_H * 4 <= 0x200000, "framebuffer must fit the 2 MiB block in link.ld");
 
 // 200x150 maps perfectly to 800x600 with 4x4 pixel blocks
 static constexpr uint32_t SIM_W = 200;
 static constexpr uint32_t SIM_H = 150;
 
-static float g_field[SIM_W * SIM_H];
-static float g_next[SIM_W * SIM_H];
+// Front/back pair: step_sim reads g_field, writes g_next, then swaps the pointers
+// (same A/B scheme as uefi/Heat2D.c), so a step is a single pass over memory.
+static float g_buf[2][SIM_W * SIM_H];
+static float* g_field = g_buf[0];
+static float* g_next  = g_buf[1];
+
+// What render() draws from: the LUT index of every cell and a changed flag per
+// row (core/heat2d_display.h). The blocked explicit steps write it as they
+// store; render() quantizes whatever the other solvers changed.
+static uint8_t     g_disp_idx[SIM_W * SIM_H];
+static uint8_t     g_disp_rows[SIM_H];
+static h2d_display g_disp;
 
-struct RGB { uint8_t r, g, b; };
-struct Stop { float t; RGB c; };
-struct Palette { const char* name; Stop s[4]; };
+struct Palette { const char* name; h2d_color_stop s[4]; };
 
 static Palette g_pal[3] = {
     {"Fiery", {
-        {0.00f, { 20,  24,  82}},
-        {0.35f, { 30, 120, 200}},
-        {0.65f, {255, 180,  60}},
-        {1.00f, {255, 255, 245}},
+        {0.00f,  20,  24,  82},
+        {0.35f,  30, 120, 200},
+        {0.65f, 255, 180,  60},
+        {1.00f, 255, 255, 245},
     }},
     {"Ocean", {
-        {0.00f, { 10,  40,  70}},
-        {0.40f, { 40, 140, 170}},
-        {0.75f, { 80, 210, 190}},
-        {1.00f, {230, 255, 255}},
+        {0.00f,  10,  40,  70},
+        {0.40f,  40, 140, 170},
+        {0.75f,  80, 210, 190},
+        {1.00f, 230, 255, 255},
     }},
     {"Magenta", {
-        {0.00f, { 55,  10,  60}},
-        {0.35f, {140,  30, 140}},
-        {0.70f, {240, 120, 200}},
-        {1.00f, {255, 240, 255}},
+        {0.00f,  55,  10,  60},
+        {0.35f, 140,  30, 140},
+        {0.70f, 240, 120, 200},
+        {1.00f, 255, 240, 255},
     }},
 };
 
 static uint32_t g_lut[3][256];
 
-static inline float clamp01(float x) {
-    if (x < 0.f) return 0.f;
-    if (x > 1.f) return 1.f;
-    return x;
-}
-
-static inline uint8_t lerp_u8(uint8_t a, uint8_t b, float t) {
-    float v = (float)a + ((float)b - (float)a) * t;
-    if (v < 0.f) v = 0.f;
-    if (v > 255.f) v = 255.f;
-    return (uint8_t)(v + 0.5f);
-}
-
-static RGB sample_palette(const Palette& p, float t) {
-    t = clamp01(t);
-    for (int i = 1; i < 4; i++) {
-        if (t <= p.s[i].t) {
-            float t0 = p.s[i-1].t;
-            float t1 = p.s[i].t;
-            float span = (t1 - t0);
-            float u = (span > 0.f) ? ((t - t0) / span) : 0.f;
-            RGB a = p.s[i-1].c;
-            RGB b = p.s[i].c;
-            return { lerp_u8(a.r, b.r, u), lerp_u8(a.g, b.g, u), lerp_u8(a.b, b.b, u) };
-        }
-    }
-    return p.s[3].c;
-}
-
 static void build_luts() {
     for (int p = 0; p < 3; p++) {
+        h2d_rgb8 rgb[256];
+        h2d_build_palette_lut(g_pal[p].s, 4, rgb);
         for (int i = 0; i < 256; i++) {
-            float t = (float)i / 255.0f;
-            RGB c = sample_palette(g_pal[p], t);
             // XRGB8888: 0x00RRGGBB
-            g_lut[p][i] = ((uint32_t)c.r << 16) | ((uint32_t)c.g << 8) | (uint32_t)c.b;
+            g_lut[p][i] = ((uint32_t)rgb[i].r << 16) | ((uint32_t)rgb[i].g << 8) | (uint32_t)rgb[i].b;
         }
     }
 }
 
+static void active_reset();
+static void adi_reset();
+
+static void half_reset();
+
 static void reset_field() {
     for (uint32_t i = 0; i < SIM_W * SIM_H; i++) {
         g_field[i] = 0.02f;
         g_next[i]  = 0.02f;
     }
+    h2d_display_init(&g_disp, SIM_W, SIM_H, 0.0f, g_disp_idx, g_disp_rows);
+    h2d_display_rows(&g_disp, g_field, 0, SIM_H);
+    half_reset();
+    active_reset();
+    adi_reset();
+}
+
+// Solver parameters for core/heat2d_plate.h. The heat source is a disk at the
+// grid centre, re-stamped after every step.
+static constexpr h2d_plate k_plate = {
+    SIM_W, SIM_H,
+    0.20f,                          // alpha
+    0.0008f,                        // cooling
+    (int)SIM_W / 2, (int)SIM_H / 2, // source centre
+    7,                              // source radius
+    1.0f,                           // source temperature
+};
+
+/* ------------------------- Temporal blocking ------------------------- */
+// step_sim advances k_tb_steps (K = TB_STEPS) steps per pass over g_field,
+// tiled into TB_TILE_ROWS-row trapezoids by h2d_plate_advance (bit-identical to
+// K single steps). Each core gets its own scratch pair. K is fixed at build
+// time here; the UEFI demo's 't' key is the runtime control.
+#ifndef TB_STEPS
+#define TB_STEPS 1
+#endif
+#ifndef TB_MAX_STEPS
+#define TB_MAX_STEPS 16
+#endif
+#ifndef TB_TILE_ROWS
+#define TB_TILE_ROWS 32
+#endif
+static_assert(TB_STEPS >= 1 && TB_STEPS <= TB_MAX_STEPS, "TB_STEPS must be 1..TB_MAX_STEPS");
+
+static constexpr uint32_t k_tb_steps = TB_STEPS;
+static constexpr uint32_t TB_SCRATCH_ROWS = TB_TILE_ROWS + 2 * (TB_MAX_STEPS - 1);
+
+static float g_tb_scratch[SMP_MAX_CPUS][2][TB_SCRATCH_ROWS * SIM_W];
+
+/* ------------------------- fp16 storage ------------------------- */
+// With FIELD_FP16=1 the plate lives in g_hfield/g_hnext as IEEE halves
+// (core/heat2d_half.h): the blocked steps stream half the bytes, compute in
+// fp32 and store with stochastic rounding, dithered by g_hstep, filling g_disp
+// from the halves they store. g_field only seeds them at reset; nothing is
+// widened back. Explicit steps only.
+#ifndef FIELD_FP16
+#define FIELD_FP16 0
+#endif
+
+static h2d_half g_hbuf[2][FIELD_FP16 ? SIM_W * SIM_H : 1];
+static h2d_half* g_hfield = g_hbuf[0];
+static h2d_half* g_hnext  = g_hbuf[1];
+static h2d_half g_tb_hscratch[SMP_MAX_CPUS][2][FIELD_FP16 ? TB_SCRATCH_ROWS * SIM_W : 1];
+static uint32_t g_hstep = 0; // step number of the next step, for the dither
+
+static void half_reset() {
+    if (!FIELD_FP16) return;
+    h2d_half_from_floats(g_field, g_hfield, SIM_W * SIM_H);
+    h2d_half_from_floats(g_next, g_hnext, SIM_W * SIM_H);
+    h2d_display_rows_h(&g_disp, g_hfield, 0, SIM_H);
+    g_hstep = 0;
+}
+
+static void advance_band(uint32_t cpu, uint32_t b0, uint32_t b1, uint32_t k) {
+    if (FIELD_FP16) {
+        h2d_plate_advance_hq(&k_plate, g_hfield, g_hnext, g_tb_hscratch[cpu][0], g_tb_hscratch[cpu][1],
+                             TB_TILE_ROWS, b0, b1, k, g_hstep, &g_disp);
+    } else {
+        h2d_plate_advance_q(&k_plate, g_field, g_next, g_tb_scratch[cpu][0], g_tb_scratch[cpu][1],
+                            TB_TILE_ROWS, b0, b1, k, &g_disp);
+    }
+}
+
+static inline void cpu_band(uint32_t cpu, uint32_t& y0, uint32_t& y1) {
+    y0 = SIM_H * cpu / g_smp.ncpus;
+    y1 = SIM_H * (cpu + 1) / g_smp.ncpus;
 }
 
-static void stamp_disk(float* buf, int cx, int cy, int r, float v) {
-    int r2 = r * r;
+/* ------------------------- Implicit steps ------------------------- */
+// With ADI_STEPS=N > 0 each step_sim() is one ADI step (core/heat2d_adi.h) of
+// N explicit steps' worth of time, for alpha * N far past the explicit limit:
+// the plate as one uniform material with cooling as the sink, the disk held
+// as fixed cells. Every core solves a band of rows, then a band of columns
+// (three barriers per step); the column chunks reuse the temporal-blocking
+// scratch. It steps the whole plate, so active tiles default to off.
+#ifndef ADI_STEPS
+#define ADI_STEPS 0
+#endif
+
+static const float k_adi_kface[1] = { 1.0f };
+static const h2d_conduct k_adi_plate = {
+    (int32_t)SIM_W, (int32_t)SIM_H,
+    nullptr, k_adi_kface, 1,        // one material, k = 1
+    k_plate.alpha,
+    H2D_BC_DIRICHLET_COLD,
+    nullptr,
+};
+static uint8_t g_adi_fixed[SIM_W * SIM_H];
+static const h2d_adi k_adi = { &k_adi_plate, (float)ADI_STEPS, k_plate.cooling, g_adi_fixed, 1 };
+
+static constexpr int32_t ADI_COL_CHUNK = (int32_t)(TB_SCRATCH_ROWS * SIM_W / SIM_H);
+
+// Mark the disk cells h2d_plate_stamp_disk writes.
+static void adi_reset() {
+    const int r = k_plate.src_r;
+    for (uint32_t i = 0; i < SIM_W * SIM_H; i++) g_adi_fixed[i] = 0;
     for (int dy = -r; dy <= r; dy++) {
+        int y = k_plate.src_y + dy;
+        if (y <= 0 || y >= (int)SIM_H - 1) continue;
         for (int dx = -r; dx <= r; dx++) {
-            int x = cx + dx;
-            int y = cy + dy;
-            if (x <= 0 || y <= 0 || x >= (int)SIM_W-1 || y >= (int)SIM_H-1) continue;
-            if (dx*dx + dy*dy <= r2) buf[(uint32_t)y * SIM_W + (uint32_t)x] = v;
+            int x = k_plate.src_x + dx;
+            if (x <= 0 || x >= (int)SIM_W - 1) continue;
+            if (dx*dx + dy*dy <= r*r) g_adi_fixed[(uint32_t)y * SIM_W + (uint32_t)x] = 1;
         }
     }
 }
 
-static void step_sim() {
-    constexpr float alpha   = 0.20f;
-    constexpr float cooling = 0.0008f;
-
-    for (uint32_t y = 1; y < SIM_H - 1; y++) {
-        for (uint32_t x = 1; x < SIM_W - 1; x++) {
-            uint32_t idx = y * SIM_W + x;
-            float t = g_field[idx];
-            float lap =
-                g_field[idx - 1] + g_field[idx + 1] +
-                g_field[idx - SIM_W] + g_field[idx + SIM_W] -
-                4.0f * t;
-            float next = t + alpha * lap - cooling * t;
-            g_next[idx] = clamp01(next);
-        }
+static void adi_rows(uint32_t cpu) {
+    uint32_t y0, y1;
+    cpu_band(cpu, y0, y1);
+    h2d_adi_rows(&k_adi, g_field, g_next, (int32_t)y0, (int32_t)y1, g_tb_scratch[cpu][0]);
+}
+
+static void adi_cols(uint32_t cpu) {
+    int32_t x0 = (int32_t)(SIM_W * cpu / g_smp.ncpus);
+    int32_t x1 = (int32_t)(SIM_W * (cpu + 1) / g_smp.ncpus);
+    h2d_adi_cols(&k_adi, g_next, x0, x1, g_tb_scratch[cpu][0], ADI_COL_CHUNK);
+}
+
+/* ------------------------- Spectral jumps ------------------------- */
+// With SPECTRAL_STEPS=N > 0 each step_sim() advances the plate by N explicit
+// steps' worth of time exactly (core/heat2d_spectral.h): a forward and an
+// inverse 2D sine transform, whatever N is, with the disk as a forcing term.
+// Every core transforms a band of rows, then a band of columns, twice (five
+// barriers per jump; the decay rides on the second row pass). The boot core
+// builds the tables once, before the secondaries start.
+#ifndef SPECTRAL_STEPS
+#define SPECTRAL_STEPS 0
+#endif
+#ifndef SPECTRAL_WORK_BYTES
+#define SPECTRAL_WORK_BYTES (512u * 1024u)   // h2d_spec_bytes for the plate, with room
+#endif
+static_assert(!(SPECTRAL_STEPS && ADI_STEPS), "pick one of SPECTRAL_STEPS and ADI_STEPS");
+static_assert(H2D_SPEC_BUF_FLOATS(SIM_W, SIM_H) <= TB_SCRATCH_ROWS * SIM_W,
+              "the spectral transform buffer shares the temporal-blocking scratch");
+
+static h2d_spec g_spec;
+static uint8_t  g_spec_work[SPECTRAL_STEPS ? SPECTRAL_WORK_BYTES : 8] __attribute__((aligned(8)));
+
+static void spectral_init() {
+    if (h2d_spec_bytes(&k_plate) > sizeof(g_spec_work)) {
+        uart_puts("spectral: SPECTRAL_WORK_BYTES too small\nHALTING.\n");
+        while (1) asm volatile("wfi");
     }
+    h2d_spec_init(&g_spec, &k_plate, g_spec_work);
+    uart_puts("Spectral jumps of ");
+    uart_hex32(SPECTRAL_STEPS);
+    uart_puts(" steps\n");
+}
+
+static inline void cpu_cols(uint32_t cpu, uint32_t& x0, uint32_t& x1) {
+    x0 = SIM_W * cpu / g_smp.ncpus;
+    x1 = SIM_W * (cpu + 1) / g_smp.ncpus;
+}
 
-    // boundaries
-    for (uint32_t x = 0; x < SIM_W; x++) {
-        g_next[x] = 0.f;
-        g_next[(SIM_H - 1) * SIM_W + x] = 0.f;
+// Phase 0..3 of a jump on this core's band: rows, columns, decay + rows, columns.
+static void spectral_phase(uint32_t cpu, uint32_t phase) {
+    float* buf = g_tb_scratch[cpu][0];
+    uint32_t y0, y1, x0, x1;
+    cpu_band(cpu, y0, y1);
+    cpu_cols(cpu, x0, x1);
+    if (phase == 2) h2d_spec_decay(&g_spec, g_field, (float)SPECTRAL_STEPS, y0, y1, buf);
+    if (phase & 1) {
+        h2d_spec_cols(&g_spec, g_field, x0, x1, buf);
+    } else {
+        h2d_spec_rows(&g_spec, g_field, y0, y1, buf);
     }
-    for (uint32_t y = 0; y < SIM_H; y++) {
-        g_next[y * SIM_W] = 0.f;
-        g_next[y * SIM_W + (SIM_W - 1)] = 0.f;
+}
+
+/* ------------------------- Active tiles ------------------------- */
+// With ACTIVE_TILES=1 (default) only tiles whose neighbourhood changed by more
+// than ACTIVE_TOL per step within the last ACTIVE_QUIET rounds are stepped and
+// rendered (core/heat2d_active.h); a settled plate costs almost nothing. Each
+// core steps a band of tile rows, one round per barrier pair, and the boot
+// core updates the tracker in between. A round is k_tb_steps temporally
+// blocked steps over the tile rows holding an awake tile, filling g_disp as
+// it stores, so blocking and the fused display stay on with active tiles.
+#ifndef ACTIVE_TILES
+#define ACTIVE_TILES (ADI_STEPS == 0 && SPECTRAL_STEPS == 0 && FIELD_FP16 == 0)
+#endif
+static_assert(!(ACTIVE_TILES && (ADI_STEPS || SPECTRAL_STEPS || FIELD_FP16)),
+              "ADI_STEPS, SPECTRAL_STEPS and FIELD_FP16 step the whole plate; build with ACTIVE_TILES=0");
+static_assert(!(FIELD_FP16 && (ADI_STEPS || SPECTRAL_STEPS)),
+              "FIELD_FP16 stores the explicit steps only; drop ADI_STEPS and SPECTRAL_STEPS");
+#ifndef ACTIVE_TILE
+#define ACTIVE_TILE 16
+#endif
+#ifndef ACTIVE_TOL
+#define ACTIVE_TOL 1e-5f
+#endif
+#ifndef ACTIVE_QUIET
+#define ACTIVE_QUIET 32
+#endif
+
+static constexpr uint32_t ACT_TW = (SIM_W / ACTIVE_TILE > 0) ? SIM_W / ACTIVE_TILE : 1;
+static constexpr uint32_t ACT_TH = (SIM_H / ACTIVE_TILE > 0) ? SIM_H / ACTIVE_TILE : 1;
+
+static h2d_active g_active;
+static float   g_act_delta[ACT_TW * ACT_TH];
+static uint8_t g_act_quiet[ACT_TW * ACT_TH];
+static uint8_t g_act_changed[ACT_TW * ACT_TH];
+
+static void active_reset() {
+    h2d_active_init(&g_active, SIM_W, SIM_H, ACTIVE_TILE, ACTIVE_TOL, ACTIVE_QUIET,
+                    g_act_delta, g_act_quiet, g_act_changed);
+}
+
+static void active_band(uint32_t cpu) {
+    uint32_t ty0 = ACT_TH * cpu / g_smp.ncpus;
+    uint32_t ty1 = ACT_TH * (cpu + 1) / g_smp.ncpus;
+    h2d_plate_active_advance_q(&k_plate, &g_active, g_field, g_next, g_tb_scratch[cpu][0],
+                               g_tb_scratch[cpu][1], TB_TILE_ROWS, ty0, ty1, k_tb_steps, &g_disp);
+}
+
+static uint32_t g_boot_sense = 0;
+
+// One pass of every core over its band: advance_band or active_band (K blocked
+// steps either way); the boot core's share runs between the barriers.
+static void step_cores(bool active) {
+    uint32_t y0, y1;
+    cpu_band(0, y0, y1);
+
+    if (g_smp.ncpus > 1) smp_barrier(g_boot_sense); // secondaries pick up the current g_field/g_next
+    if (active) {
+        active_band(0);
+    } else {
+        advance_band(0, y0, y1, k_tb_steps);
     }
+    if (g_smp.ncpus > 1) smp_barrier(g_boot_sense); // every band of g_next is written
 
-    // heat source
-    stamp_disk(g_next, (int)SIM_W/2, (int)SIM_H/2, 7, 1.0f);
+    if (active) h2d_active_update(&g_active, g_next, g_field);
 
     // swap
-    for (uint32_t i = 0; i < SIM_W * SIM_H; i++) g_field[i] = g_next[i];
+    if (FIELD_FP16) {
+        h2d_half* htmp = g_hfield; g_hfield = g_hnext; g_hnext = htmp;
+        g_hstep += k_tb_steps;
+        return;
+    }
+    float* tmp = g_field; g_field = g_next; g_next = tmp;
 }
 
-static void render(uint32_t* fb, uint32_t palette_idx) {
-    constexpr uint32_t SCALE_X = FB_W / SIM_W; // 4
-    constexpr uint32_t SCALE_Y = FB_H / SIM_H; // 4
+// One ADI step: the disk is stamped first so its fixed cells hold the source
+// temperature, then rows and columns as above (the column half writes the edges).
+static void step_cores_adi() {
+    h2d_plate_stamp_disk(&k_plate, g_field, 0, 0, SIM_H, k_plate.src_x, k_plate.src_y,
+                         k_plate.src_r, k_plate.src_temp);
 
-    for (uint32_t y = 0; y < SIM_H; y++) {
-        for (uint32_t x = 0; x < SIM_W; x++) {
-            float t = g_field[y * SIM_W + x];
-            uint32_t pi = (uint32_t)(t * 255.0f);
-            if (pi > 255) pi = 255;
-            uint32_t color = g_lut[palette_idx][pi];
+    if (g_smp.ncpus > 1) smp_barrier(g_boot_sense); // secondaries pick up the current g_field/g_next
+    adi_rows(0);
+    if (g_smp.ncpus > 1) smp_barrier(g_boot_sense); // every row of g_next holds the column right-hand side
+    adi_cols(0);
+    if (g_smp.ncpus > 1) smp_barrier(g_boot_sense); // every column is solved, edges included
 
-            uint32_t base_y = y * SCALE_Y;
-            uint32_t base_x = x * SCALE_X;
+    float* tmp = g_field; g_field = g_next; g_next = tmp;
+}
 
-            for (uint32_t dy = 0; dy < SCALE_Y; dy++) {
-                uint32_t* row = fb + (base_y + dy) * FB_W + base_x;
-                for (uint32_t dx = 0; dx < SCALE_X; dx++) {
-                    row[dx] = color;
-                }
+// One spectral jump, in place on g_field; the boot core clamps, zeroes the
+// edges and stamps the disk at the end.
+static void step_cores_spectral() {
+    for (uint32_t phase = 0; phase < 4; phase++) {
+        if (g_smp.ncpus > 1) smp_barrier(g_boot_sense); // the previous phase is complete everywhere
+        spectral_phase(0, phase);
+    }
+    if (g_smp.ncpus > 1) smp_barrier(g_boot_sense);
+    h2d_spec_finish(&g_spec, g_field, 0, SIM_H);
+}
+
+static void step_sim() {
+    if (SPECTRAL_STEPS) {
+        step_cores_spectral();
+    } else if (ADI_STEPS) {
+        step_cores_adi();
+    } else if (ACTIVE_TILES) {
+        step_cores(true);
+    } else {
+        step_cores(false);
+    }
+}
+
+// Secondary cores: compute their row band each time the boot core enters step_sim.
+extern "C" void secondary_main(uint64_t cpu) {
+    __atomic_add_fetch(&g_smp.online, 1u, __ATOMIC_ACQ_REL);
+    while (!__atomic_load_n(&g_smp.released, __ATOMIC_ACQUIRE)) {
+        asm volatile("wfe" ::: "memory");
+    }
+
+    uint32_t sense = 0;
+    uint32_t y0, y1;
+    cpu_band((uint32_t)cpu, y0, y1);
+    for (;;) {
+        smp_barrier(sense);
+        if (SPECTRAL_STEPS) {
+            for (uint32_t phase = 0; phase < 4; phase++) {
+                if (phase > 0) smp_barrier(sense);
+                spectral_phase((uint32_t)cpu, phase);
             }
+        } else if (ADI_STEPS) {
+            adi_rows((uint32_t)cpu);
+            smp_barrier(sense);
+            adi_cols((uint32_t)cpu);
+        } else if (ACTIVE_TILES) {
+            active_band((uint32_t)cpu);
+        } else {
+            advance_band((uint32_t)cpu, y0, y1, k_tb_steps);
         }
+        smp_barrier(sense);
     }
 }
 
+/* ------------------------- Incremental renderer ------------------------- */
+// render() only rewrites the 4x4 pixel blocks whose LUT index changed since they
+// were last drawn, and reports what it touched as one dirty rectangle per band of
+// DIRTY_BAND_ROWS simulation rows; their area is what the frame cost the
+// framebuffer, summed for the periodic report. It reads g_disp, one byte per cell, and
+// skips the rows whose indices did not change. With the explicit steps, fp32
+// or fp16, active tiles or not (DISPLAY_FUSED), the stencil has already filled
+// it; otherwise render() first quantizes every row of g_field.
+static constexpr uint32_t SCALE_X = FB_W / SIM_W; // 4
+static constexpr uint32_t SCALE_Y = FB_H / SIM_H; // 4
+
+static constexpr uint32_t DIRTY_BAND_ROWS = 10;
+static constexpr uint32_t DIRTY_MAX_RECTS = (SIM_H + DIRTY_BAND_ROWS - 1) / DIRTY_BAND_ROWS;
+
+static h2d_rect g_dirty[DIRTY_MAX_RECTS];     // framebuffer pixels, half-open
+
+static uint8_t  g_drawn[SIM_W * SIM_H];     // LUT index currently on screen per cell
+static uint32_t g_drawn_pal = 0xFFFFFFFFu;  // palette of g_drawn; a mismatch redraws all
+
+static constexpr bool DISPLAY_FUSED = !ADI_STEPS && !SPECTRAL_STEPS;
+
+// Returns the framebuffer pixels covered by the dirty rectangles.
+static uint64_t render(uint32_t* fb, uint32_t palette_idx) {
+    bool full = (palette_idx != g_drawn_pal);
+    g_drawn_pal = palette_idx;
+
+    if (!DISPLAY_FUSED) h2d_display_rows(&g_disp, g_field, 0, SIM_H);
+
+    const h2d_surface surface = { fb, FB_W, SCALE_X, SCALE_Y };
+    uint32_t n = h2d_render_display_rows(&g_disp, g_lut[palette_idx], g_drawn, full, &surface,
+                                         DIRTY_BAND_ROWS, g_dirty, 0, SIM_H);
+    uint64_t px = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        px += (uint64_t)(g_dirty[i].x1 - g_dirty[i].x0) * (g_dirty[i].y1 - g_dirty[i].y0);
+    }
+    return px;
+}
+
+/* ------------------------- Frame pacing ------------------------- */
+// Each frame has a fixed CNTPCT deadline (FRAME_HZ). The boot core runs as many
+// step_sim() calls as fit before it, keeping room for one render(), presents, and
+// sleeps until the deadline. Step and render costs are tracked as running
+// averages of measured ticks. A frame always gets at least one step, so a solver
+// slower than the frame budget lowers the display rate rather than stalling the
+// sim; an overrun restarts the schedule from now instead of bursting.
+#ifndef FRAME_HZ
+#define FRAME_HZ 60
+#endif
+#ifndef FRAME_MAX_STEPS
+#define FRAME_MAX_STEPS 256
+#endif
+
+struct FramePacer {
+    uint64_t frame_ticks;
+    uint64_t deadline;
+    uint64_t step_est;    // ticks per step_sim(), running average
+    uint64_t render_est;  // ticks per render(), running average
+    uint64_t steps;       // since the last report
+    uint64_t dirty_px;    // framebuffer pixels rewritten since the last report
+};
+
+static inline uint64_t pacer_average(uint64_t est, uint64_t sample) {
+    return est ? est - est / 8 + sample / 8 : sample;
+}
+
+static void pacer_init(FramePacer& p) {
+    p.frame_ticks = read_cntfrq_el0() / FRAME_HZ;
+    p.deadline    = read_cntpct_el0() + p.frame_ticks;
+    p.step_est    = 0;
+    p.render_est  = 0;
+    p.steps       = 0;
+    p.dirty_px    = 0;
+}
+
+static void pacer_frame(FramePacer& p, uint32_t* fb, uint32_t pal) {
+    uint64_t now = read_cntpct_el0();
+    for (uint32_t n = 0; n < FRAME_MAX_STEPS; n++) {
+        // the margin of one extra step absorbs jitter in the estimates
+        if (n > 0 && now + 2 * p.step_est + p.render_est > p.deadline) break;
+        step_sim();
+        uint64_t t = read_cntpct_el0();
+        p.step_est = pacer_average(p.step_est, t - now);
+        now = t;
+        p.steps++;
+    }
+
+    p.dirty_px += render(fb, pal);
+    uint64_t t = read_cntpct_el0();
+    p.render_est = pacer_average(p.render_est, t - now);
+
+    if (t < p.deadline) {
+        sleep_until(p.deadline);
+        p.deadline += p.frame_ticks;
+    } else {
+        p.deadline = t + p.frame_ticks; // overran: drop the missed slot
+    }
+}
+
+/* ------------------------- Benchmarks ------------------------- */
+#if defined(HEAT2D_BENCH)
+// Build with BENCH=1 ./compile.sh: main() times the hot loops once at boot and
+// prints BENCH lines (see bench/bench.h) before the demo starts.
+#ifndef BENCH_WARMUP
+#define BENCH_WARMUP 10
+#endif
+#ifndef BENCH_ITERS
+#define BENCH_ITERS 100
+#endif
+
+static uint32_t* g_bench_fb;
+
+static void bench_step_sim(void*)    { step_sim(); }
+static void bench_build_luts(void*)  { build_luts(); }
+static void bench_render_full(void*) { g_drawn_pal = 0xFFFFFFFFu; render(g_bench_fb, 0); }
+static void bench_step_render(void*) { step_sim(); render(g_bench_fb, 0); }
+
+static void run_benchmarks(uint32_t* fb) {
+    g_bench_fb = fb;
+    const uint64_t cells = (uint64_t)SIM_W * SIM_H;
+
+    const bench_case cases[] = {
+        { "build_luts",  bench_build_luts,  nullptr, BENCH_WARMUP, BENCH_ITERS, 3 * 256, "entries/s" },
+        { "step_sim",    bench_step_sim,    nullptr, BENCH_WARMUP, BENCH_ITERS, cells * (SPECTRAL_STEPS ? SPECTRAL_STEPS : ADI_STEPS ? ADI_STEPS : k_tb_steps),
+          "cells/s" },
+        { "render_full", bench_render_full, nullptr, BENCH_WARMUP, BENCH_ITERS, cells, "cells/s" },
+        // one step + present: what a frame of the demo costs once the plate is warm
+        { "step_render", bench_step_render, nullptr, BENCH_WARMUP, BENCH_ITERS, cells, "cells/s" },
+    };
+
+    uart_puts("BENCHCFG cpus=");
+    bench_put_u64(uart_puts, g_smp.ncpus);
+    uart_puts(" tb_steps=");
+    bench_put_u64(uart_puts, k_tb_steps);
+    uart_puts("\n");
+    for (const bench_case& c : cases) bench_run(&c, uart_puts);
+
+    reset_field();
+}
+#endif
+
 /* ------------------------- Main ------------------------- */
 extern "C" int main(void) {
     uart_puts("\n=== Heat2D on QEMU virt via ramfb (800x600) ===\n");
@@ -397,9 +964,8 @@ extern "C" int main(void) {
     uart_hex32(ramfb_size);
     uart_puts("\n");
 
-    // Framebuffer placed right after .bss
-    uintptr_t fb_addr = (uintptr_t)__bss_end__;
-    fb_addr = (fb_addr + 0xFFFu) & ~0xFFFu; // 4K align
+    // Framebuffer: the 2 MiB block after .bss that start.S maps non-cacheable
+    uintptr_t fb_addr = (uintptr_t)__fb_start__;
 
     uart_puts("Framebuffer addr = "); uart_hex64((uint64_t)fb_addr); uart_puts("\n");
 
@@ -425,21 +991,38 @@ extern "C" int main(void) {
 
     build_luts();
     reset_field();
+    if (SPECTRAL_STEPS) spectral_init();
+    smp_start_secondaries();
+
+#if defined(HEAT2D_BENCH)
+    run_benchmarks(fb);
+#endif
+
+    g_timer_wfi = gic_init_timer_wakeup();
+    uart_puts(g_timer_wfi ? "Frame pacing: CNTP + wfi\n"
+                          : "Frame pacing: no GICv2, busy-wait\n");
 
     uart_puts("virt ramfb init OK, rendering Heat2D...\n");
 
     uint32_t pal = 0;
     uint32_t frame = 0;
 
+    FramePacer pacer;
+    pacer_init(pacer);
+
     while (1) {
-        step_sim();
-        render(fb, pal);
+        pacer_frame(pacer, fb, pal);
 
         frame++;
-        if ((frame % 600) == 0) { // roughly every ~10s at ~60fps-ish
+        if ((frame % (10 * FRAME_HZ)) == 0) { // every 10 s
             pal = (pal + 1) % 3;
+            uart_puts("steps/frame over last 10 s: ");
+            uart_hex32((uint32_t)(pacer.steps / (10 * FRAME_HZ)));
+            uart_puts(", dirty px/frame: ");
+            uart_hex32((uint32_t)(pacer.dirty_px / (10 * FRAME_HZ)));
+            uart_puts("\n");
+            pacer.steps = 0;
+            pacer.dirty_px = 0;
         }
-
-        delay_ms(16);
     }
 }
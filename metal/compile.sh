@@ -1,11 +1,16 @@
 rm -f *.o kernel.elf kernel8.img
 
+# BENCH=1 ./compile.sh builds a kernel that prints BENCH timing lines at boot
+BENCH_FLAGS=""
+if [ -n "$BENCH" ]; then BENCH_FLAGS="-DHEAT2D_BENCH"; fi
+
 aarch64-linux-gnu-gcc -c -O2 -ffreestanding -nostdlib -nostartfiles start.S -o start.o
 
-aarch64-linux-gnu-g++ -c -O2 -std=gnu++17 \
+# -ffp-contract=off keeps the core's scalar and NEON stencils bit-identical
+aarch64-linux-gnu-g++ -c -O2 -std=gnu++17 -ffp-contract=off \
   -ffreestanding -fno-exceptions -fno-rtti \
-  -fno-stack-protector -fno-pic -fno-pie \
-  -nostdlib -nostartfiles \
+  -fno-stack-protector -fno-pic -fno-pie -mno-outline-atomics \
+  -nostdlib -nostartfiles $BENCH_FLAGS \
   Heat2D_ramfb.cpp -o Heat2D_ramfb.o
 
 aarch64-linux-gnu-ld -T link.ld -o kernel.elf start.o Heat2D_ramfb.o
@@ -1,5 +1,5 @@
 qemu-system-aarch64 -accel tcg \
-  -M virt -cpu cortex-a76 -m 2048 \
+  -M virt,gic-version=2 -cpu cortex-a76 -m 2048 -smp 4 \
   -vga none -device ramfb \
   -display sdl \
   -serial stdio -monitor none \
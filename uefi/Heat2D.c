@@ -5,18 +5,30 @@
 #include <Library/UefiApplicationEntryPoint.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/PrintLib.h>
+#include <Library/TimerLib.h>
+#include <Library/DxeServicesTableLib.h>
+#include <Library/SynchronizationLib.h>
 
 #include <Protocol/GraphicsOutput.h>
 #include <Protocol/SimplePointer.h>
 #include <Protocol/AbsolutePointer.h>
+#include <Protocol/MpService.h>
+
+#include "../core/heat2d_conduct.h"
+#include "../core/heat2d_multigrid.h"
+#include "../core/heat2d_adi.h"
+#include "../core/heat2d_half.h"
+#include "../core/heat2d_display.h"
+#include "../core/heat2d_render.h"
 
 typedef enum {
-  BC_DIRICHLET_COLD = 0,   // fixed cold edges (0)
-  BC_NEUMANN_INSULATED,    // zero-flux edges
-  BC_MIXED,                // left/right cold, top/bottom insulated
-  BC_COUNT
+  BC_DIRICHLET_COLD    = H2D_BC_DIRICHLET_COLD,   // fixed cold edges (0)
+  BC_NEUMANN_INSULATED = H2D_BC_NEUMANN_INSULATED, // zero-flux edges
+  BC_MIXED             = H2D_BC_MIXED,            // left/right cold, top/bottom insulated
+  BC_COUNT             = H2D_BC_COUNT
 } BOUNDARY_MODE;
 
 typedef struct {
@@ -24,11 +36,7 @@ typedef struct {
   EFI_PIXEL_BITMASK         Masks;  // only used when Fmt == PixelBitMask
 } PIXEL_PACKER;
 
-typedef struct {
-  UINT8 r, g, b;
-} RGB8;
-
-STATIC RGB8 gColorLut[256];
+STATIC h2d_rgb8 gColorLut[256];
 
 // -------------------- Basic helpers --------------------
 STATIC float ClampF32(float v, float lo, float hi) {
@@ -95,25 +103,13 @@ STATIC BOOLEAN TryReadKey(EFI_SYSTEM_TABLE *SystemTable, EFI_INPUT_KEY *OutKey)
 }
 
 // -------------------- Color palettes + LUT --------------------
-typedef struct {
-  float t;
-  UINT8 r, g, b;
-} COLOR_STOP;
-
 typedef struct {
   const CHAR8    *Name;
-  const COLOR_STOP *Stops;
+  const h2d_color_stop *Stops;
   UINTN           StopCount;
 } COLOR_PALETTE;
 
-STATIC UINT8 LerpU8(UINT8 a, UINT8 b, float t) {
-  float x = (1.0f - t) * (float)a + t * (float)b;
-  if (x < 0) x = 0;
-  if (x > 255) x = 255;
-  return (UINT8)(x + 0.5f);
-}
-
-STATIC CONST COLOR_STOP gViridisStops[] = {
+STATIC CONST h2d_color_stop gViridisStops[] = {
   {0.00f,  68,  1,  84},
   {0.25f,  59, 82, 139},
   {0.50f,  33,145, 140},
@@ -121,7 +117,7 @@ STATIC CONST COLOR_STOP gViridisStops[] = {
   {1.00f, 253,231,  37},
 };
 
-STATIC CONST COLOR_STOP gInfernoStops[] = {
+STATIC CONST h2d_color_stop gInfernoStops[] = {
   {0.00f,   0,  0,   4},
   {0.25f,  87, 15, 109},
   {0.50f, 187, 55,  84},
@@ -129,7 +125,7 @@ STATIC CONST COLOR_STOP gInfernoStops[] = {
   {1.00f, 252,255, 164},
 };
 
-STATIC CONST COLOR_STOP gCoolWarmStops[] = {
+STATIC CONST h2d_color_stop gCoolWarmStops[] = {
   {0.00f,  59,  76, 192},
   {0.25f,  94,131, 199},
   {0.50f, 186,186, 186},
@@ -144,120 +140,67 @@ STATIC CONST COLOR_PALETTE gPalettes[] = {
 };
 
 STATIC VOID BuildPaletteLut(const COLOR_PALETTE *Pal) {
-  if (!Pal || Pal->StopCount < 2) return;
-  for (INT32 i = 0; i < 256; i++) {
-    float t = (float)i / 255.0f;
-
-    INT32 k = 0;
-    while (k < (INT32)Pal->StopCount - 2 && t > Pal->Stops[k+1].t) k++;
-
-    float t0 = Pal->Stops[k].t;
-    float t1 = Pal->Stops[k+1].t;
-    float u = (t1 > t0) ? ((t - t0) / (t1 - t0)) : 0.0f;
-    u = ClampF32(u, 0.0f, 1.0f);
-
-    gColorLut[i].r = LerpU8(Pal->Stops[k].r, Pal->Stops[k+1].r, u);
-    gColorLut[i].g = LerpU8(Pal->Stops[k].g, Pal->Stops[k+1].g, u);
-    gColorLut[i].b = LerpU8(Pal->Stops[k].b, Pal->Stops[k+1].b, u);
-  }
+  if (!Pal) return;
+  h2d_build_palette_lut(Pal->Stops, (UINT32)Pal->StopCount, gColorLut);
 }
 
-STATIC VOID TempToRGB_LUT(float t, UINT8 *r, UINT8 *g, UINT8 *b) {
+STATIC INT32 TempBucket(float t) {
   t = ClampF32(t, 0.0f, 1.0f);
-  INT32 idx = (INT32)(t * 255.0f + 0.5f);
-  idx = ClampI32(idx, 0, 255);
-  *r = gColorLut[idx].r;
-  *g = gColorLut[idx].g;
-  *b = gColorLut[idx].b;
-}
-
-// -------------------- Physics: face conductivity --------------------
-STATIC float KFaceHarmonic(float k0, float k1) {
-  const float eps = 1e-12f;
-  float denom = k0 + k1;
-  if (denom < eps) return 0.0f;
-  return (2.0f * k0 * k1) / denom;
-}
-
-// -------------------- Simulation helpers --------------------
-STATIC VOID ApplyBoundary(float *T, INT32 NX, INT32 NY, BOUNDARY_MODE Mode) {
-  if (Mode == BC_DIRICHLET_COLD) {
-    for (INT32 i = 0; i < NX; i++) {
-      T[i] = 0.0f;
-      T[(NY-1)*NX + i] = 0.0f;
-    }
-    for (INT32 j = 0; j < NY; j++) {
-      T[j*NX] = 0.0f;
-      T[j*NX + (NX-1)] = 0.0f;
-    }
-    return;
-  }
-
-  if (Mode == BC_NEUMANN_INSULATED) {
-    for (INT32 i = 1; i < NX-1; i++) {
-      T[0*NX + i]      = T[1*NX + i];
-      T[(NY-1)*NX + i] = T[(NY-2)*NX + i];
-    }
-    for (INT32 j = 1; j < NY-1; j++) {
-      T[j*NX + 0]      = T[j*NX + 1];
-      T[j*NX + (NX-1)] = T[j*NX + (NX-2)];
-    }
-    T[0] = T[1*NX + 1];
-    T[NX-1] = T[1*NX + (NX-2)];
-    T[(NY-1)*NX] = T[(NY-2)*NX + 1];
-    T[(NY-1)*NX + (NX-1)] = T[(NY-2)*NX + (NX-2)];
-    return;
-  }
-
-  // BC_MIXED
-  for (INT32 j = 0; j < NY; j++) {
-    T[j*NX + 0] = 0.0f;
-    T[j*NX + (NX-1)] = 0.0f;
-  }
-  for (INT32 i = 1; i < NX-1; i++) {
-    T[0*NX + i]      = T[1*NX + i];
-    T[(NY-1)*NX + i] = T[(NY-2)*NX + i];
-  }
-  T[0] = 0.0f;
-  T[NX-1] = 0.0f;
-  T[(NY-1)*NX] = 0.0f;
-  T[(NY-1)*NX + (NX-1)] = 0.0f;
+  return ClampI32((INT32)(t * 255.0f + 0.5f), 0, 255);
 }
 
-STATIC VOID StampDisk(float *T, INT32 NX, INT32 NY, INT32 cx, INT32 cy, INT32 rad, float val) {
-  INT32 r2 = rad * rad;
-  INT32 y0 = ClampI32(cy - rad, 0, NY-1);
-  INT32 y1 = ClampI32(cy + rad, 0, NY-1);
-  INT32 x0 = ClampI32(cx - rad, 0, NX-1);
-  INT32 x1 = ClampI32(cx + rad, 0, NX-1);
+// -------------------- Packed cell colors --------------------
+// Final framebuffer pixel per [material][temperature bucket]: palette color,
+// material tint and GOP packing folded together, so drawing a cell is one table
+// load whatever the pixel format. The HUD's colors (legend gradient, panel,
+// text, footer, cursor) are packed alongside, so no frame calls PackPixel.
+// Rebuilt on palette change ((MAT_COUNT + 1) * 256 + 6 PackPixel calls).
+#define MAT_COUNT  H2D_HEATSINK_MAT_COUNT   // 0 air, 1 copper (h2d_build_heatsink)
 
-  for (INT32 j = y0; j <= y1; j++) {
-    INT32 dy = j - cy;
-    for (INT32 i = x0; i <= x1; i++) {
-      INT32 dx = i - cx;
-      if (dx*dx + dy*dy <= r2) {
-        float *p = &T[j*NX + i];
-        if (val > *p) *p = val;
-      }
-    }
+STATIC UINT32 gCellPixelLut[MAT_COUNT][256];
+
+typedef struct {
+  UINT32 Legend[256];   // untinted palette color per temperature bucket
+  UINT32 Panel;
+  UINT32 Border;
+  UINT32 Text;
+  UINT32 FooterBg;
+  UINT32 Cursor;
+  UINT32 Black;
+} HUD_PIXELS;
+
+STATIC HUD_PIXELS gHudPixels;
+
+STATIC VOID TintMaterial(UINT8 Mat, UINT8 *r, UINT8 *g, UINT8 *b) {
+  // Visual tint so comb reads as copper
+  if (Mat == 1) {
+    *r = (UINT8)ClampI32((INT32)*r + 10, 0, 255);
+    *g = (UINT8)((UINT32)*g * 240u / 255u);
+    *b = (UINT8)((UINT32)*b * 220u / 255u);
+  } else {
+    *r = (UINT8)((UINT32)*r * 230u / 255u);
+    *g = (UINT8)((UINT32)*g * 230u / 255u);
+    *b = (UINT8)((UINT32)*b * 230u / 255u);
   }
 }
 
-STATIC VOID StampRectMax(float *T, INT32 NX, INT32 NY, INT32 x0, INT32 y0, INT32 w, INT32 h, float val) {
-  INT32 x1 = x0 + w - 1;
-  INT32 y1 = y0 + h - 1;
-
-  x0 = ClampI32(x0, 0, NX-1);
-  y0 = ClampI32(y0, 0, NY-1);
-  x1 = ClampI32(x1, 0, NX-1);
-  y1 = ClampI32(y1, 0, NY-1);
-
-  for (INT32 y = y0; y <= y1; y++) {
-    float *row = &T[y*NX];
-    for (INT32 x = x0; x <= x1; x++) {
-      if (val > row[x]) row[x] = val;
+STATIC VOID BuildCellPixelLut(const PIXEL_PACKER *Packer) {
+  for (UINT8 m = 0; m < MAT_COUNT; m++) {
+    for (UINTN i = 0; i < 256; i++) {
+      UINT8 r = gColorLut[i].r, g = gColorLut[i].g, b = gColorLut[i].b;
+      TintMaterial(m, &r, &g, &b);
+      gCellPixelLut[m][i] = PackPixel(Packer, r, g, b);
     }
   }
+  for (UINTN i = 0; i < 256; i++) {
+    gHudPixels.Legend[i] = PackPixel(Packer, gColorLut[i].r, gColorLut[i].g, gColorLut[i].b);
+  }
+  gHudPixels.Panel    = PackPixel(Packer, 20, 20, 20);
+  gHudPixels.Border   = PackPixel(Packer, 220, 220, 220);
+  gHudPixels.Text     = PackPixel(Packer, 240, 240, 240);
+  gHudPixels.FooterBg = PackPixel(Packer, 10, 10, 10);
+  gHudPixels.Cursor   = PackPixel(Packer, 255, 255, 255);
+  gHudPixels.Black    = PackPixel(Packer, 0, 0, 0);
 }
 
 // -------------------- Framebuffer drawing --------------------
@@ -274,9 +217,45 @@ STATIC VOID DrawRect(UINT32 *Fb, UINTN Width, UINTN Height, UINTN Ppsl,
   }
 }
 
+// The cell rows of the display plane that are flagged (all of them when Full),
+// each cell cellW x cellH pixels, clipped to drawW x drawH; their flags are
+// cleared and [*J0, *J1) spans the rows drawn (empty when equal). One scanline
+// per simulation row is expanded into Line (cacheable, drawW pixels) and then
+// copied to the cellH framebuffer rows it covers, so the framebuffer only ever
+// sees long sequential writes.
+STATIC VOID DrawFieldScanlines(UINT32 *Fb, UINTN Ppsl, UINT32 *Line,
+                               h2d_display *Disp, const UINT8 *Mat, BOOLEAN Full,
+                               UINTN cellW, UINTN cellH, UINTN drawW, UINTN drawH,
+                               INT32 *J0, INT32 *J1) {
+  INT32 NX = (INT32)Disp->w;
+  *J0 = *J1 = 0;
+  for (INT32 j = 0; j < (INT32)Disp->h; j++) {
+    UINTN y0 = (UINTN)j * cellH;
+    if (y0 >= drawH) break;
+    if (!Full && !Disp->rows[j]) continue;
+    Disp->rows[j] = 0;
+    if (*J0 == *J1) *J0 = j;
+    *J1 = j + 1;
+
+    const UINT8 *QRow   = Disp->idx + j*NX;
+    const UINT8 *MatRow = Mat + j*NX;
+    UINTN x = 0;
+    for (INT32 i = 0; i < NX && x < drawW; i++) {
+      UINT32 px = gCellPixelLut[MatRow[i]][QRow[i]];
+      UINTN x1 = x + cellW; if (x1 > drawW) x1 = drawW;
+      for (; x < x1; x++) Line[x] = px;
+    }
+
+    UINTN y1 = y0 + cellH; if (y1 > drawH) y1 = drawH;
+    for (UINTN y = y0; y < y1; y++) {
+      CopyMem(Fb + y * Ppsl, Line, drawW * sizeof(UINT32));
+    }
+  }
+}
+
 STATIC VOID DrawCursor(UINT32 *Fb, UINTN Width, UINTN Height, UINTN Ppsl,
-                       UINTN x, UINTN y, const PIXEL_PACKER *Packer) {
-  UINT32 w = PackPixel(Packer, 255, 255, 255);
+                       UINTN x, UINTN y, const HUD_PIXELS *Hud) {
+  UINT32 w = Hud->Cursor;
   DrawRect(Fb, Width, Height, Ppsl, (x > 2 ? x - 2 : 0), y, 5, 1, w);
   DrawRect(Fb, Width, Height, Ppsl, x, (y > 2 ? y - 2 : 0), 1, 5, w);
 }
@@ -374,7 +353,7 @@ STATIC VOID DrawString8(UINT32 *Fb, UINTN Width, UINTN Height, UINTN Ppsl,
   }
 }
 
-STATIC VOID DrawFooter(UINT32 *Fb, UINTN Width, UINTN Height, UINTN Ppsl, const PIXEL_PACKER *Packer) {
+STATIC VOID DrawFooter(UINT32 *Fb, UINTN Width, UINTN Height, UINTN Ppsl, const HUD_PIXELS *Hud) {
   const CHAR8 *msg = "Dec 27, 2025 - Bare Metal Parabolic PDE Solver";
 
   UINTN padX = 12;
@@ -384,15 +363,15 @@ STATIC VOID DrawFooter(UINT32 *Fb, UINTN Width, UINTN Height, UINTN Ppsl, const
   if (Height < boxH + 2) return;
 
   UINTN y0 = Height - boxH;
-  UINT32 bg = PackPixel(Packer, 10, 10, 10);
-  UINT32 fg = PackPixel(Packer, 240, 240, 240);
+  UINT32 bg = Hud->FooterBg;
+  UINT32 fg = Hud->Text;
 
   DrawRect(Fb, Width, Height, Ppsl, 0, y0, Width, boxH, bg);
   DrawString8(Fb, Width, Height, Ppsl, padX, y0 + padY, msg, fg, bg, FALSE);
 }
 
 STATIC VOID DrawLegendWithLabels(UINT32 *Fb, UINTN Width, UINTN Height, UINTN Ppsl,
-                                 const PIXEL_PACKER *Packer, const CHAR8 *PaletteName) {
+                                 const HUD_PIXELS *Hud, const CHAR8 *PaletteName) {
   UINTN barW = (Width > 200) ? 24 : 16;
   UINTN barH = (Height > 240) ? (Height / 2) : (Height * 2 / 3);
 
@@ -411,16 +390,15 @@ STATIC VOID DrawLegendWithLabels(UINT32 *Fb, UINTN Width, UINTN Height, UINTN Pp
   UINTN panelW = barW + 12 + labelW + 12;
   UINTN panelH = barH + 12 + 10;
 
-  UINT32 panel  = PackPixel(Packer, 20, 20, 20);
-  UINT32 border = PackPixel(Packer, 220, 220, 220);
-  UINT32 text   = PackPixel(Packer, 240, 240, 240);
+  UINT32 panel  = Hud->Panel;
+  UINT32 border = Hud->Border;
+  UINT32 text   = Hud->Text;
 
   DrawRect(Fb, Width, Height, Ppsl, panelX, panelY, panelW, panelH, panel);
 
   for (UINTN y = 0; y < barH; y++) {
     float t = 1.0f - (float)y / (float)((barH > 1) ? (barH - 1) : 1);
-    UINT8 r,g,b; TempToRGB_LUT(t, &r, &g, &b);
-    UINT32 px = PackPixel(Packer, r, g, b);
+    UINT32 px = Hud->Legend[TempBucket(t)];
     DrawRect(Fb, Width, Height, Ppsl, x0, y0 + y, barW, 1, px);
   }
 
@@ -443,6 +421,131 @@ STATIC VOID DrawLegendWithLabels(UINT32 *Fb, UINTN Width, UINTN Height, UINTN Pp
   }
 }
 
+// -------------------- Presentation (back buffer) --------------------
+// Everything is drawn into a cacheable Width x Height back buffer (pitch Width)
+// and the rows touched since the last frame are pushed to the display in one
+// go, so the GOP framebuffer only sees large sequential writes and never a
+// half-drawn frame with the HUD missing. Two ways to push, picked at startup by
+// timing full-frame presents:
+//   PRESENT_BLT   Gop->Blt(EfiBltBufferToVideo); back buffer in BLT pixel order,
+//                 the GOP driver converts. Also covers PixelBltOnly modes.
+//   PRESENT_COPY  CopyMem straight into the framebuffer, after asking the DXE
+//                 services to map it write-combining; back buffer in native order.
+typedef enum {
+  PRESENT_BLT = 0,
+  PRESENT_COPY
+} PRESENT_PATH;
+
+typedef struct {
+  EFI_GRAPHICS_OUTPUT_PROTOCOL *Gop;
+  PRESENT_PATH Path;
+  UINT32  *Back;
+  UINT32  *Fb;          // NULL when the mode has no linear framebuffer
+  UINTN    Width, Height, Ppsl;
+  UINTN    DirtyY0, DirtyY1;   // rows to present, half-open; empty when equal
+
+  BOOLEAN  WcSet;              // framebuffer attributes changed, restore on exit
+  EFI_PHYSICAL_ADDRESS WcBase;
+  UINT64   WcLength;
+  UINT64   WcOldAttributes;
+} PRESENTER;
+
+STATIC VOID MarkRows(PRESENTER *P, UINTN y0, UINTN y1) {
+  if (y1 > P->Height) y1 = P->Height;
+  if (y0 >= y1) return;
+  if (P->DirtyY0 == P->DirtyY1) {
+    P->DirtyY0 = y0;
+    P->DirtyY1 = y1;
+    return;
+  }
+  if (y0 < P->DirtyY0) P->DirtyY0 = y0;
+  if (y1 > P->DirtyY1) P->DirtyY1 = y1;
+}
+
+STATIC VOID PresentRows(PRESENTER *P, PRESENT_PATH Path, UINTN y0, UINTN y1) {
+  if (Path == PRESENT_BLT) {
+    P->Gop->Blt(P->Gop, (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)P->Back, EfiBltBufferToVideo,
+                0, y0, 0, y0, P->Width, y1 - y0, P->Width * sizeof(UINT32));
+  } else if (P->Ppsl == P->Width) {
+    CopyMem(P->Fb + y0 * P->Width, P->Back + y0 * P->Width, (y1 - y0) * P->Width * sizeof(UINT32));
+  } else {
+    for (UINTN y = y0; y < y1; y++) {
+      CopyMem(P->Fb + y * P->Ppsl, P->Back + y * P->Width, P->Width * sizeof(UINT32));
+    }
+  }
+}
+
+STATIC VOID Present(PRESENTER *P) {
+  if (P->DirtyY0 == P->DirtyY1) return;
+  PresentRows(P, P->Path, P->DirtyY0, P->DirtyY1);
+  P->DirtyY0 = P->DirtyY1 = 0;
+}
+
+// Remap the framebuffer write-combining through the GCD, if the platform
+// allows it. Stores then stream out in bursts instead of one bus write each.
+STATIC VOID TrySetFramebufferWc(PRESENTER *P) {
+  EFI_PHYSICAL_ADDRESS Base = P->Gop->Mode->FrameBufferBase & ~(EFI_PHYSICAL_ADDRESS)(EFI_PAGE_SIZE - 1);
+  UINT64 Length = ALIGN_VALUE(P->Gop->Mode->FrameBufferBase + P->Gop->Mode->FrameBufferSize - Base,
+                              EFI_PAGE_SIZE);
+
+  EFI_GCD_MEMORY_SPACE_DESCRIPTOR Desc;
+  if (EFI_ERROR(gDS->GetMemorySpaceDescriptor(Base, &Desc))) return;
+  if ((Desc.Capabilities & EFI_MEMORY_WC) == 0) return;
+  if ((Desc.Attributes & EFI_MEMORY_CACHETYPE_MASK) == EFI_MEMORY_WC) return;
+
+  UINT64 Attr = (Desc.Attributes & ~(UINT64)EFI_MEMORY_CACHETYPE_MASK) | EFI_MEMORY_WC;
+  if (EFI_ERROR(gDS->SetMemorySpaceAttributes(Base, Length, Attr))) return;
+
+  P->WcSet = TRUE;
+  P->WcBase = Base;
+  P->WcLength = Length;
+  P->WcOldAttributes = Desc.Attributes;
+}
+
+STATIC UINT64 TimePresentNs(PRESENTER *P, PRESENT_PATH Path) {
+  PresentRows(P, Path, 0, P->Height);   // warm up
+  UINT64 best = ~0ull;
+  for (UINTN n = 0; n < 4; n++) {
+    UINT64 t0 = GetPerformanceCounter();
+    PresentRows(P, Path, 0, P->Height);
+    UINT64 ns = GetTimeInNanoSecond(GetPerformanceCounter() - t0);
+    if (ns < best) best = ns;
+  }
+  return best;
+}
+
+// Allocate the back buffer and pick the present path (the back buffer is black,
+// so the timing runs are invisible).
+STATIC EFI_STATUS InitPresenter(PRESENTER *P, EFI_GRAPHICS_OUTPUT_PROTOCOL *Gop) {
+  EFI_GRAPHICS_OUTPUT_MODE_INFORMATION *Info = Gop->Mode->Info;
+  SetMem(P, sizeof(*P), 0);
+  P->Gop    = Gop;
+  P->Width  = Info->HorizontalResolution;
+  P->Height = Info->VerticalResolution;
+  P->Ppsl   = Info->PixelsPerScanLine;
+  P->Back   = AllocateZeroPool(sizeof(UINT32) * P->Width * P->Height);
+  if (!P->Back) return EFI_OUT_OF_RESOURCES;
+
+  P->Path = PRESENT_BLT;
+  if (Info->PixelFormat == PixelBltOnly || Gop->Mode->FrameBufferBase == 0) return EFI_SUCCESS;
+
+  P->Fb = (UINT32 *)(UINTN)Gop->Mode->FrameBufferBase;
+  TrySetFramebufferWc(P);
+  UINT64 bltNs  = TimePresentNs(P, PRESENT_BLT);
+  UINT64 copyNs = TimePresentNs(P, PRESENT_COPY);
+  if (copyNs < bltNs) P->Path = PRESENT_COPY;
+
+  Print(L"Present: %a (blt %lu us, copy %lu us%a)\n",
+        (P->Path == PRESENT_BLT) ? "Blt" : "copy", bltNs / 1000, copyNs / 1000,
+        P->WcSet ? ", write-combining" : "");
+  return EFI_SUCCESS;
+}
+
+STATIC VOID FreePresenter(PRESENTER *P) {
+  if (P->WcSet) gDS->SetMemorySpaceAttributes(P->WcBase, P->WcLength, P->WcOldAttributes);
+  if (P->Back) FreePool(P->Back);
+}
+
 // -------------------- Pointer handling --------------------
 typedef struct {
   BOOLEAN HasAbs;
@@ -559,116 +662,349 @@ STATIC BOOLEAN PollPointer(POINTER_STATE *P, UINTN Width, UINTN Height, BOOLEAN
   return moved || pressed;
 }
 
-// -------------------- Heatsink geometry (comb) --------------------
+// -------------------- Conduction step --------------------
+// The solver itself lives in core/heat2d_conduct.h. Temporal blocking: each
+// call advances K steps, stepping HEAT2D_TB_TILE_ROWS-row tiles plus a
+// (K-1)-row halo in a scratch pair; bit-identical to K single steps.
+#ifndef HEAT2D_TB_STEPS
+#define HEAT2D_TB_STEPS      1    // K at startup; 't' cycles it at runtime
+#endif
+#ifndef HEAT2D_TB_MAX_STEPS
+#define HEAT2D_TB_MAX_STEPS  8
+#endif
+#ifndef HEAT2D_TB_TILE_ROWS
+#define HEAT2D_TB_TILE_ROWS  32
+#endif
+
+#define HEAT2D_TB_SCRATCH_ROWS  (HEAT2D_TB_TILE_ROWS + 2 * (HEAT2D_TB_MAX_STEPS - 1))
+
+// Grid size; with MP services the step scales with the core count.
+#ifndef HEAT2D_GRID_NX
+#define HEAT2D_GRID_NX  260
+#endif
+#ifndef HEAT2D_GRID_NY
+#define HEAT2D_GRID_NY  220
+#endif
+
+// Active tiles ('a' toggles): only tiles whose neighbourhood changed by more
+// than HEAT2D_ACTIVE_TOL per step within the last HEAT2D_ACTIVE_QUIET rounds
+// are stepped and redrawn (core/heat2d_active.h), so the quiet air around the
+// comb stops costing anything. A round is one temporally blocked call of
+// tbSteps steps over the tile rows that hold an awake tile, so 't' and the
+// fused display plane work with active tiles too.
+#ifndef HEAT2D_ACTIVE_TILES
+#define HEAT2D_ACTIVE_TILES  1    // on at startup
+#endif
+#ifndef HEAT2D_ACTIVE_TILE
+#define HEAT2D_ACTIVE_TILE   16
+#endif
+#ifndef HEAT2D_ACTIVE_TOL
+#define HEAT2D_ACTIVE_TOL    1e-5f
+#endif
+#ifndef HEAT2D_ACTIVE_QUIET
+#define HEAT2D_ACTIVE_QUIET  32
+#endif
+
+// Steady state ('e'): solve straight for the field the stepping settles to
+// (core/heat2d_multigrid.h) instead of stepping tens of thousands of times.
+// The workspace, about 36 bytes per cell, is allocated on first use.
+#ifndef HEAT2D_STEADY_MAX_ITERS
+#define HEAT2D_STEADY_MAX_ITERS  200
+#endif
+#ifndef HEAT2D_STEADY_RTOL
+#define HEAT2D_STEADY_RTOL       1e-6f
+#endif
+
+// Implicit steps ('i' cycles off -> 10 -> 30 -> 100): each substep is one ADI
+// step (core/heat2d_adi.h) covering that many explicit steps of time, for long
+// transients. It steps the whole grid, so active tiles sit out while it is on.
+STATIC CONST UINT32 mAdiSteps[] = { 0, 10, 30, 100 };
+
+// Half storage ('h' toggles): the explicit steps run over fp16 copies of the
+// field (core/heat2d_half.h), streaming half the bytes; they compute in fp32 and
+// store with stochastic rounding, filling the display plane as they go. While
+// they run the half field is the field: A is narrowed into it once when they
+// start and widened back once when they stop, and in between only the rows
+// the brush touches and, for 'e', the whole field make the trip (exact for
+// values already stored as halves). Active tiles sit out, and ADI steps, when
+// on, stay fp32.
+#ifndef HEAT2D_FIELD_FP16
+#define HEAT2D_FIELD_FP16  0    // off at startup
+#endif
+
+// -------------------- Multi-core conduction (EFI_MP_SERVICES) --------------------
+// The rows are cut into one band per enabled CPU (h2d_conduct_band). Every CPU,
+// BSP included, claims bands off a shared counter until none are left, so a
+// slow or late AP just takes fewer. Bands read A and write disjoint rows of B,
+// so they need no locking. Each CPU has its own temporal-blocking scratch pair,
+// indexed by WhoAmI. Without the protocol, or without enabled APs, the step
+// runs on the BSP alone. An ADI step is two jobs: row bands, then column bands
+// (each column depends on every row); the first scratch of the pair holds the
+// row line or a column chunk.
 typedef struct {
-  INT32 baseX0, baseX1;
-  INT32 baseY0, baseY1;
-} HEATSINK_GEOM;
-
-STATIC VOID BuildHeatsinkCombMask(float *K, UINT8 *Mat, INT32 NX, INT32 NY, HEATSINK_GEOM *G) {
-  // V3: stronger contrast (1:100) feels more heatsink-like
-  const float k_air = 0.01f;  // solid air, low conduction
-  const float k_cu  = 1.00f;  // copper reference
-
-  // Fill air
-  for (INT32 j = 0; j < NY; j++) {
-    for (INT32 i = 0; i < NX; i++) {
-      Mat[j*NX + i] = 0;
-      K[j*NX + i] = k_air;
+  EFI_MP_SERVICES_PROTOCOL *Mp;   // NULL: single core
+  UINTN   CpuCount;               // all processors (scratch slots)
+  UINTN   Bands;                  // enabled processors
+  UINTN   Bsp;                    // BSP processor number
+  BOOLEAN Blocking;               // no WaitEvent support: BSP joins afterwards
+  EFI_EVENT Done;
+
+  float **Scratch;                // [CpuCount][2], all NULL if short of memory (one step per call)
+
+  // Current job
+  const h2d_conduct *Cond;
+  h2d_active *Act;                // set: one active-tile round of K steps over tile-row bands
+  const h2d_adi *Adi;             // set: one ADI half, rows or columns (AdiCols)
+  BOOLEAN AdiCols;
+  const float *A;
+  float *B;
+  h2d_display *Disp;              // A/B steps: LUT indices of B as it is stored; may be NULL
+  const h2d_half *HA;             // set: K steps of the half fields HA into HB instead
+  h2d_half *HB;                   // (quantized into Disp as well)
+  UINT32 Step;                    // HA/HB: step number of the first step (dither)
+  UINT32 K;
+  volatile UINT32 NextBand;
+} MP_SOLVER;
+
+STATIC VOID RunBands(MP_SOLVER *M, UINTN Cpu) {
+  while (TRUE) {
+    UINT32 band = InterlockedIncrement(&M->NextBand) - 1;
+    if (band >= M->Bands) break;
+    if (M->Adi) {
+      float *scratch = M->Scratch[Cpu * 2];
+      if (!M->AdiCols) {
+        int32_t y0, y1;
+        h2d_conduct_band(M->Cond->ny, (uint32_t)M->Bands, band, &y0, &y1);
+        h2d_adi_rows(M->Adi, M->A, M->B, y0, y1, scratch);
+      } else {
+        int32_t nx = M->Cond->nx, ny = M->Cond->ny;
+        h2d_adi_cols(M->Adi, M->B, (int32_t)((UINT64)nx * band / M->Bands),
+                     (int32_t)((UINT64)nx * (band + 1) / M->Bands),
+                     scratch, (nx * HEAT2D_TB_SCRATCH_ROWS) / ny);
+      }
+      continue;
+    }
+    if (M->Act) {
+      UINT32 th = M->Act->th;
+      h2d_conduct_active_advance_q(M->Cond, M->Act, M->A, M->B, M->Scratch[Cpu * 2],
+                                   M->Scratch[Cpu * 2 + 1], HEAT2D_TB_TILE_ROWS,
+                                   (UINT32)((UINT64)th * band / M->Bands),
+                                   (UINT32)((UINT64)th * (band + 1) / M->Bands), M->K, M->Disp);
+      continue;
+    }
+    int32_t y0, y1;
+    h2d_conduct_band(M->Cond->ny, (uint32_t)M->Bands, band, &y0, &y1);
+    if (M->HA) {
+      // the scratch pair holds half rows here, with room to spare
+      h2d_conduct_advance_hq(M->Cond, M->HA, M->HB, (h2d_half *)M->Scratch[Cpu * 2],
+                             (h2d_half *)M->Scratch[Cpu * 2 + 1], HEAT2D_TB_TILE_ROWS, y0, y1,
+                             M->K, M->Step, M->Disp);
+      continue;
     }
+    h2d_conduct_advance_q(M->Cond, M->A, M->B, M->Scratch[Cpu * 2], M->Scratch[Cpu * 2 + 1],
+                          HEAT2D_TB_TILE_ROWS, y0, y1, M->K, M->Disp);
   }
+}
 
-  // Copper base plate near bottom
-  INT32 marginX = NX / 8;
-  INT32 baseW = NX - 2*marginX;
-  INT32 baseH = NY / 10;
-  INT32 baseX0 = marginX;
-  INT32 baseX1 = baseX0 + baseW - 1;
-
-  INT32 baseY1 = NY - 10;
-  INT32 baseY0 = baseY1 - baseH + 1;
-  if (baseY0 < 0) baseY0 = 0;
+STATIC VOID EFIAPI ApRunBands(IN OUT VOID *Arg) {
+  MP_SOLVER *M = (MP_SOLVER *)Arg;
+  UINTN cpu = 0;
+  M->Mp->WhoAmI(M->Mp, &cpu);
+  RunBands(M, cpu);
+}
 
-  if (G) {
-    G->baseX0 = baseX0; G->baseX1 = baseX1;
-    G->baseY0 = baseY0; G->baseY1 = baseY1;
+STATIC VOID InitMpSolver(MP_SOLVER *M, INT32 NX) {
+  SetMem(M, sizeof(*M), 0);
+  M->CpuCount = 1;
+  M->Bands = 1;
+
+  EFI_MP_SERVICES_PROTOCOL *Mp = NULL;
+  UINTN total = 0, enabled = 0;
+  if (!EFI_ERROR(gBS->LocateProtocol(&gEfiMpServiceProtocolGuid, NULL, (VOID**)&Mp)) && Mp &&
+      !EFI_ERROR(Mp->GetNumberOfProcessors(Mp, &total, &enabled)) && enabled > 1) {
+    M->Mp = Mp;
+    M->CpuCount = total;
+    M->Bands = enabled;
+    Mp->WhoAmI(Mp, &M->Bsp);
+    if (EFI_ERROR(gBS->CreateEvent(0, 0, NULL, NULL, &M->Done))) {
+      M->Done = NULL;
+      M->Blocking = TRUE;
+    }
   }
 
-  // Copper base
-  for (INT32 j = baseY0; j <= baseY1; j++) {
-    for (INT32 i = baseX0; i <= baseX1; i++) {
-      Mat[j*NX + i] = 1;
-      K[j*NX + i] = k_cu;
+  M->Scratch = AllocateZeroPool(sizeof(float *) * 2 * M->CpuCount);
+  if (!M->Scratch) {
+    M->Mp = NULL;
+    M->CpuCount = M->Bands = 1;
+    M->Scratch = AllocateZeroPool(sizeof(float *) * 2);
+    if (!M->Scratch) return;
+  }
+  BOOLEAN ok = TRUE;
+  for (UINTN i = 0; i < 2 * M->CpuCount; i++) {
+    M->Scratch[i] = AllocatePool(sizeof(float) * NX * HEAT2D_TB_SCRATCH_ROWS);
+    if (!M->Scratch[i]) ok = FALSE;
+  }
+  if (!ok) {   // every core must advance the same number of steps
+    for (UINTN i = 0; i < 2 * M->CpuCount; i++) {
+      if (M->Scratch[i]) FreePool(M->Scratch[i]);
+      M->Scratch[i] = NULL;
     }
   }
 
-  // Copper fins (comb) above base
-  INT32 finH  = NY / 3;
-  INT32 finY0 = baseY0 - finH;
-  INT32 finY1 = baseY0;
-  if (finY0 < 2) finY0 = 2;
-
-  INT32 finCount = 14;
-  INT32 gap = baseW / finCount;
-  if (gap < 6) gap = 6;
-
-  INT32 finW = gap / 2;
-  if (finW < 3) finW = 3;
-
-  for (INT32 f = 0; f < finCount; f++) {
-    INT32 cx = baseX0 + f * gap + gap/2;
-    INT32 x0 = cx - finW/2;
-    INT32 x1 = x0 + finW - 1;
+  if (M->Mp) Print(L"Solver: %u cores via MP services\n", (UINT32)M->Bands);
+  else Print(L"Solver: single core\n");
+}
 
-    x0 = ClampI32(x0, baseX0, baseX1);
-    x1 = ClampI32(x1, baseX0, baseX1);
+STATIC VOID FreeMpSolver(MP_SOLVER *M) {
+  if (M->Scratch) {
+    for (UINTN i = 0; i < 2 * M->CpuCount; i++) {
+      if (M->Scratch[i]) FreePool(M->Scratch[i]);
+    }
+    FreePool(M->Scratch);
+  }
+  if (M->Done) gBS->CloseEvent(M->Done);
+}
 
-    for (INT32 j = finY0; j <= finY1; j++) {
-      for (INT32 i = x0; i <= x1; i++) {
-        Mat[j*NX + i] = 1;
-        K[j*NX + i] = k_cu;
+// Run the current job's bands on every available core.
+STATIC VOID MpRunJob(MP_SOLVER *M) {
+  M->NextBand = 0;
+
+  if (M->Mp) {
+    // Non-blocking: the BSP claims bands too, then waits for the APs. Some
+    // firmware only supports the blocking form; then the BSP mops up after.
+    EFI_STATUS st;
+    if (!M->Blocking) {
+      st = M->Mp->StartupAllAPs(M->Mp, ApRunBands, FALSE, M->Done, 0, M, NULL);
+      if (!EFI_ERROR(st)) {
+        RunBands(M, M->Bsp);
+        UINTN idx;
+        gBS->WaitForEvent(1, &M->Done, &idx);
+        MemoryFence();
+        return;
       }
+      if (st == EFI_UNSUPPORTED) M->Blocking = TRUE;
+    }
+    if (M->Blocking) {
+      st = M->Mp->StartupAllAPs(M->Mp, ApRunBands, FALSE, NULL, 0, M, NULL);
     }
+    // No APs to run on any more: stay on the BSP from now on.
+    if (EFI_ERROR(st)) M->Mp = NULL;
+    MemoryFence();
   }
+  RunBands(M, M->Bsp);
+}
 
-  // Copper "die block" under base (still copper)
-  INT32 dieW = baseW / 6;
-  INT32 dieH = baseH / 2;
-  INT32 dieX0 = (NX/2) - dieW/2;
-  INT32 dieX1 = dieX0 + dieW - 1;
-  INT32 dieY0 = baseY1 + 1;
-  INT32 dieY1 = dieY0 + dieH - 1;
-  if (dieY1 >= NY) dieY1 = NY - 1;
-
-  for (INT32 j = dieY0; j <= dieY1; j++) {
-    for (INT32 i = dieX0; i <= dieX1; i++) {
-      Mat[j*NX + i] = 1;
-      K[j*NX + i] = k_cu;
-    }
+// Advance A (already stamped) by K steps into B on every available core,
+// quantizing B into Disp (if set) as it is stored.
+STATIC VOID MpStepConduction(MP_SOLVER *M, const h2d_conduct *Cond, const float *A, float *B, UINT32 K,
+                             h2d_display *Disp) {
+  if (!M->Scratch) {
+    h2d_conduct_advance_q(Cond, A, B, NULL, NULL, HEAT2D_TB_TILE_ROWS, 0, Cond->ny, K, Disp);
+    return;
   }
+  M->Cond = Cond;
+  M->Act = NULL;
+  M->Adi = NULL;
+  M->HA = NULL;
+  M->A = A;
+  M->B = B;
+  M->Disp = Disp;
+  M->K = K;
+  MpRunJob(M);
 }
 
-STATIC VOID PrecomputeFaceConductivities(const float *K, float *Kx, float *Ky, INT32 NX, INT32 NY) {
-  // Kx[idx] = k at face between (i,j) and (i+1,j), valid for i in [0..NX-2]
-  // Ky[idx] = k at face between (i,j) and (i,j+1), valid for j in [0..NY-2]
-  for (INT32 j = 0; j < NY; j++) {
-    INT32 row = j*NX;
-    for (INT32 i = 0; i < NX; i++) {
-      INT32 idx = row + i;
+// MpStepConduction over half fields, as steps Step .. Step+K-1.
+STATIC VOID MpStepConductionHalf(MP_SOLVER *M, const h2d_conduct *Cond, const h2d_half *A, h2d_half *B,
+                                 UINT32 K, UINT32 Step, h2d_display *Disp) {
+  if (!M->Scratch) {
+    h2d_conduct_advance_hq(Cond, A, B, NULL, NULL, HEAT2D_TB_TILE_ROWS, 0, Cond->ny, K, Step, Disp);
+    return;
+  }
+  M->Cond = Cond;
+  M->Act = NULL;
+  M->Adi = NULL;
+  M->HA = A;
+  M->HB = B;
+  M->Disp = Disp;
+  M->Step = Step;
+  M->K = K;
+  MpRunJob(M);
+}
 
-      if (i < NX-1) {
-        Kx[idx] = KFaceHarmonic(K[idx], K[idx + 1]);
-      } else {
-        Kx[idx] = 0.0f; // unused (no right neighbor)
-      }
+// One round of K steps of the awake tiles of A (already stamped) into B,
+// quantizing what it stores into Disp (if set), then the tracker update
+// (sleep/wake, and the copy-back into A of stepped tiles that are asleep).
+STATIC VOID MpStepActive(MP_SOLVER *M, const h2d_conduct *Cond, h2d_active *Act, float *A, float *B,
+                         UINT32 K, h2d_display *Disp) {
+  if (!M->Scratch) {
+    h2d_conduct_active_advance_q(Cond, Act, A, B, NULL, NULL, HEAT2D_TB_TILE_ROWS, 0, Act->th, K, Disp);
+  } else {
+    M->Cond = Cond;
+    M->Act = Act;
+    M->Adi = NULL;
+    M->HA = NULL;
+    M->A = A;
+    M->B = B;
+    M->Disp = Disp;
+    M->K = K;
+    MpRunJob(M);
+  }
+  h2d_active_update(Act, B, A);
+}
 
-      if (j < NY-1) {
-        Ky[idx] = KFaceHarmonic(K[idx], K[idx + NX]);
-      } else {
-        Ky[idx] = 0.0f; // unused (no down neighbor)
-      }
-    }
+// One ADI step of A (already stamped) into B. Without per-CPU scratch it runs
+// on the BSP in Fallback (h2d_adi_scratch_floats).
+STATIC VOID MpStepAdi(MP_SOLVER *M, const h2d_adi *Adi, const float *A, float *B, float *Fallback) {
+  const h2d_conduct *Cond = Adi->c;
+  if (!M->Scratch) {
+    h2d_adi_step(Adi, A, B, Fallback);
+    return;
   }
+  M->Cond = Cond;
+  M->Act = NULL;
+  M->Adi = Adi;
+  M->HA = NULL;
+  M->A = A;
+  M->B = B;
+  M->K = 1;
+  M->AdiCols = FALSE;
+  MpRunJob(M);
+  M->AdiCols = TRUE;
+  MpRunJob(M);
+}
+
+// -------------------- Display pacing --------------------
+// The loop sleeps in WaitForEvent on a periodic display tick plus the keyboard
+// and pointer events. Input is handled whenever it arrives; on each tick the
+// solver runs as many substeps as fit in the frame next to one render (running
+// averages of measured times, like the metal FramePacer), then the frame is
+// presented. At least one substep per tick, so a slow solver lowers the frame
+// rate instead of stalling the sim.
+#ifndef HEAT2D_DISPLAY_HZ
+#define HEAT2D_DISPLAY_HZ      60
+#endif
+#ifndef HEAT2D_MAX_SUBSTEPS
+#define HEAT2D_MAX_SUBSTEPS    64
+#endif
+
+typedef struct {
+  UINT64 FrameNs;
+  UINT64 StepNs;     // per substep, running average
+  UINT64 RenderNs;   // per render + present, running average
+} DISPLAY_PACER;
+
+STATIC UINT64 PacerAverage(UINT64 Est, UINT64 Sample) {
+  return Est ? Est - Est / 8 + Sample / 8 : Sample;
+}
+
+STATIC UINT32 PacerSubsteps(CONST DISPLAY_PACER *P) {
+  if (P->StepNs == 0) return 1;
+  // keep one substep of margin for jitter in the estimates
+  UINT64 budget = (P->FrameNs > P->RenderNs + P->StepNs) ? (P->FrameNs - P->RenderNs - P->StepNs) : 0;
+  UINT64 n = budget / P->StepNs;
+  if (n < 1) n = 1;
+  if (n > HEAT2D_MAX_SUBSTEPS) n = HEAT2D_MAX_SUBSTEPS;
+  return (UINT32)n;
 }
 
 // -------------------- Main --------------------
@@ -692,14 +1028,17 @@ EFI_STATUS EFIAPI UefiMain(IN EFI_HANDLE ImageHandle, IN EFI_SYSTEM_TABLE *Syste
     return EFI_UNSUPPORTED;
   }
 
-  PIXEL_PACKER Packer;
-  Packer.Fmt = Info->PixelFormat;
-
-  if (Packer.Fmt == PixelBltOnly) {
-    Print(L"Error: GOP PixelFormat is PixelBltOnly.\n");
-    Print(L"This demo requires direct framebuffer access.\n");
-    return EFI_UNSUPPORTED;
+  PRESENTER Pres;
+  Status = InitPresenter(&Pres, Gop);
+  if (EFI_ERROR(Status)) {
+    Print(L"Out of memory\n");
+    return Status;
   }
+
+  // Pixels are packed for the back buffer: BLT order when presenting through
+  // Blt (the GOP converts), the framebuffer's own format when copying.
+  PIXEL_PACKER Packer;
+  Packer.Fmt = (Pres.Path == PRESENT_BLT) ? PixelBlueGreenRedReserved8BitPerColor : Info->PixelFormat;
   if (Packer.Fmt == PixelBitMask) {
     Packer.Masks = Info->PixelInformation;
   } else {
@@ -708,60 +1047,53 @@ EFI_STATUS EFIAPI UefiMain(IN EFI_HANDLE ImageHandle, IN EFI_SYSTEM_TABLE *Syste
 
   UINTN paletteIdx = 0;
   BuildPaletteLut(&gPalettes[paletteIdx]);
+  BuildCellPixelLut(&Packer);
 
-  UINT32 *Fb = (UINT32*)(UINTN)Gop->Mode->FrameBufferBase;
+  UINT32 *Back = Pres.Back;   // drawing target, pitch Width
 
   // ---- Simulation grid ----
-  const INT32 NX = 260;
-  const INT32 NY = 220;
+  const INT32 NX = HEAT2D_GRID_NX;
+  const INT32 NY = HEAT2D_GRID_NY;
 
   float *A   = AllocateZeroPool(sizeof(float) * NX * NY);
   float *B   = AllocateZeroPool(sizeof(float) * NX * NY);
-  float *K   = AllocateZeroPool(sizeof(float) * NX * NY);   // cell conductivity
-  float *Kx  = AllocateZeroPool(sizeof(float) * NX * NY);   // face (right) conductivity
-  float *Ky  = AllocateZeroPool(sizeof(float) * NX * NY);   // face (down) conductivity
   UINT8 *Mat = AllocateZeroPool(sizeof(UINT8) * NX * NY);   // 0 air, 1 copper
 
-  if (!A || !B || !K || !Kx || !Ky || !Mat) {
+  if (!A || !B || !Mat) {
     Print(L"Out of memory\n");
     if (A) FreePool(A);
     if (B) FreePool(B);
-    if (K) FreePool(K);
-    if (Kx) FreePool(Kx);
-    if (Ky) FreePool(Ky);
     if (Mat) FreePool(Mat);
+    FreePresenter(&Pres);
     return EFI_OUT_OF_RESOURCES;
   }
 
-  HEATSINK_GEOM G;
-  BuildHeatsinkCombMask(K, Mat, NX, NY, &G);
+  // Per-CPU temporal-blocking scratch; without it the step runs one step per call.
+  MP_SOLVER Mp;
+  InitMpSolver(&Mp, NX);
+  UINT32 tbSteps = HEAT2D_TB_STEPS;
 
-  // Precompute face conductivities once (removes harmonic/divisions from hot loop)
-  PrecomputeFaceConductivities(K, Kx, Ky, NX, NY);
+  h2d_heatsink_geom G;
+  h2d_build_heatsink(Mat, NX, NY, &G);
 
-  // Stability: baseR <= 0.25 for max k ~ 1.
-  const float baseR = 0.20f;
+  // Harmonic face conductivity per material pair, looked up through Mat in the
+  // hot loop (no divisions, and 1 byte per cell instead of two float arrays)
+  float KFace[MAT_COUNT * MAT_COUNT];
+  h2d_face_table(h2d_heatsink_k, MAT_COUNT, KFace);
 
   // Three rectangular heat sources (same temperature) at the bottom of the base plate.
-  const float heatTemp = 1.0f;
-
-  INT32 baseW = G.baseX1 - G.baseX0 + 1;
-  INT32 baseH = G.baseY1 - G.baseY0 + 1;
-
-  INT32 srcH = ClampI32(baseH / 2, 2, baseH);
-  INT32 srcY0 = G.baseY1 - srcH + 1;
-
-  INT32 srcW = ClampI32(baseW / 8, 6, baseW / 3);
-  INT32 gap  = ClampI32(baseW / 12, 4, baseW / 4);
-
-  INT32 mid = (G.baseX0 + G.baseX1) / 2;
-
-  INT32 s0x0 = mid - (srcW/2) - (srcW + gap);
-  INT32 s1x0 = mid - (srcW/2);
-  INT32 s2x0 = mid - (srcW/2) + (srcW + gap);
-
-  if (s0x0 < G.baseX0) s0x0 = G.baseX0;
-  if (s2x0 + srcW - 1 > G.baseX1) s2x0 = G.baseX1 - srcW + 1;
+  h2d_rect_sources Src;
+  h2d_heatsink_sources(&G, 1.0f, &Src);
+
+  h2d_conduct Cond;
+  Cond.nx     = NX;
+  Cond.ny     = NY;
+  Cond.mat    = Mat;
+  Cond.kface  = KFace;
+  Cond.nmat   = MAT_COUNT;
+  Cond.base_r = 0.20f;   // Stability: baseR <= 0.25 for max k ~ 1.
+  Cond.bc     = BC_DIRICHLET_COLD;
+  Cond.src    = &Src;
 
   // User brush
   INT32 brushRad = NX / 35;
@@ -776,23 +1108,110 @@ EFI_STATUS EFIAPI UefiMain(IN EFI_HANDLE ImageHandle, IN EFI_SYSTEM_TABLE *Syste
   if (cellW < 1) cellW = 1;
   if (cellH < 1) cellH = 1;
 
-  UINTN drawSkip = 1;
-  if (Width * Height > 1920u * 1080u) drawSkip = 2;
-
   UINTN drawW = (UINTN)NX * cellW;
   UINTN drawH = (UINTN)NY * cellH;
   if (drawW > Width)  drawW = Width;
   if (drawH > Height) drawH = Height;
 
+  EFI_EVENT Tick = NULL;
+
+  // Active-tile tracker; without its memory the solver always steps everything.
+  UINTN ActTiles = (UINTN)h2d_active_tiles(NX, HEAT2D_ACTIVE_TILE) * h2d_active_tiles(NY, HEAT2D_ACTIVE_TILE);
+  float *ActDelta   = AllocatePool(sizeof(float) * ActTiles);
+  UINT8 *ActQuiet   = AllocatePool(ActTiles);
+  UINT8 *ActChanged = AllocatePool(ActTiles);
+  BOOLEAN ActOk = (ActDelta && ActQuiet && ActChanged);
+  h2d_active Act;
+  if (ActOk) {
+    h2d_active_init(&Act, NX, NY, HEAT2D_ACTIVE_TILE, HEAT2D_ACTIVE_TOL, HEAT2D_ACTIVE_QUIET,
+                    ActDelta, ActQuiet, ActChanged);
+  }
+  BOOLEAN activeOn = ActOk && HEAT2D_ACTIVE_TILES;
+
+  VOID *MgWork = NULL;   // steady-state solver workspace, on first 'e'
+
+  // ADI: the source cells as fixed cells, and single-core scratch if the
+  // per-CPU pairs are missing; both on first 'i'
+  UINT8 *AdiFixed = NULL;
+  float *AdiScratch = NULL;
+  UINTN adiIdx = 0;
+  h2d_adi Adi;
+  Adi.c       = &Cond;
+  Adi.steps   = 0.0f;
+  Adi.sink    = 0.0f;
+  Adi.fixed   = NULL;
+  Adi.clamp01 = 0;
+
+  // Half storage: the two fp16 fields, up front with HEAT2D_FIELD_FP16 (which
+  // stays off without them), else on first 'h'
+  h2d_half *HA = NULL;
+  h2d_half *HB = NULL;
+  BOOLEAN halfOn = FALSE;
+  BOOLEAN halfLive = FALSE;   // HA holds the field and A is out of date
+  UINT32 halfStep = 0;        // step number of the next half step
+  if (HEAT2D_FIELD_FP16) {
+    HA = AllocatePool(sizeof(h2d_half) * NX * NY);
+    HB = AllocatePool(sizeof(h2d_half) * NX * NY);
+    halfOn = (HA && HB);
+  }
+
+  // One expanded scanline; every cell is drawn at every resolution
+  UINT32 *Line = AllocatePool(sizeof(UINT32) * drawW);
+
+  // What the field is drawn from: a LUT index per cell (rounded, as TempBucket)
+  // and a changed flag per row. The blocked steps fill it as they store; rows
+  // of A changed any other way are quantized before the frame is drawn.
+  UINT8 *DispIdx  = AllocatePool((UINTN)NX * NY);
+  UINT8 *DispRows = AllocatePool((UINTN)NY);
+  h2d_display Disp;
+  if (!Line || !DispIdx || !DispRows) {
+    Print(L"Out of memory\n");
+    Status = EFI_OUT_OF_RESOURCES;
+    goto done;
+  }
+
+  h2d_display_init(&Disp, (uint32_t)NX, (uint32_t)NY, 0.5f, DispIdx, DispRows);
+  h2d_display_rows(&Disp, A, 0, (uint32_t)NY);
+
   POINTER_STATE Ptr;
   InitPointer(&Ptr, SystemTable, Width, Height);
 
-  UINT32 bg = PackPixel(&Packer, 0, 0, 0);
-  DrawRect(Fb, Width, Height, Ppsl, 0, 0, Width, Height, bg);
+  UINT32 bg = gHudPixels.Black;
+  DrawRect(Back, Width, Height, Width, 0, 0, Width, Height, bg);
+  MarkRows(&Pres, 0, Height);
 
   BOOLEAN dirty = TRUE;
+  BOOLEAN hudDirty = TRUE;   // legend/footer changed since last present
+  BOOLEAN fieldFull = TRUE;  // redraw every field row, not just the changed ones
+  BOOLEAN fieldStale = FALSE; // the field changed outside the blocked steps: re-quantize every row
+  INT32   lastCursorY = Ptr.Y;
+
+  // ---- Events: display tick first, then whatever input the firmware offers ----
+  Status = gBS->CreateEvent(EVT_TIMER, TPL_APPLICATION, NULL, NULL, &Tick);
+  if (!EFI_ERROR(Status)) {
+    Status = gBS->SetTimer(Tick, TimerPeriodic, 10000000ull / HEAT2D_DISPLAY_HZ);   // 100 ns units
+  }
+  if (EFI_ERROR(Status)) {
+    Print(L"Display timer: %r\n", Status);
+    goto done;
+  }
+
+  EFI_EVENT Events[4];
+  UINTN EventCount = 0;
+  Events[EventCount++] = Tick;
+  Events[EventCount++] = SystemTable->ConIn->WaitForKey;
+  if (Ptr.HasAbs && Ptr.Abs->WaitForInput) Events[EventCount++] = Ptr.Abs->WaitForInput;
+  if (Ptr.HasRel && Ptr.Rel->WaitForInput) Events[EventCount++] = Ptr.Rel->WaitForInput;
+
+  DISPLAY_PACER Pacer;
+  Pacer.FrameNs  = 1000000000ull / HEAT2D_DISPLAY_HZ;
+  Pacer.StepNs   = 0;
+  Pacer.RenderNs = 0;
 
   while (TRUE) {
+    UINTN Signaled = 0;
+    gBS->WaitForEvent(EventCount, Events, &Signaled);
+
     // ---- Keyboard ----
     EFI_INPUT_KEY Key;
     while (TryReadKey(SystemTable, &Key)) {
@@ -802,17 +1221,35 @@ EFI_STATUS EFIAPI UefiMain(IN EFI_HANDLE ImageHandle, IN EFI_SYSTEM_TABLE *Syste
       else if (Key.UnicodeChar == L'r' || Key.UnicodeChar == L'R') {
         SetMem(A, sizeof(float)*NX*NY, 0);
         SetMem(B, sizeof(float)*NX*NY, 0);
+        if (halfLive) {
+          SetMem(HA, sizeof(h2d_half)*NX*NY, 0);
+          SetMem(HB, sizeof(h2d_half)*NX*NY, 0);
+        }
+        if (ActOk) h2d_active_wake_all(&Act);
         dirty = TRUE;
+        fieldStale = TRUE;
       } else if (Key.UnicodeChar == L'c' || Key.UnicodeChar == L'C') {
         SetMem(A, sizeof(float)*NX*NY, 0);
+        if (halfLive) SetMem(HA, sizeof(h2d_half)*NX*NY, 0);
+        if (ActOk) h2d_active_wake_all(&Act);
         dirty = TRUE;
+        fieldStale = TRUE;
       } else if (Key.UnicodeChar == L'p' || Key.UnicodeChar == L'P') {
         paletteIdx = (paletteIdx + 1) % (sizeof(gPalettes)/sizeof(gPalettes[0]));
         BuildPaletteLut(&gPalettes[paletteIdx]);
+        BuildCellPixelLut(&Packer);
         dirty = TRUE;
+        hudDirty = TRUE;
+        fieldFull = TRUE;
       } else if (Key.UnicodeChar == L'b' || Key.UnicodeChar == L'B') {
         bc = (BOUNDARY_MODE)((bc + 1) % BC_COUNT);
+        if (ActOk) h2d_active_wake_all(&Act);   // every edge tile sees new boundary values
         dirty = TRUE;
+      } else if ((Key.UnicodeChar == L'a' || Key.UnicodeChar == L'A') && ActOk) {
+        activeOn = !activeOn;
+        h2d_active_wake_all(&Act);
+        dirty = TRUE;
+        fieldFull = TRUE;
       } else if (Key.UnicodeChar == L'+' || Key.UnicodeChar == L'=') {
         brushRad = ClampI32(brushRad + 2, 2, NX/4);
         dirty = TRUE;
@@ -822,6 +1259,47 @@ EFI_STATUS EFIAPI UefiMain(IN EFI_HANDLE ImageHandle, IN EFI_SYSTEM_TABLE *Syste
       } else if (Key.UnicodeChar == L'1') { brushTemp = 0.5f; dirty = TRUE; }
       else if (Key.UnicodeChar == L'2') { brushTemp = 0.8f; dirty = TRUE; }
       else if (Key.UnicodeChar == L'3') { brushTemp = 1.0f; dirty = TRUE; }
+      else if (Key.UnicodeChar == L't' || Key.UnicodeChar == L'T') {
+        tbSteps = (tbSteps >= HEAT2D_TB_MAX_STEPS) ? 1 : tbSteps * 2;
+        dirty = TRUE;
+      } else if (Key.UnicodeChar == L'e' || Key.UnicodeChar == L'E') {
+        if (!MgWork) MgWork = AllocatePool(h2d_mg_bytes(NX, NY));
+        if (MgWork) {
+          h2d_mg Mg;
+          Cond.bc = bc;
+          h2d_mg_init(&Mg, &Cond, MgWork);
+          if (halfLive) h2d_half_to_floats(HA, A, (uint32_t)(NX * NY));
+          h2d_mg_solve(&Mg, A, HEAT2D_STEADY_MAX_ITERS, HEAT2D_STEADY_RTOL);
+          CopyMem(B, A, sizeof(float)*NX*NY);
+          if (halfLive) h2d_half_from_floats(A, HA, (uint32_t)(NX * NY));
+          if (ActOk) h2d_active_wake_all(&Act);
+          dirty = TRUE;
+          fieldStale = TRUE;
+        }
+      } else if (Key.UnicodeChar == L'i' || Key.UnicodeChar == L'I') {
+        if (!AdiFixed) {
+          AdiFixed = AllocatePool(sizeof(UINT8) * NX * NY);
+          if (AdiFixed) h2d_adi_mark_sources(&Src, NX, NY, AdiFixed);
+        }
+        if (!Mp.Scratch && !AdiScratch) AdiScratch = AllocatePool(sizeof(float) * h2d_adi_scratch_floats(NX, NY));
+        if (AdiFixed && (Mp.Scratch || AdiScratch)) {
+          adiIdx = (adiIdx + 1) % (sizeof(mAdiSteps) / sizeof(mAdiSteps[0]));
+          Adi.steps = (float)mAdiSteps[adiIdx];
+          Adi.fixed = AdiFixed;
+          if (adiIdx == 0 && ActOk) h2d_active_wake_all(&Act);   // tiles slept through the ADI steps
+          dirty = TRUE;
+          fieldFull = TRUE;
+        }
+      } else if (Key.UnicodeChar == L'h' || Key.UnicodeChar == L'H') {
+        if (!HA) HA = AllocatePool(sizeof(h2d_half) * NX * NY);
+        if (!HB) HB = AllocatePool(sizeof(h2d_half) * NX * NY);
+        if (HA && HB) {
+          halfOn = !halfOn;
+          if (!halfOn && ActOk) h2d_active_wake_all(&Act);   // tiles slept through the half steps
+          dirty = TRUE;
+          fieldFull = TRUE;
+        }
+      }
     }
 
     // ---- Pointer ----
@@ -834,103 +1312,135 @@ EFI_STATUS EFIAPI UefiMain(IN EFI_HANDLE ImageHandle, IN EFI_SYSTEM_TABLE *Syste
     gy = ClampI32(gy, 0, NY-1);
 
     if (pressed) {
-      StampDisk(A, NX, NY, gx, gy, brushRad, brushTemp);
+      UINT32 r0 = (UINT32)ClampI32(gy - brushRad, 0, NY);
+      UINT32 r1 = (UINT32)ClampI32(gy + brushRad + 1, 0, NY);
+      if (halfLive) {   // the brush works on floats: only its rows make the trip
+        h2d_half_to_floats(HA + r0 * NX, A + r0 * NX, (r1 - r0) * (uint32_t)NX);
+        h2d_stamp_disk_max(A, NX, NY, gx, gy, brushRad, brushTemp);
+        h2d_half_from_floats(A + r0 * NX, HA + r0 * NX, (r1 - r0) * (uint32_t)NX);
+        h2d_display_rows_h(&Disp, HA, r0, r1);
+      } else {
+        h2d_stamp_disk_max(A, NX, NY, gx, gy, brushRad, brushTemp);
+        h2d_display_rows(&Disp, A, r0, r1);
+      }
+      if (ActOk) h2d_active_wake_cells(&Act, gx - brushRad, gy - brushRad, gx + brushRad + 1, gy + brushRad + 1);
       dirty = TRUE;
     } else if (ptrEvent) {
       dirty = TRUE;
     }
 
+    // Input only: it shows up with the next tick's frame.
+    if (Signaled != 0) continue;
+
     // ---- Simulation (pure conduction, fast hot loop) ----
     if (!Paused) {
-      // Re-stamp 3 rectangular heat sources (same temperature) on base bottom
-      StampRectMax(A, NX, NY, s0x0, srcY0, srcW, srcH, heatTemp);
-      StampRectMax(A, NX, NY, s1x0, srcY0, srcW, srcH, heatTemp);
-      StampRectMax(A, NX, NY, s2x0, srcY0, srcW, srcH, heatTemp);
-
-      // ∂T/∂t = ∇·(k∇T) using precomputed face conductivities
-      for (INT32 j = 1; j < NY-1; j++) {
-        INT32 row = j*NX;
-        for (INT32 i = 1; i < NX-1; i++) {
-          INT32 idx = row + i;
-
-          float tC = A[idx];
-          float tR = A[idx + 1];
-          float tL = A[idx - 1];
-          float tD = A[idx + NX];
-          float tU = A[idx - NX];
-
-          // Faces:
-          // right face uses Kx[idx]
-          // left  face uses Kx[idx-1]
-          // down  face uses Ky[idx]
-          // up    face uses Ky[idx-NX]
-          float flux_r = Kx[idx]     * (tR - tC);
-          float flux_l = Kx[idx - 1] * (tL - tC);
-          float flux_d = Ky[idx]     * (tD - tC);
-          float flux_u = Ky[idx - NX] * (tU - tC);
-
-          B[idx] = tC + baseR * (flux_r + flux_l + flux_d + flux_u);
-        }
+      UINT32 substeps = PacerSubsteps(&Pacer);
+      UINT64 t0 = GetPerformanceCounter();
+      Cond.bc = bc;
+      BOOLEAN half = halfOn && adiIdx == 0;
+      if (half != halfLive) {   // hand the field over between A and HA
+        if (half) h2d_half_from_floats(A, HA, (uint32_t)(NX * NY));
+        else h2d_half_to_floats(HA, A, (uint32_t)(NX * NY));
+        halfLive = half;
       }
+      for (UINT32 n = 0; n < substeps; n++) {
+        if (adiIdx != 0) {
+          h2d_stamp_sources_rows(&Src, A, 0, NX, NY, 0, NY);
+          MpStepAdi(&Mp, &Adi, A, B, AdiScratch);
 
-      ApplyBoundary(B, NX, NY, bc);
+          float *Tmp = A; A = B; B = Tmp;
+          continue;
+        }
+        if (half) {
+          h2d_stamp_sources_rows_h(&Src, HA, 0, NX, NY, 0, NY);
+          MpStepConductionHalf(&Mp, &Cond, HA, HB, tbSteps, halfStep, &Disp);
+          halfStep += tbSteps;
 
-      float *Tmp = A; A = B; B = Tmp;
+          h2d_half *Tmp = HA; HA = HB; HB = Tmp;
+          continue;
+        }
+        if (activeOn) {
+          h2d_stamp_sources_rows(&Src, A, 0, NX, NY, 0, NY);
+          MpStepActive(&Mp, &Cond, &Act, A, B, tbSteps, &Disp);
+
+          float *Tmp = A; A = B; B = Tmp;
+          continue;
+        }
+
+        // Re-stamp 3 rectangular heat sources (same temperature) on base bottom,
+        // then advance tbSteps steps (the sources are re-stamped between them).
+        h2d_stamp_sources_rows(&Src, A, 0, NX, NY, 0, NY);
+        MpStepConduction(&Mp, &Cond, A, B, tbSteps, &Disp);
+
+        float *Tmp = A; A = B; B = Tmp;
+      }
+      UINT64 ns = GetTimeInNanoSecond(GetPerformanceCounter() - t0);
+      Pacer.StepNs = PacerAverage(Pacer.StepNs, ns / substeps);
       dirty = TRUE;
+      if (adiIdx != 0) fieldStale = TRUE;   // neither the tracker nor the plane saw these steps
     }
 
     // ---- Render ----
+    // Everything goes to the back buffer; the HUD is redrawn over the field
+    // each frame but only pushed out again when it changed.
     if (dirty) {
-      for (INT32 j = 0; j < NY; j += (INT32)drawSkip) {
-        for (INT32 i = 0; i < NX; i += (INT32)drawSkip) {
-          float t = A[j*NX + i];
-
-          UINT8 rr, gg, bb;
-          TempToRGB_LUT(t, &rr, &gg, &bb);
-
-          // Visual tint so comb reads as copper
-          if (Mat[j*NX + i] == 1) {
-            rr = (UINT8)ClampI32((INT32)rr + 10, 0, 255);
-            gg = (UINT8)((UINT32)gg * 240u / 255u);
-            bb = (UINT8)((UINT32)bb * 220u / 255u);
-          } else {
-            rr = (UINT8)((UINT32)rr * 230u / 255u);
-            gg = (UINT8)((UINT32)gg * 230u / 255u);
-            bb = (UINT8)((UINT32)bb * 230u / 255u);
-          }
-
-          UINT32 px = PackPixel(&Packer, rr, gg, bb);
-
-          UINTN x0 = (UINTN)i * cellW;
-          UINTN y0 = (UINTN)j * cellH;
-
-          UINTN cw = cellW * drawSkip;
-          UINTN ch = cellH * drawSkip;
-          if (cw < 1) cw = 1;
-          if (ch < 1) ch = 1;
-
-          if (x0 >= drawW || y0 >= drawH) continue;
-          DrawRect(Fb, Width, Height, Ppsl, x0, y0, cw, ch, px);
-        }
+      UINT64 t0 = GetPerformanceCounter();
+
+      // Only rows whose LUT indices changed since the last frame are redrawn,
+      // plus the rows under the old and new cursor. The explicit steps, active
+      // tiles and half fields included, flag theirs as they store; every row is
+      // quantized here after the field changed some other way.
+      if (fieldStale) {
+        if (halfLive) h2d_display_rows_h(&Disp, HA, 0, (UINT32)NY);
+        else h2d_display_rows(&Disp, A, 0, (UINT32)NY);
+        fieldStale = FALSE;
+      }
+      INT32 ys[2] = { lastCursorY, Ptr.Y };
+      for (UINTN c = 0; c < 2; c++) {
+        INT32 c0 = ClampI32(((ys[c] > 2) ? ys[c] - 2 : 0) / (INT32)cellH, 0, NY);
+        INT32 c1 = ClampI32((ys[c] + 3 + (INT32)cellH - 1) / (INT32)cellH, 0, NY);
+        h2d_display_mark_rows(&Disp, (UINT32)c0, (UINT32)c1);
+      }
+      lastCursorY = Ptr.Y;
+
+      INT32 j0, j1;
+      DrawFieldScanlines(Back, Width, Line, &Disp, Mat, fieldFull, cellW, cellH, drawW, drawH, &j0, &j1);
+      fieldFull = FALSE;
+      if (j0 < j1) MarkRows(&Pres, (UINTN)j0 * cellH, ((UINTN)j1 * cellH < drawH) ? (UINTN)j1 * cellH : drawH);
+
+      DrawCursor(Back, Width, Height, Width, (UINTN)Ptr.X, (UINTN)Ptr.Y, &gHudPixels);
+      MarkRows(&Pres, (Ptr.Y > 2) ? (UINTN)Ptr.Y - 2 : 0, (UINTN)Ptr.Y + 3);
+      DrawLegendWithLabels(Back, Width, Height, Width, &gHudPixels, gPalettes[paletteIdx].Name);
+      DrawFooter(Back, Width, Height, Width, &gHudPixels);
+      if (hudDirty) {
+        MarkRows(&Pres, 0, Height);
+        hudDirty = FALSE;
       }
 
-      DrawCursor(Fb, Width, Height, Ppsl, (UINTN)Ptr.X, (UINTN)Ptr.Y, &Packer);
-      DrawLegendWithLabels(Fb, Width, Height, Ppsl, &Packer, gPalettes[paletteIdx].Name);
-      DrawFooter(Fb, Width, Height, Ppsl, &Packer);
-
+      Present(&Pres);
+      Pacer.RenderNs = PacerAverage(Pacer.RenderNs, GetTimeInNanoSecond(GetPerformanceCounter() - t0));
       dirty = FALSE;
     }
-
-    gBS->Stall(4000);
   }
 
 done:
   FreePool(A);
   FreePool(B);
-  FreePool(K);
-  FreePool(Kx);
-  FreePool(Ky);
   FreePool(Mat);
+  FreeMpSolver(&Mp);
+  if (Line) FreePool(Line);
+  if (DispIdx) FreePool(DispIdx);
+  if (DispRows) FreePool(DispRows);
+  if (ActDelta) FreePool(ActDelta);
+  if (ActQuiet) FreePool(ActQuiet);
+  if (ActChanged) FreePool(ActChanged);
+  if (MgWork) FreePool(MgWork);
+  if (AdiFixed) FreePool(AdiFixed);
+  if (AdiScratch) FreePool(AdiScratch);
+  if (HA) FreePool(HA);
+  if (HB) FreePool(HB);
+  if (Tick) gBS->CloseEvent(Tick);
+  FreePresenter(&Pres);
   Print(L"Exit.\n");
-  return EFI_SUCCESS;
+  return Status;
 }
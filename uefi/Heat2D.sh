@@ -38,10 +38,12 @@ fi
 # ====== 5) Run in QEMU (graphics framebuffer + good mouse) ======
 # -device ramfb gives direct framebuffer GOP (works with your demo)
 # -device usb-tablet fixes mouse clicking/position
+# -smp 4 lets the solver spread its rows over the cores (EFI_MP_SERVICES)
 qemu-system-aarch64 \
   -display sdl \
   -machine virt \
   -cpu cortex-a72 \
+  -smp 4 \
   -m 1024 \
   -device ramfb \
   -device qemu-xhci \